@@ -242,6 +242,101 @@ fi
 echo " " 1>&6
 
 
+##########################################################################
+# Check for thread-local storage support
+##########################################################################
+echo "Checking for thread-local storage support... " 1>&6
+echo "$config_script: Checking for thread-local storage support" >&5
+has_tls=no
+
+if [ "x$has_pthread" = xyes ]; then
+  cat > conftest.c <<EOF
+static __thread int x = -1;
+int main() {x=0; return x;}
+EOF
+
+  if { (eval echo $config_script: \"$link\") 1>&5; (eval $link) 2>&5; }; then
+    rm -rf conftest*
+    has_tls=yes
+  else
+    echo "$config_script: failed program was:" >&5
+    cat conftest.c >&5
+  fi
+  rm -f conftest*
+fi
+
+echo " thread-local storage support: ""$has_tls" 1>&6
+if [ "x$has_tls" = xyes ]; then
+  CFLAGS="$CFLAGS -D_GLFW_HAS_TLS"
+fi
+echo " " 1>&6
+
+
+##########################################################################
+# Check for futex support
+##########################################################################
+echo "Checking for futex support... " 1>&6
+echo "$config_script: Checking for futex support" >&5
+has_futex=no
+
+if [ "x$has_pthread" = xyes ]; then
+  cat > conftest.c <<EOF
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+int main() {int x=0; __sync_fetch_and_add(&x,1); return (int)syscall(SYS_futex,&x,FUTEX_WAIT_BITSET_PRIVATE,0,0,0,FUTEX_BITSET_MATCH_ANY);}
+EOF
+
+  if { (eval echo $config_script: \"$link\") 1>&5; (eval $link) 2>&5; }; then
+    rm -rf conftest*
+    has_futex=yes
+  else
+    echo "$config_script: failed program was:" >&5
+    cat conftest.c >&5
+  fi
+  rm -f conftest*
+fi
+
+echo " futex support: ""$has_futex" 1>&6
+if [ "x$has_futex" = xyes ]; then
+  CFLAGS="$CFLAGS -D_GLFW_HAS_FUTEX"
+fi
+echo " " 1>&6
+
+
+##########################################################################
+# Check for Linux thread scheduling control
+##########################################################################
+echo "Checking for Linux thread scheduling control... " 1>&6
+echo "$config_script: Checking for Linux thread scheduling control" >&5
+has_linux_sched=no
+
+if [ "x$has_pthread" = xyes ]; then
+  cat > conftest.c <<EOF
+#include <sys/syscall.h>
+#include <sys/resource.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+int main() {unsigned long m=1; int t=(int)syscall(SYS_gettid); prctl(PR_SET_NAME,"t",0,0,0); setpriority(PRIO_PROCESS,t,0); return (int)syscall(SYS_sched_setaffinity,t,sizeof(m),&m);}
+EOF
+
+  if { (eval echo $config_script: \"$link\") 1>&5; (eval $link) 2>&5; }; then
+    rm -rf conftest*
+    has_linux_sched=yes
+  else
+    echo "$config_script: failed program was:" >&5
+    cat conftest.c >&5
+  fi
+  rm -f conftest*
+fi
+
+echo " Linux thread scheduling control: ""$has_linux_sched" 1>&6
+if [ "x$has_linux_sched" = xyes ]; then
+  CFLAGS="$CFLAGS -D_GLFW_HAS_LINUX_SCHED"
+fi
+echo " " 1>&6
+
+
 ##########################################################################
 # Check for glXGetProcAddressXXX availability
 ##########################################################################
@@ -5,8 +5,8 @@
 // This program can be used to get an idea of what to expect in terms of
 // multithreading granularity performance.
 //
-// As a "bonus", this program demonstrates how to create a signal
-// primitive using the GLFW mutex and condition variable primitives.
+// As a "bonus", this program demonstrates how to hand control between
+// threads with GLFW semaphores, and how to wait for them with a barrier.
 //
 // Here are some benchmark results:
 // (Note: these are not exact measurments, since they are subject to
@@ -48,76 +48,14 @@
 #include <GL/glfw.h>
 
 
-typedef struct {
-    GLFWcond  cond;
-    GLFWmutex mutex;
-    int       flag;
-} signal_t;
+GLFWsemaphore gotoA, gotoB;
 
-
-signal_t gotoA, gotoB;
-
-GLFWcond   threadDone;
-GLFWmutex  doneMutex;
-int        doneCount;
-int        gotoACount, gotoBCount;
+GLFWbarrier threadsDone;
+int         gotoACount, gotoBCount;
 
 #define MAX_COUNT 10000
 
 
-//------------------------------------------------------------------------
-// InitSignal()
-//------------------------------------------------------------------------
-
-void InitSignal( signal_t *s )
-{
-    s->cond  = glfwCreateCond();
-    s->mutex = glfwCreateMutex();
-    s->flag  = 0;
-}
-
-
-//------------------------------------------------------------------------
-// KillSignal()
-//------------------------------------------------------------------------
-
-void KillSignal( signal_t *s )
-{
-    glfwDestroyCond( s->cond );
-    glfwDestroyMutex( s->mutex );
-    s->flag  = 0;
-}
-
-
-//------------------------------------------------------------------------
-// WaitSignal()
-//------------------------------------------------------------------------
-
-void WaitSignal( signal_t *s )
-{
-    glfwLockMutex( s->mutex );
-    while( !s->flag )
-    {
-        glfwWaitCond( s->cond, s->mutex, GLFW_INFINITY );
-    }
-    s->flag = 0;
-    glfwUnlockMutex( s->mutex );
-}
-
-
-//------------------------------------------------------------------------
-// SetSignal()
-//------------------------------------------------------------------------
-
-void SetSignal( signal_t *s )
-{
-    glfwLockMutex( s->mutex );
-    s->flag = 1;
-    glfwUnlockMutex( s->mutex );
-    glfwSignalCond( s->cond );
-}
-
-
 //------------------------------------------------------------------------
 // threadAfun()
 //------------------------------------------------------------------------
@@ -132,18 +70,15 @@ void GLFWCALL threadAfun( void * arg )
         if( !done )
         {
             gotoACount ++;
-            SetSignal( &gotoB );
-            WaitSignal( &gotoA );
+            glfwPostSemaphore( gotoB );
+            glfwWaitSemaphore( gotoA );
         }
     }
     while( !done );
 
-    SetSignal( &gotoB );
+    glfwPostSemaphore( gotoB );
 
-    glfwLockMutex( doneMutex );
-    doneCount ++;
-    glfwUnlockMutex( doneMutex );
-    glfwSignalCond( threadDone );
+    glfwBarrierWait( threadsDone );
 }
 
 
@@ -161,18 +96,15 @@ void GLFWCALL threadBfun( void * arg )
         if( !done )
         {
             gotoBCount ++;
-            SetSignal( &gotoA );
-            WaitSignal( &gotoB );
+            glfwPostSemaphore( gotoA );
+            glfwWaitSemaphore( gotoB );
         }
     }
     while( !done );
 
-    SetSignal( &gotoA );
+    glfwPostSemaphore( gotoA );
 
-    glfwLockMutex( doneMutex );
-    doneCount ++;
-    glfwUnlockMutex( doneMutex );
-    glfwSignalCond( threadDone );
+    glfwBarrierWait( threadsDone );
 }
 
 
@@ -185,9 +117,9 @@ int main( void )
 {
     GLFWthread threadA, threadB;
     double     t1, t2, csps;
-    int        done, count, i;
+    int        count, i;
 
-    gotoACount = gotoBCount = doneCount = 0;
+    gotoACount = gotoBCount = 0;
 
     // Initialize GLFW
     if( !glfwInit() )
@@ -220,35 +152,24 @@ int main( void )
 // 1) Benchmark thread synchronization granularity
 //------------------------------------------------------------------------
 
-    // Init mutexes and conditions
-    doneMutex  = glfwCreateMutex();
-    threadDone = glfwCreateCond();
-    InitSignal( &gotoA );
-    InitSignal( &gotoB );
+    // Init semaphores and barrier (for both threads and the main thread)
+    gotoA       = glfwCreateSemaphore( 0 );
+    gotoB       = glfwCreateSemaphore( 0 );
+    threadsDone = glfwCreateBarrier( 3 );
 
     // Create threads A & B
     threadA = glfwCreateThread( threadAfun, NULL );
     threadB = glfwCreateThread( threadBfun, NULL );
     if( threadA == -1 || threadB == -1 )
     {
-        glfwLockMutex( doneMutex );
-        doneCount = 2;
-        glfwUnlockMutex( doneMutex );
+        printf( "Unable to create threads\n" );
+        glfwTerminate();
+        return 0;
     }
 
     // Wait for both threads to be done
     t1 = glfwGetTime();
-    glfwLockMutex( doneMutex );
-    do
-    {
-        done = (doneCount == 2);
-        if( !done )
-        {
-            glfwWaitCond( threadDone, doneMutex, GLFW_INFINITY );
-        }
-    }
-    while( !done );
-    glfwUnlockMutex( doneMutex );
+    glfwBarrierWait( threadsDone );
     t2 = glfwGetTime();
 
     // Display results
@@ -262,11 +183,10 @@ int main( void )
     glfwWaitThread( threadA, GLFW_WAIT );
     glfwWaitThread( threadB, GLFW_WAIT );
 
-    // Destroy mutexes and conditions
-    glfwDestroyMutex( doneMutex );
-    glfwDestroyCond( threadDone );
-    KillSignal( &gotoA );
-    KillSignal( &gotoB );
+    // Destroy semaphores and barrier
+    glfwDestroySemaphore( gotoA );
+    glfwDestroySemaphore( gotoB );
+    glfwDestroyBarrier( threadsDone );
 
 
 //------------------------------------------------------------------------
@@ -0,0 +1,800 @@
+//========================================================================
+// This is a benchmark program for the GLFW image loading functions
+//
+// It generates synthetic TGA images in memory (raw and run-length
+// encoded, grayscale, RGB, RGBA and colormapped, in a range of sizes) and
+// measures the throughput of each stage of the image pipeline:
+//
+//   probe    - reading a 1x1 image of the same type, which is the fixed
+//              cost of every load (header parsing, allocation etc.)
+//   decode   - reading the image without rescaling
+//   rescale  - the extra cost of rescaling to power-of-two dimensions
+//   upload   - uploading the image as a texture (needs -g)
+//   mipmaps  - the extra cost of building all mipmap levels (needs -g)
+//
+// Rescaling and mipmap generation can not be run on their own, so they
+// are measured as the difference of two timings. A difference that is
+// within twice its standard error is reported as noise, and is neither
+// given a throughput nor compared against the baseline.
+//
+// Results are printed as a table and written as JSON, one result per
+// line. Given a baseline file written by an earlier run, every result is
+// compared against it, and the program exits with status 1 if any stage
+// got slower than the threshold allows.
+//
+// Usage: tgabench [-g] [-q] [-o result.json] [-b baseline.json]
+//                 [-t percent]
+//========================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <GL/glfw.h>
+
+
+// Image formats to test
+typedef struct {
+    const char *name;
+    int        imagetype;      // TGA image type (1-3, 9-11)
+    int        bpp;            // Bits per stored pixel
+} format_t;
+
+static const format_t formats[] = {
+    { "gray8",    3,  8 },
+    { "rgb24",    2, 24 },
+    { "rgba32",   2, 32 },
+    { "cmap8",    1,  8 },
+    { "gray8rle", 11, 8 },
+    { "rgb24rle", 10, 24 },
+    { "rgba32rle",10, 32 },
+    { "cmap8rle", 9,  8 }
+};
+
+#define NUM_FORMATS ( (int) ( sizeof( formats ) / sizeof( formats[0] ) ) )
+
+// Image sizes to test (the odd ones exercise rescaling)
+static const int sizes[][ 2 ] = {
+    {   64,   64 },
+    {  200,  150 },
+    {  256,  256 },
+    {  640,  480 },
+    { 1024, 1024 },
+    { 2048, 2048 }
+};
+
+#define NUM_SIZES       ( (int) ( sizeof( sizes ) / sizeof( sizes[0] ) ) )
+#define NUM_QUICK_SIZES 4
+
+// One measured result
+typedef struct {
+    char   name[ 64 ];
+    double seconds;            // Mean time per iteration
+    double error;              // Standard error of the mean time
+    int    noisy;              // Time is within the measurement noise
+    double bytes;              // Bytes processed per iteration
+    double pixels;             // Pixels processed per iteration
+    int    iterations;
+} result_t;
+
+#define MAX_RESULTS 256
+
+static result_t results[ MAX_RESULTS ];
+static int      numresults = 0;
+
+// Minimum time spent measuring each result
+static double mintime = 0.5;
+
+
+//------------------------------------------------------------------------
+// Value of a synthetic pixel. Half of the image is made of flat 8x4
+// blocks and the other half of a gradient, so that RLE images contain
+// both run and raw packets
+//------------------------------------------------------------------------
+
+static int PixelValue( int x, int y )
+{
+    unsigned int h;
+
+    if( ( y / 32 ) & 1 )
+    {
+        return ( x + y ) & 255;
+    }
+
+    h = (unsigned int) ( x / 8 ) * 73856093u ^
+        (unsigned int) ( y / 4 ) * 19349663u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    return (int) ( h >> 24 );
+}
+
+
+//------------------------------------------------------------------------
+// Store one pixel in TGA byte order (BGRA)
+//------------------------------------------------------------------------
+
+static void StorePixel( unsigned char *p, int value, int bytes )
+{
+    if( bytes == 1 )
+    {
+        p[ 0 ] = (unsigned char) value;
+        return;
+    }
+
+    p[ 0 ] = (unsigned char) ( value * 7 );
+    p[ 1 ] = (unsigned char) ( value * 3 );
+    p[ 2 ] = (unsigned char) value;
+    if( bytes == 4 )
+    {
+        p[ 3 ] = (unsigned char) ( 255 - value );
+    }
+}
+
+
+//------------------------------------------------------------------------
+// Write one row of pixels as RLE packets, returning the bytes written
+//------------------------------------------------------------------------
+
+static int EncodeRow( unsigned char *dst, const unsigned char *row,
+    int width, int bytes )
+{
+    unsigned char *start = dst;
+    int           x, n;
+
+    x = 0;
+    while( x < width )
+    {
+        // Count identical pixels
+        n = 1;
+        while( x + n < width && n < 128 &&
+               !memcmp( row + x * bytes, row + ( x + n ) * bytes, bytes ) )
+        {
+            n ++;
+        }
+
+        if( n > 1 )
+        {
+            *dst ++ = (unsigned char) ( 128 | ( n - 1 ) );
+            memcpy( dst, row + x * bytes, bytes );
+            dst += bytes;
+            x += n;
+            continue;
+        }
+
+        // Count pixels up to the next run
+        n = 1;
+        while( x + n < width && n < 128 &&
+               ( x + n + 1 >= width ||
+                 memcmp( row + ( x + n ) * bytes,
+                         row + ( x + n + 1 ) * bytes, bytes ) ) )
+        {
+            n ++;
+        }
+
+        *dst ++ = (unsigned char) ( n - 1 );
+        memcpy( dst, row + x * bytes, n * bytes );
+        dst += n * bytes;
+        x += n;
+    }
+
+    return (int) ( dst - start );
+}
+
+
+//------------------------------------------------------------------------
+// Generate a TGA file in memory. Returns its size, or 0 on failure
+//------------------------------------------------------------------------
+
+static long GenerateTGA( const format_t *f, int width, int height,
+    unsigned char **data )
+{
+    unsigned char *buf, *p, *row;
+    int           bytes, cmap, rle, x, y, i;
+
+    *data = NULL;
+
+    bytes = f->bpp / 8;
+    cmap  = ( f->imagetype & 7 ) == 1;
+    rle   = f->imagetype >= 9;
+
+    // Header, colormap and worst case RLE expansion
+    buf = (unsigned char *) malloc( 18 + 256 * 3 + width * height * bytes +
+                                    ( width / 128 + 1 ) * height );
+    row = (unsigned char *) malloc( width * bytes );
+    if( buf == NULL || row == NULL )
+    {
+        free( buf );
+        free( row );
+        return 0;
+    }
+
+    memset( buf, 0, 18 );
+    buf[ 1 ]  = (unsigned char) cmap;
+    buf[ 2 ]  = (unsigned char) f->imagetype;
+    buf[ 6 ]  = (unsigned char) ( cmap ? 1 : 0 );       // 256 entries
+    buf[ 7 ]  = (unsigned char) ( cmap ? 24 : 0 );
+    buf[ 12 ] = (unsigned char) ( width & 255 );
+    buf[ 13 ] = (unsigned char) ( width >> 8 );
+    buf[ 14 ] = (unsigned char) ( height & 255 );
+    buf[ 15 ] = (unsigned char) ( height >> 8 );
+    buf[ 16 ] = (unsigned char) f->bpp;
+    buf[ 17 ] = (unsigned char) ( bytes == 4 ? 8 : 0 );
+    p = buf + 18;
+
+    if( cmap )
+    {
+        for( i = 0; i < 256; i ++ )
+        {
+            StorePixel( p, i, 3 );
+            p += 3;
+        }
+    }
+
+    for( y = 0; y < height; y ++ )
+    {
+        for( x = 0; x < width; x ++ )
+        {
+            StorePixel( row + x * bytes, PixelValue( x, y ), bytes );
+        }
+
+        if( rle )
+        {
+            p += EncodeRow( p, row, width, bytes );
+        }
+        else
+        {
+            memcpy( p, row, width * bytes );
+            p += width * bytes;
+        }
+    }
+
+    free( row );
+
+    *data = buf;
+    return (long) ( p - buf );
+}
+
+
+//------------------------------------------------------------------------
+// Smallest power of two not less than n
+//------------------------------------------------------------------------
+
+static int PowerOfTwo( int n )
+{
+    int p;
+
+    for( p = 1; p < n; p <<= 1 )
+        ;
+
+    return p;
+}
+
+
+//------------------------------------------------------------------------
+// Add a result, returning a pointer to it
+//------------------------------------------------------------------------
+
+static result_t * AddResult( const char *stage, const char *format,
+    int width, int height )
+{
+    result_t *r;
+
+    if( numresults == MAX_RESULTS )
+    {
+        return NULL;
+    }
+
+    r = &results[ numresults ++ ];
+    memset( r, 0, sizeof( result_t ) );
+    if( width )
+    {
+        sprintf( r->name, "%s/%s/%dx%d", stage, format, width, height );
+    }
+    else
+    {
+        sprintf( r->name, "%s/%s", stage, format );
+    }
+
+    return r;
+}
+
+
+//------------------------------------------------------------------------
+// Standard error of a mean time, given the sum and the sum of squares of
+// the individual times
+//------------------------------------------------------------------------
+
+static double StandardError( double total, double squares, int n )
+{
+    double variance;
+
+    variance = ( squares - total * total / (double) n ) / (double) ( n - 1 );
+    return variance > 0.0 ? sqrt( variance / (double) n ) : 0.0;
+}
+
+
+//------------------------------------------------------------------------
+// Set a result to the difference of two mean times
+//------------------------------------------------------------------------
+
+static void SetDifference( result_t *r, double total, double totalerror,
+    double base, double baseerror )
+{
+    r->seconds = total - base;
+    r->error   = sqrt( totalerror * totalerror + baseerror * baseerror );
+    r->noisy   = r->seconds <= 2.0 * r->error;
+}
+
+
+//------------------------------------------------------------------------
+// Measure the mean time of reading an image from memory
+//------------------------------------------------------------------------
+
+static double TimeRead( const unsigned char *data, long size, int flags,
+    int *iterations, double *error )
+{
+    GLFWimage img;
+    double    t, total, squares;
+    int       n;
+
+    // Warm up the image pool and caches
+    if( !glfwReadMemoryImage( data, size, &img, flags ) )
+    {
+        return -1.0;
+    }
+    glfwFreeImage( &img );
+
+    total = 0.0;
+    squares = 0.0;
+    n = 0;
+    do
+    {
+        t = glfwGetTime();
+        glfwReadMemoryImage( data, size, &img, flags );
+        glfwFreeImage( &img );
+        t = glfwGetTime() - t;
+        total += t;
+        squares += t * t;
+        n ++;
+    }
+    while( total < mintime || n < 3 );
+
+    *iterations = n;
+    *error = StandardError( total, squares, n );
+    return total / (double) n;
+}
+
+
+//------------------------------------------------------------------------
+// Measure the mean time of uploading an image as a texture
+//------------------------------------------------------------------------
+
+static double TimeUpload( const unsigned char *data, long size, int flags,
+    int *iterations, double *error )
+{
+    GLFWimage img;
+    GLuint    texture;
+    double    t, total, squares;
+    int       n;
+
+    glGenTextures( 1, &texture );
+    glBindTexture( GL_TEXTURE_2D, texture );
+
+    total = 0.0;
+    squares = 0.0;
+    n = 0;
+    do
+    {
+        // Mipmap generation overwrites the image, so read a fresh copy
+        if( !glfwReadMemoryImage( data, size, &img, 0 ) )
+        {
+            glDeleteTextures( 1, &texture );
+            return -1.0;
+        }
+
+        glFinish();
+        t = glfwGetTime();
+        glfwLoadTextureImage2D( &img, flags );
+        glFinish();
+        t = glfwGetTime() - t;
+        total += t;
+        squares += t * t;
+        n ++;
+
+        glfwFreeImage( &img );
+    }
+    while( total < mintime || n < 3 );
+
+    glDeleteTextures( 1, &texture );
+
+    *iterations = n;
+    *error = StandardError( total, squares, n );
+    return total / (double) n;
+}
+
+
+//------------------------------------------------------------------------
+// Run all benchmarks for one format
+//------------------------------------------------------------------------
+
+static void BenchFormat( const format_t *f, int numsizes, int gl )
+{
+    unsigned char *data;
+    result_t      *r;
+    double        decode, decodeerror, upload, uploaderror, t, error;
+    long          size;
+    int           width, height, bytes, i, n;
+
+    bytes = ( f->imagetype & 7 ) == 1 ? 3 : f->bpp / 8;
+
+    // Fixed cost of loading an image
+    size = GenerateTGA( f, 1, 1, &data );
+    if( size && ( r = AddResult( "probe", f->name, 0, 0 ) ) != NULL )
+    {
+        r->seconds = TimeRead( data, size, GLFW_NO_RESCALE_BIT,
+                               &r->iterations, &r->error );
+        r->bytes   = (double) size;
+        r->pixels  = 1.0;
+    }
+    free( data );
+
+    for( i = 0; i < numsizes; i ++ )
+    {
+        width  = sizes[ i ][ 0 ];
+        height = sizes[ i ][ 1 ];
+
+        size = GenerateTGA( f, width, height, &data );
+        if( size == 0 )
+        {
+            continue;
+        }
+
+        decode = TimeRead( data, size, GLFW_NO_RESCALE_BIT, &n,
+                           &decodeerror );
+        if( ( r = AddResult( "decode", f->name, width, height ) ) != NULL )
+        {
+            r->seconds    = decode;
+            r->error      = decodeerror;
+            r->iterations = n;
+            r->bytes      = (double) size;
+            r->pixels     = (double) width * height;
+        }
+
+        // Rescaling is measured as the extra cost over decoding
+        if( width != PowerOfTwo( width ) || height != PowerOfTwo( height ) )
+        {
+            t = TimeRead( data, size, 0, &n, &error );
+            if( ( r = AddResult( "rescale", f->name, width, height ) ) )
+            {
+                SetDifference( r, t, error, decode, decodeerror );
+                r->iterations = n;
+                r->pixels     = (double) PowerOfTwo( width ) *
+                                PowerOfTwo( height );
+                r->bytes      = r->pixels * bytes;
+            }
+        }
+
+        if( gl )
+        {
+            upload = TimeUpload( data, size, 0, &n, &uploaderror );
+            if( ( r = AddResult( "upload", f->name, width, height ) ) )
+            {
+                r->seconds    = upload;
+                r->error      = uploaderror;
+                r->iterations = n;
+                r->pixels     = (double) PowerOfTwo( width ) *
+                                PowerOfTwo( height );
+                r->bytes      = r->pixels * bytes;
+            }
+
+            // Mipmap generation is measured as the extra cost over
+            // uploading the base level
+            t = TimeUpload( data, size, GLFW_BUILD_MIPMAPS_BIT, &n, &error );
+            if( ( r = AddResult( "mipmaps", f->name, width, height ) ) )
+            {
+                SetDifference( r, t, error, upload, uploaderror );
+                r->iterations = n;
+                r->pixels     = (double) PowerOfTwo( width ) *
+                                PowerOfTwo( height ) / 3.0;
+                r->bytes      = r->pixels * bytes;
+            }
+        }
+
+        free( data );
+    }
+}
+
+
+//------------------------------------------------------------------------
+// Throughput of a result in MB/s and Mpix/s, or zero if it is noise
+//------------------------------------------------------------------------
+
+static double MBps( const result_t *r )
+{
+    return r->noisy ? 0.0 : r->bytes / ( r->seconds * 1048576.0 );
+}
+
+static double Mpixps( const result_t *r )
+{
+    return r->noisy ? 0.0 : r->pixels / ( r->seconds * 1000000.0 );
+}
+
+
+//------------------------------------------------------------------------
+// Write all results as JSON
+//------------------------------------------------------------------------
+
+static int WriteResults( const char *name, int gl )
+{
+    FILE *f;
+    int  major, minor, rev, i;
+
+    f = fopen( name, "w" );
+    if( f == NULL )
+    {
+        return 0;
+    }
+
+    glfwGetVersion( &major, &minor, &rev );
+
+    fprintf( f, "{\n" );
+    fprintf( f, "  \"benchmark\": \"tgabench\",\n" );
+    fprintf( f, "  \"glfw\": \"%d.%d.%d\",\n", major, minor, rev );
+    fprintf( f, "  \"processors\": %d,\n", glfwGetNumberOfProcessors() );
+    fprintf( f, "  \"gl\": %s,\n", gl ? "true" : "false" );
+    fprintf( f, "  \"results\": [\n" );
+    for( i = 0; i < numresults; i ++ )
+    {
+        fprintf( f, "    { \"name\": \"%s\", \"seconds\": %.9f, "
+                    "\"error\": %.9f, \"noisy\": %s, "
+                    "\"iterations\": %d, \"mbps\": %.3f, "
+                    "\"mpixps\": %.3f }%s\n",
+                 results[ i ].name, results[ i ].seconds,
+                 results[ i ].error,
+                 results[ i ].noisy ? "true" : "false",
+                 results[ i ].iterations, MBps( &results[ i ] ),
+                 Mpixps( &results[ i ] ),
+                 i < numresults - 1 ? "," : "" );
+    }
+    fprintf( f, "  ]\n" );
+    fprintf( f, "}\n" );
+
+    fclose( f );
+    return 1;
+}
+
+
+//------------------------------------------------------------------------
+// Read a whole file into a string
+//------------------------------------------------------------------------
+
+static char * ReadFile( const char *name )
+{
+    FILE *f;
+    char *text;
+    long size;
+
+    f = fopen( name, "rb" );
+    if( f == NULL )
+    {
+        return NULL;
+    }
+
+    fseek( f, 0, SEEK_END );
+    size = ftell( f );
+    fseek( f, 0, SEEK_SET );
+
+    text = (char *) malloc( size + 1 );
+    if( text )
+    {
+        size = (long) fread( text, 1, size, f );
+        text[ size ] = 0;
+    }
+
+    fclose( f );
+    return text;
+}
+
+
+//------------------------------------------------------------------------
+// Find the Mpix/s of a named result in a baseline written by
+// WriteResults, or return a negative value if it is not there
+//------------------------------------------------------------------------
+
+static double FindBaseline( const char *text, const char *name )
+{
+    char       key[ 80 ];
+    const char *p;
+
+    sprintf( key, "\"name\": \"%.63s\"", name );
+    p = strstr( text, key );
+    if( p == NULL )
+    {
+        return -1.0;
+    }
+
+    p = strstr( p, "\"mpixps\":" );
+    if( p == NULL )
+    {
+        return -1.0;
+    }
+
+    return atof( p + 9 );
+}
+
+
+//------------------------------------------------------------------------
+// Print all results, compared against a baseline if there is one.
+// Returns the number of regressions
+//------------------------------------------------------------------------
+
+static int PrintResults( const char *baseline, double threshold )
+{
+    double base, change;
+    int    regressions, i;
+
+    regressions = 0;
+
+    printf( "%-32s %10s %10s", "Benchmark", "MB/s", "Mpix/s" );
+    if( baseline )
+    {
+        printf( " %10s %8s", "Baseline", "Change" );
+    }
+    printf( "\n" );
+
+    for( i = 0; i < numresults; i ++ )
+    {
+        // A difference within the noise has no meaningful throughput
+        if( results[ i ].noisy )
+        {
+            printf( "%-32s %10s %10s", results[ i ].name, "noise", "-" );
+            if( baseline )
+            {
+                printf( " %10s %8s", "-", "-" );
+            }
+            printf( "\n" );
+            continue;
+        }
+
+        printf( "%-32s %10.2f %10.3f", results[ i ].name,
+                MBps( &results[ i ] ), Mpixps( &results[ i ] ) );
+
+        if( baseline )
+        {
+            base = FindBaseline( baseline, results[ i ].name );
+            if( base > 0.0 )
+            {
+                change = 100.0 * ( Mpixps( &results[ i ] ) - base ) / base;
+                printf( " %10.3f %+7.1f%%", base, change );
+                if( change < -threshold )
+                {
+                    printf( "  REGRESSION" );
+                    regressions ++;
+                }
+            }
+            else
+            {
+                printf( " %10s %8s", "-", "new" );
+            }
+        }
+        printf( "\n" );
+    }
+
+    return regressions;
+}
+
+
+//------------------------------------------------------------------------
+// Print usage information
+//------------------------------------------------------------------------
+
+static void Usage( void )
+{
+    printf( "Usage: tgabench [-g] [-q] [-o result.json] [-b baseline.json]"
+            " [-t percent]\n\n" );
+    printf( "  -g            Also benchmark texture upload and mipmap "
+            "generation\n" );
+    printf( "  -q            Quick run (fewer sizes, shorter timing)\n" );
+    printf( "  -o <file>     Write results to file (default "
+            "tgabench.json)\n" );
+    printf( "  -b <file>     Compare results against a baseline\n" );
+    printf( "  -t <percent>  Slowdown reported as a regression "
+            "(default 10)\n" );
+}
+
+
+//------------------------------------------------------------------------
+// main()
+//------------------------------------------------------------------------
+
+int main( int argc, char **argv )
+{
+    const char *output = "tgabench.json", *basename = NULL;
+    char       *baseline = NULL;
+    double     threshold = 10.0;
+    int        gl = 0, numsizes = NUM_SIZES, regressions, i;
+
+    for( i = 1; i < argc; i ++ )
+    {
+        if( !strcmp( argv[ i ], "-g" ) )
+        {
+            gl = 1;
+        }
+        else if( !strcmp( argv[ i ], "-q" ) )
+        {
+            numsizes = NUM_QUICK_SIZES;
+            mintime  = 0.1;
+        }
+        else if( !strcmp( argv[ i ], "-o" ) && i + 1 < argc )
+        {
+            output = argv[ ++ i ];
+        }
+        else if( !strcmp( argv[ i ], "-b" ) && i + 1 < argc )
+        {
+            basename = argv[ ++ i ];
+        }
+        else if( !strcmp( argv[ i ], "-t" ) && i + 1 < argc )
+        {
+            threshold = atof( argv[ ++ i ] );
+        }
+        else
+        {
+            Usage();
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    // Read the baseline first, as it may be the file we are about to
+    // overwrite
+    if( basename )
+    {
+        baseline = ReadFile( basename );
+        if( baseline == NULL )
+        {
+            fprintf( stderr, "Failed to read baseline %s\n", basename );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    // Initialise GLFW
+    if( !glfwInit() )
+    {
+        fprintf( stderr, "Failed to initialize GLFW\n" );
+        exit( EXIT_FAILURE );
+    }
+
+    // Uploads need a context
+    if( gl && !glfwOpenWindow( 64, 64, 0,0,0,0, 0,0, GLFW_WINDOW ) )
+    {
+        fprintf( stderr, "Failed to open GLFW window\n" );
+        glfwTerminate();
+        exit( EXIT_FAILURE );
+    }
+
+    for( i = 0; i < NUM_FORMATS; i ++ )
+    {
+        printf( "Benchmarking %s...\n", formats[ i ].name );
+        fflush( stdout );
+        BenchFormat( &formats[ i ], numsizes, gl );
+    }
+    printf( "\n" );
+
+    glfwTerminate();
+
+    regressions = PrintResults( baseline, threshold );
+
+    if( !WriteResults( output, gl ) )
+    {
+        fprintf( stderr, "Failed to write %s\n", output );
+    }
+
+    if( baseline )
+    {
+        printf( "\n%d regression(s) beyond %.1f%%\n", regressions,
+                threshold );
+        free( baseline );
+    }
+
+    return regressions ? EXIT_FAILURE : EXIT_SUCCESS;
+}
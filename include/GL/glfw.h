@@ -153,6 +153,9 @@ extern "C" {
 
 /* -------------------- END SYSTEM/COMPILER SPECIFIC --------------------- */
 
+/* size_t is used by the allocator callbacks */
+#include <stddef.h>
+
 /* Include standard OpenGL headers: GLFW uses GL_FALSE/GL_TRUE, and it is
  * convenient for the user to only have to include <GL/glfw.h>. This also
  * solves the problem with Windows <GL/gl.h> and <GL/glu.h> needing some
@@ -367,6 +370,30 @@ extern "C" {
 #define GLFW_WAIT                 0x00040001
 #define GLFW_NOWAIT               0x00040002
 
+/* GLFWthreadattr scheduling policies */
+#define GLFW_SCHED_NORMAL         0
+#define GLFW_SCHED_FIFO           1 /* Real-time, run until blocked */
+#define GLFW_SCHED_RR             2 /* Real-time, round robin */
+
+/* GLFWthreadattr priorities */
+#define GLFW_PRIORITY_LOWEST      -2
+#define GLFW_PRIORITY_LOW         -1
+#define GLFW_PRIORITY_NORMAL      0
+#define GLFW_PRIORITY_HIGH        1
+#define GLFW_PRIORITY_HIGHEST     2
+
+/* Number of processors a GLFWcpumask can hold */
+#define GLFW_MAX_PROCESSORS       256
+
+/* GLFWtopology limits */
+#define GLFW_MAX_NODES            64
+#define GLFW_MAX_CACHES           8
+
+/* GLFWcacheinfo cache types */
+#define GLFW_CACHE_DATA           1
+#define GLFW_CACHE_INSTRUCTION    2
+#define GLFW_CACHE_UNIFIED        3
+
 /* glfwGetJoystickParam tokens */
 #define GLFW_PRESENT              0x00050001
 #define GLFW_AXES                 0x00050002
@@ -377,10 +404,51 @@ extern "C" {
 #define GLFW_ORIGIN_UL_BIT        0x00000002
 #define GLFW_BUILD_MIPMAPS_BIT    0x00000004 /* Only for glfwLoadTexture2D */
 #define GLFW_ALPHA_MAP_BIT        0x00000008
+#define GLFW_PACKED_16BIT_BIT     0x00000010 /* Only for glfwLoadTexture2D */
+#define GLFW_PACKED_ALPHA1_BIT    0x00000020 /* Only for glfwLoadTexture2D */
+#define GLFW_DITHER_BIT           0x00000040
+#define GLFW_PREMULTIPLY_ALPHA_BIT 0x00000080
+#define GLFW_COMPRESS_BIT         0x00000100 /* Only for glfwLoadTexture2D and image writing */
+#define GLFW_LOOP_SEQUENCE_BIT    0x00000200 /* Only for glfwOpenImageSequence */
+
+/* glfwConvertImage pixel formats */
+#define GLFW_PIXEL_L              0x00060001
+#define GLFW_PIXEL_ALPHA          0x00060002
+#define GLFW_PIXEL_LA             0x00060003
+#define GLFW_PIXEL_RGB            0x00060004
+#define GLFW_PIXEL_RGBA           0x00060005
+#define GLFW_PIXEL_BGRA           0x00060006
+#define GLFW_PIXEL_RGB565         0x00060007
+#define GLFW_PIXEL_RGBA4444       0x00060008
+#define GLFW_PIXEL_RGBA5551       0x00060009
+
+/* glfwGetMemoryStats usage categories */
+#define GLFW_MEMORY_IMAGE         0 /* Pixel buffers, including pooled ones */
+#define GLFW_MEMORY_THREAD        1
+#define GLFW_MEMORY_SYNC          2 /* Mutexes and condition variables */
+#define GLFW_MEMORY_VIDEO         3 /* Framebuffer configs and video modes */
+#define GLFW_MEMORY_JOYSTICK      4
+#define GLFW_MEMORY_OTHER         5
+#define GLFW_MEMORY_USAGES        6
 
 /* Time spans longer than this (seconds) are considered to be infinity */
 #define GLFW_INFINITY 100000.0
 
+/* Memory orders for atomic operations (the same values as C11 and GCC) */
+#define GLFW_ATOMIC_RELAXED       0
+#define GLFW_ATOMIC_ACQUIRE       2
+#define GLFW_ATOMIC_RELEASE       3
+#define GLFW_ATOMIC_ACQ_REL       4
+#define GLFW_ATOMIC_SEQ_CST       5
+
+/* glfwCreateQueue modes */
+#define GLFW_QUEUE_SPSC           0 /* One producer and one consumer thread */
+#define GLFW_QUEUE_MPMC           1 /* Any number of either */
+
+/* Initializers for GLFWstaticmutex and GLFWstaticcond */
+#define GLFW_STATIC_MUTEX_INIT { { 0, 0 }, 0, 0 }
+#define GLFW_STATIC_COND_INIT  { { 0, 0 }, 0, 0 }
+
 
 /*************************************************************************
  * Typedefs
@@ -400,15 +468,169 @@ typedef struct {
     unsigned char *Data;
 } GLFWimage;
 
+/* Rectangular region of an image, in pixels */
+typedef struct {
+    int X, Y, Width, Height;
+} GLFWrect;
+
+/* Placement of one image in a texture atlas */
+typedef struct {
+    int X, Y, Width, Height;
+    float S0, T0, S1, T1;
+} GLFWatlasrect;
+
+/* Texture atlas layout, as created by glfwPackImages() */
+typedef struct {
+    int Width, Height;
+    int Padding;
+    int Count;
+    GLFWatlasrect *Rects;
+} GLFWatlas;
+
 /* Thread ID */
 typedef int GLFWthread;
 
+/* Set of processors. Processor n is bit (n % 32) of Bits[n / 32] */
+typedef struct {
+    unsigned int Bits[ GLFW_MAX_PROCESSORS / 32 ];
+} GLFWcpumask;
+
+/* Thread creation attributes, as used by glfwCreateThreadEx(). All zero
+ * means the defaults. Everything but the stack size is a request that is
+ * silently dropped where the system does not support or permit it */
+typedef struct {
+    int StackSize;             /* Bytes, or zero for the default */
+    GLFWcpumask Affinity;      /* Processors to run on, or none for any */
+    int Policy;                /* GLFW_SCHED_* */
+    int Priority;              /* GLFW_PRIORITY_* */
+    const char *Name;          /* Name shown by debuggers and profilers */
+} GLFWthreadattr;
+
+/* One kind of processor cache, as in GLFWtopology */
+typedef struct {
+    int Level;                 /* 1 for L1 and so on */
+    int Type;                  /* GLFW_CACHE_* */
+    int Size;                  /* Bytes in one instance */
+    int LineSize;              /* Bytes */
+    int Count;                 /* Instances in the system */
+    int SharedBy;              /* Logical processors sharing one instance */
+} GLFWcacheinfo;
+
+/* Placement of one logical processor, as in GLFWtopology. All members are
+ * -1 for processors that are not online */
+typedef struct {
+    int Package;               /* Physical package (socket) */
+    int Core;                  /* Physical core, counted across packages */
+    int Node;                  /* NUMA node */
+    int Cache[ GLFW_MAX_CACHES ]; /* Instance of each of the caches, or -1.
+                                 * Processors with the same instance share
+                                 * it */
+} GLFWprocessorinfo;
+
+/* Processor topology, as returned by glfwGetProcessorTopology(). Logical
+ * processors are indexed by their system number, the same as in a
+ * GLFWcpumask */
+typedef struct {
+    int ProcessorCount;        /* Online logical processors */
+    int CoreCount;             /* Physical cores */
+    int PackageCount;          /* Physical packages */
+    int NodeCount;             /* NUMA nodes */
+    int CacheCount;            /* Kinds of caches in Caches */
+    GLFWprocessorinfo Processors[ GLFW_MAX_PROCESSORS ];
+    GLFWcpumask Cores[ GLFW_MAX_PROCESSORS ]; /* SMT siblings of each core */
+    GLFWcpumask Nodes[ GLFW_MAX_NODES ];      /* Processors of each node */
+    GLFWcacheinfo Caches[ GLFW_MAX_CACHES ];
+} GLFWtopology;
+
+/* 64-bit integer, for atomic operations */
+#if defined(_MSC_VER) || defined(__BORLANDC__) || defined(__WATCOMC__)
+typedef __int64 GLFWint64;
+#elif defined(__GNUC__)
+__extension__ typedef long long GLFWint64;
+#else
+typedef long long GLFWint64;
+#endif
+
 /* Mutex object */
 typedef void * GLFWmutex;
 
 /* Condition variable object */
 typedef void * GLFWcond;
 
+/* Reader-writer lock object */
+typedef void * GLFWrwlock;
+
+/* Semaphore object */
+typedef void * GLFWsemaphore;
+
+/* Barrier object */
+typedef void * GLFWbarrier;
+
+/* Mutex and condition variable that need no creation, for static or
+ * embedded storage. Initialize with GLFW_STATIC_MUTEX_INIT or
+ * GLFW_STATIC_COND_INIT, and never copy. The members are private */
+typedef struct {
+    volatile int  State[2];
+    volatile long Once;
+    void          *Handle;
+} GLFWstaticmutex;
+
+typedef struct {
+    volatile int  State[2];
+    volatile long Once;
+    void          *Handle;
+} GLFWstaticcond;
+
+/* Virtual texture object */
+typedef void * GLFWvtexture;
+
+/* Virtual texture information, as returned by glfwGetVirtualTextureInfo() */
+typedef struct {
+    int Width, Height;
+    int TileSize, Border;
+    int Levels;
+    int TilesX, TilesY;
+    int CacheTilesX, CacheTilesY;
+    GLuint CacheTexture;
+    GLuint IndirectionTexture;
+} GLFWvtexinfo;
+
+/* Memory allocator, as set with glfwSetAllocator(). The alignment is the
+ * alignment GLFW would like for the block; GLFW never relies on more than
+ * the alignment returned by malloc() */
+typedef struct {
+    void * (GLFWCALL * Alloc)( size_t size, size_t alignment, void *user );
+    void * (GLFWCALL * Realloc)( void *ptr, size_t size, size_t alignment, void *user );
+    void   (GLFWCALL * Free)( void *ptr, void *user );
+    void   *User;
+} GLFWallocator;
+
+/* Memory held by GLFW for one usage category */
+typedef struct {
+    long Bytes, PeakBytes;
+    long Allocations;          /* Currently allocated blocks */
+    long TotalAllocations;     /* Blocks allocated since the program started */
+} GLFWmemusage;
+
+/* Memory statistics, as returned by glfwGetMemoryStats() */
+typedef struct {
+    GLFWmemusage Usage[ GLFW_MEMORY_USAGES ];
+    GLFWmemusage Total;
+    long PoolBytes;            /* Free pixel buffers kept for reuse */
+} GLFWmemstats;
+
+/* Image sequence object */
+typedef void * GLFWsequence;
+
+/* Thread pool object */
+typedef void * GLFWthreadpool;
+
+/* Task graph object */
+typedef void * GLFWtaskgraph;
+
+/* Queue object */
+typedef void * GLFWqueue;
+
 /* Function pointer types */
 typedef void (GLFWCALL * GLFWwindowsizefun)(int,int);
 typedef int  (GLFWCALL * GLFWwindowclosefun)(void);
@@ -419,6 +641,8 @@ typedef void (GLFWCALL * GLFWmousewheelfun)(int);
 typedef void (GLFWCALL * GLFWkeyfun)(int,int);
 typedef void (GLFWCALL * GLFWcharfun)(int,int);
 typedef void (GLFWCALL * GLFWthreadfun)(void *);
+typedef void (GLFWCALL * GLFWjobfun)(void *);
+typedef void (GLFWCALL * GLFWrangefun)(int,int,void *);
 
 
 /*************************************************************************
@@ -426,6 +650,7 @@ typedef void (GLFWCALL * GLFWthreadfun)(void *);
  *************************************************************************/
 
 /* GLFW initialization, termination and version querying */
+GLFWAPI int  GLFWAPIENTRY glfwSetAllocator( const GLFWallocator *allocator );
 GLFWAPI int  GLFWAPIENTRY glfwInit( void );
 GLFWAPI void GLFWAPIENTRY glfwTerminate( void );
 GLFWAPI void GLFWAPIENTRY glfwGetVersion( int *major, int *minor, int *rev );
@@ -483,6 +708,8 @@ GLFWAPI void  GLFWAPIENTRY glfwGetGLVersion( int *major, int *minor, int *rev );
 
 /* Threading support */
 GLFWAPI GLFWthread GLFWAPIENTRY glfwCreateThread( GLFWthreadfun fun, void *arg );
+GLFWAPI GLFWthread GLFWAPIENTRY glfwCreateThreadEx( GLFWthreadfun fun, void *arg, const GLFWthreadattr *attr );
+GLFWAPI int  GLFWAPIENTRY glfwSetThreadAffinity( GLFWthread ID, const GLFWcpumask *mask );
 GLFWAPI void GLFWAPIENTRY glfwDestroyThread( GLFWthread ID );
 GLFWAPI int  GLFWAPIENTRY glfwWaitThread( GLFWthread ID, int waitmode );
 GLFWAPI GLFWthread GLFWAPIENTRY glfwGetThreadID( void );
@@ -492,10 +719,50 @@ GLFWAPI void GLFWAPIENTRY glfwLockMutex( GLFWmutex mutex );
 GLFWAPI void GLFWAPIENTRY glfwUnlockMutex( GLFWmutex mutex );
 GLFWAPI GLFWcond GLFWAPIENTRY glfwCreateCond( void );
 GLFWAPI void GLFWAPIENTRY glfwDestroyCond( GLFWcond cond );
-GLFWAPI void GLFWAPIENTRY glfwWaitCond( GLFWcond cond, GLFWmutex mutex, double timeout );
+GLFWAPI int  GLFWAPIENTRY glfwWaitCond( GLFWcond cond, GLFWmutex mutex, double timeout );
 GLFWAPI void GLFWAPIENTRY glfwSignalCond( GLFWcond cond );
 GLFWAPI void GLFWAPIENTRY glfwBroadcastCond( GLFWcond cond );
+GLFWAPI void GLFWAPIENTRY glfwLockStaticMutex( GLFWstaticmutex *mutex );
+GLFWAPI void GLFWAPIENTRY glfwUnlockStaticMutex( GLFWstaticmutex *mutex );
+GLFWAPI int  GLFWAPIENTRY glfwWaitStaticCond( GLFWstaticcond *cond, GLFWstaticmutex *mutex, double timeout );
+GLFWAPI void GLFWAPIENTRY glfwSignalStaticCond( GLFWstaticcond *cond );
+GLFWAPI void GLFWAPIENTRY glfwBroadcastStaticCond( GLFWstaticcond *cond );
+GLFWAPI GLFWrwlock GLFWAPIENTRY glfwCreateRWLock( void );
+GLFWAPI void GLFWAPIENTRY glfwDestroyRWLock( GLFWrwlock rwlock );
+GLFWAPI void GLFWAPIENTRY glfwReadLock( GLFWrwlock rwlock );
+GLFWAPI void GLFWAPIENTRY glfwReadUnlock( GLFWrwlock rwlock );
+GLFWAPI void GLFWAPIENTRY glfwWriteLock( GLFWrwlock rwlock );
+GLFWAPI void GLFWAPIENTRY glfwWriteUnlock( GLFWrwlock rwlock );
+GLFWAPI GLFWsemaphore GLFWAPIENTRY glfwCreateSemaphore( int count );
+GLFWAPI void GLFWAPIENTRY glfwDestroySemaphore( GLFWsemaphore semaphore );
+GLFWAPI void GLFWAPIENTRY glfwPostSemaphore( GLFWsemaphore semaphore );
+GLFWAPI void GLFWAPIENTRY glfwWaitSemaphore( GLFWsemaphore semaphore );
+GLFWAPI int  GLFWAPIENTRY glfwTryWaitSemaphore( GLFWsemaphore semaphore );
+GLFWAPI GLFWbarrier GLFWAPIENTRY glfwCreateBarrier( int count );
+GLFWAPI void GLFWAPIENTRY glfwDestroyBarrier( GLFWbarrier barrier );
+GLFWAPI int  GLFWAPIENTRY glfwBarrierWait( GLFWbarrier barrier );
 GLFWAPI int  GLFWAPIENTRY glfwGetNumberOfProcessors( void );
+GLFWAPI int  GLFWAPIENTRY glfwGetProcessorTopology( GLFWtopology *topology );
+
+/* Thread pool functions */
+GLFWAPI GLFWthreadpool GLFWAPIENTRY glfwCreateThreadPool( int threads );
+GLFWAPI void GLFWAPIENTRY glfwDestroyThreadPool( GLFWthreadpool pool );
+GLFWAPI int  GLFWAPIENTRY glfwSubmitJob( GLFWthreadpool pool, GLFWjobfun fun, void *arg );
+GLFWAPI void GLFWAPIENTRY glfwWaitJobs( GLFWthreadpool pool );
+GLFWAPI void GLFWAPIENTRY glfwParallelFor( GLFWthreadpool pool, int count, int grain, GLFWrangefun fun, void *arg );
+
+/* Queue functions */
+GLFWAPI GLFWqueue GLFWAPIENTRY glfwCreateQueue( int capacity, int elemsize, int mode );
+GLFWAPI void GLFWAPIENTRY glfwDestroyQueue( GLFWqueue queue );
+GLFWAPI int  GLFWAPIENTRY glfwPushQueue( GLFWqueue queue, const void *elements, int count, double timeout );
+GLFWAPI int  GLFWAPIENTRY glfwPopQueue( GLFWqueue queue, void *elements, int count, double timeout );
+
+/* Task graph functions */
+GLFWAPI GLFWtaskgraph GLFWAPIENTRY glfwCreateTaskGraph( void );
+GLFWAPI void GLFWAPIENTRY glfwDestroyTaskGraph( GLFWtaskgraph graph );
+GLFWAPI int  GLFWAPIENTRY glfwAddTask( GLFWtaskgraph graph, GLFWjobfun fun, void *arg );
+GLFWAPI int  GLFWAPIENTRY glfwAddDependency( GLFWtaskgraph graph, int task, int dependency );
+GLFWAPI void GLFWAPIENTRY glfwRunTaskGraph( GLFWtaskgraph graph, GLFWthreadpool pool );
 
 /* Enable/disable functions */
 GLFWAPI void GLFWAPIENTRY glfwEnable( int token );
@@ -505,9 +772,168 @@ GLFWAPI void GLFWAPIENTRY glfwDisable( int token );
 GLFWAPI int  GLFWAPIENTRY glfwReadImage( const char *name, GLFWimage *img, int flags );
 GLFWAPI int  GLFWAPIENTRY glfwReadMemoryImage( const void *data, long size, GLFWimage *img, int flags );
 GLFWAPI void GLFWAPIENTRY glfwFreeImage( GLFWimage *img );
+GLFWAPI int  GLFWAPIENTRY glfwWriteImage( const char *name, const GLFWimage *img, int flags );
+GLFWAPI int  GLFWAPIENTRY glfwConvertImage( const GLFWimage *src, GLFWimage *dst, int format, int flags );
+GLFWAPI int  GLFWAPIENTRY glfwGenerateDistanceField( GLFWimage *alpha, int spread, int downscale );
+GLFWAPI void GLFWAPIENTRY glfwSetImagePoolSize( long bytes );
+GLFWAPI void GLFWAPIENTRY glfwTrimImagePool( void );
+GLFWAPI void GLFWAPIENTRY glfwGetMemoryStats( GLFWmemstats *stats );
 GLFWAPI int  GLFWAPIENTRY glfwLoadTexture2D( const char *name, int flags );
 GLFWAPI int  GLFWAPIENTRY glfwLoadMemoryTexture2D( const void *data, long size, int flags );
 GLFWAPI int  GLFWAPIENTRY glfwLoadTextureImage2D( GLFWimage *img, int flags );
+GLFWAPI int  GLFWAPIENTRY glfwLoadTextureArray( const char **names, int count, int flags );
+GLFWAPI int  GLFWAPIENTRY glfwLoadTextureCube( const char **names, int flags );
+GLFWAPI int  GLFWAPIENTRY glfwUpdateTextureRegion( const GLFWimage *img, int x, int y, int width, int height, int flags );
+GLFWAPI int  GLFWAPIENTRY glfwUpdateTextureRegions( const GLFWimage *img, const GLFWrect *rects, int count, int flags );
+
+/* Texture cache */
+GLFWAPI void   GLFWAPIENTRY glfwSetTextureCacheSize( long bytes );
+GLFWAPI GLuint GLFWAPIENTRY glfwLoadCachedTexture2D( const char *name, int flags );
+GLFWAPI GLuint GLFWAPIENTRY glfwLoadCachedMemoryTexture2D( const void *data, long size, int flags );
+GLFWAPI void   GLFWAPIENTRY glfwReleaseCachedTexture( GLuint texture );
+GLFWAPI int    GLFWAPIENTRY glfwSetTextureCacheDir( const char *path );
+
+/* Texture residency management (a budget of zero, the default, means
+ * no limit, so textures are only evicted once a budget has been set) */
+GLFWAPI void   GLFWAPIENTRY glfwSetTextureBudget( long bytes );
+GLFWAPI int    GLFWAPIENTRY glfwCreateResidentTexture( const char *name, int flags );
+GLFWAPI int    GLFWAPIENTRY glfwCreateResidentTextureImage( GLFWimage *img, int flags );
+GLFWAPI void   GLFWAPIENTRY glfwDestroyResidentTexture( int handle );
+GLFWAPI GLuint GLFWAPIENTRY glfwUseResidentTexture( int handle );
+GLFWAPI void   GLFWAPIENTRY glfwPrefetchResidentTexture( int handle );
+GLFWAPI void   GLFWAPIENTRY glfwUpdateResidency( void );
+GLFWAPI long   GLFWAPIENTRY glfwGetResidentBytes( void );
+
+/* Virtual texture streaming */
+GLFWAPI GLFWvtexture GLFWAPIENTRY glfwCreateVirtualTexture( const char *name, int tilesize, int cachetiles, int flags );
+GLFWAPI void GLFWAPIENTRY glfwDestroyVirtualTexture( GLFWvtexture vt );
+GLFWAPI void GLFWAPIENTRY glfwRequestVirtualTiles( GLFWvtexture vt, const int *tiles, int count );
+GLFWAPI int  GLFWAPIENTRY glfwUpdateVirtualTexture( GLFWvtexture vt, int maxuploads );
+GLFWAPI void GLFWAPIENTRY glfwGetVirtualTextureInfo( GLFWvtexture vt, GLFWvtexinfo *info );
+
+/* Framebuffer capture */
+GLFWAPI int  GLFWAPIENTRY glfwCaptureFramebufferAsync( const char *name, int flags );
+GLFWAPI void GLFWAPIENTRY glfwFinishCaptures( void );
+
+/* Image sequence playback */
+GLFWAPI GLFWsequence GLFWAPIENTRY glfwOpenImageSequence( const char *pattern, double fps, int flags );
+GLFWAPI void   GLFWAPIENTRY glfwCloseImageSequence( GLFWsequence seq );
+GLFWAPI GLuint GLFWAPIENTRY glfwGetSequenceFrame( GLFWsequence seq, double time );
+GLFWAPI int    GLFWAPIENTRY glfwGetSequenceLength( GLFWsequence seq );
+
+/* Texture atlas support */
+GLFWAPI int  GLFWAPIENTRY glfwPackImages( const GLFWimage *images, int count, int maxsize, int padding, GLFWatlas *atlas );
+GLFWAPI void GLFWAPIENTRY glfwFreeAtlas( GLFWatlas *atlas );
+GLFWAPI int  GLFWAPIENTRY glfwLoadTextureAtlas2D( const GLFWimage *images, const GLFWatlas *atlas, int flags );
+
+
+
+/*************************************************************************
+ * Atomic operations
+ *
+ * These never need glfwInit. With GCC 4.7 or later and with Clang they
+ * are inline functions, unless GLFW_NO_INLINE_ATOMICS is defined before
+ * including this file. Other compilers call the library.
+ *
+ * Add and Exchange return the previous value. CompareExchange stores
+ * desired if the value equals *expected and returns GL_TRUE, or else
+ * stores the value in *expected and returns GL_FALSE.
+ *************************************************************************/
+
+#if !defined(GLFW_NO_INLINE_ATOMICS) && (defined(__clang__) || \
+    (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))))
+
+/* A compare-exchange that fails only loads, so it can not release */
+#define GLFW_ATOMIC_FAILURE_ORDER(order) \
+    ((order) == GLFW_ATOMIC_RELEASE ? GLFW_ATOMIC_RELAXED : \
+     (order) == GLFW_ATOMIC_ACQ_REL ? GLFW_ATOMIC_ACQUIRE : (order))
+
+static __inline__ int glfwAtomicLoad32( const volatile int *value, int order )
+{
+    return __atomic_load_n( value, order );
+}
+static __inline__ void glfwAtomicStore32( volatile int *value, int desired, int order )
+{
+    __atomic_store_n( value, desired, order );
+}
+static __inline__ int glfwAtomicAdd32( volatile int *value, int delta, int order )
+{
+    return __atomic_fetch_add( value, delta, order );
+}
+static __inline__ int glfwAtomicExchange32( volatile int *value, int desired, int order )
+{
+    return __atomic_exchange_n( value, desired, order );
+}
+static __inline__ int glfwAtomicCompareExchange32( volatile int *value, int *expected, int desired, int order )
+{
+    return __atomic_compare_exchange_n( value, expected, desired, 0, order,
+                                        GLFW_ATOMIC_FAILURE_ORDER(order) );
+}
+
+static __inline__ GLFWint64 glfwAtomicLoad64( const volatile GLFWint64 *value, int order )
+{
+    return __atomic_load_n( value, order );
+}
+static __inline__ void glfwAtomicStore64( volatile GLFWint64 *value, GLFWint64 desired, int order )
+{
+    __atomic_store_n( value, desired, order );
+}
+static __inline__ GLFWint64 glfwAtomicAdd64( volatile GLFWint64 *value, GLFWint64 delta, int order )
+{
+    return __atomic_fetch_add( value, delta, order );
+}
+static __inline__ GLFWint64 glfwAtomicExchange64( volatile GLFWint64 *value, GLFWint64 desired, int order )
+{
+    return __atomic_exchange_n( value, desired, order );
+}
+static __inline__ int glfwAtomicCompareExchange64( volatile GLFWint64 *value, GLFWint64 *expected, GLFWint64 desired, int order )
+{
+    return __atomic_compare_exchange_n( value, expected, desired, 0, order,
+                                        GLFW_ATOMIC_FAILURE_ORDER(order) );
+}
+
+static __inline__ void *glfwAtomicLoadPtr( void * const volatile *value, int order )
+{
+    return __atomic_load_n( value, order );
+}
+static __inline__ void glfwAtomicStorePtr( void * volatile *value, void *desired, int order )
+{
+    __atomic_store_n( value, desired, order );
+}
+static __inline__ void *glfwAtomicExchangePtr( void * volatile *value, void *desired, int order )
+{
+    return __atomic_exchange_n( value, desired, order );
+}
+static __inline__ int glfwAtomicCompareExchangePtr( void * volatile *value, void **expected, void *desired, int order )
+{
+    return __atomic_compare_exchange_n( value, expected, desired, 0, order,
+                                        GLFW_ATOMIC_FAILURE_ORDER(order) );
+}
+
+static __inline__ void glfwThreadFence( int order )
+{
+    __atomic_thread_fence( order );
+}
+
+#else
+
+GLFWAPI int  GLFWAPIENTRY glfwAtomicLoad32( const volatile int *value, int order );
+GLFWAPI void GLFWAPIENTRY glfwAtomicStore32( volatile int *value, int desired, int order );
+GLFWAPI int  GLFWAPIENTRY glfwAtomicAdd32( volatile int *value, int delta, int order );
+GLFWAPI int  GLFWAPIENTRY glfwAtomicExchange32( volatile int *value, int desired, int order );
+GLFWAPI int  GLFWAPIENTRY glfwAtomicCompareExchange32( volatile int *value, int *expected, int desired, int order );
+GLFWAPI GLFWint64 GLFWAPIENTRY glfwAtomicLoad64( const volatile GLFWint64 *value, int order );
+GLFWAPI void GLFWAPIENTRY glfwAtomicStore64( volatile GLFWint64 *value, GLFWint64 desired, int order );
+GLFWAPI GLFWint64 GLFWAPIENTRY glfwAtomicAdd64( volatile GLFWint64 *value, GLFWint64 delta, int order );
+GLFWAPI GLFWint64 GLFWAPIENTRY glfwAtomicExchange64( volatile GLFWint64 *value, GLFWint64 desired, int order );
+GLFWAPI int  GLFWAPIENTRY glfwAtomicCompareExchange64( volatile GLFWint64 *value, GLFWint64 *expected, GLFWint64 desired, int order );
+GLFWAPI void * GLFWAPIENTRY glfwAtomicLoadPtr( void * const volatile *value, int order );
+GLFWAPI void GLFWAPIENTRY glfwAtomicStorePtr( void * volatile *value, void *desired, int order );
+GLFWAPI void * GLFWAPIENTRY glfwAtomicExchangePtr( void * volatile *value, void *desired, int order );
+GLFWAPI int  GLFWAPIENTRY glfwAtomicCompareExchangePtr( void * volatile *value, void **expected, void *desired, int order );
+GLFWAPI void GLFWAPIENTRY glfwThreadFence( int order );
+
+#endif /* Inline atomics */
 
 
 #ifdef __cplusplus
@@ -252,7 +252,7 @@ static void _glfwTerminateThreads(void)
         IExec->RemTask(t->AmiTask);
 
         // Free memory allocated for this thread
-        free((void *)t);
+        _glfwFree((void *)t);
 
         // Select next thread in list
         t = t_next;
@@ -112,7 +112,8 @@ int _glfwNewThread( void )
 // _glfwPlatformCreateThread() - Create a new thread
 //========================================================================
 
-GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg )
+GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg,
+                                      const GLFWthreadattr *attr )
 {
     GLFWthread     ID;
     _GLFWthread    *t;
@@ -124,7 +125,8 @@ GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg )
     ENTER_THREAD_CRITICAL_SECTION
 
     // Create a new thread information memory area
-    t = (_GLFWthread *) malloc( sizeof(_GLFWthread) );
+    t = (_GLFWthread *) _glfwMallocAs( sizeof(_GLFWthread),
+                                       GLFW_MEMORY_THREAD );
     if( t == NULL )
     {
         // Leave critical section
@@ -145,7 +147,18 @@ GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg )
     tagList[ tagNR   ].ti_Tag  = NP_Entry;
     tagList[ tagNR++ ].ti_Data = (ULONG) _glfwNewThread;
     tagList[ tagNR   ].ti_Tag  = NP_StackSize;
-    tagList[ tagNR++ ].ti_Data = _GLFW_TASK_STACK_SIZE;
+    tagList[ tagNR++ ].ti_Data = attr != NULL && attr->StackSize > 0 ?
+                                 attr->StackSize : _GLFW_TASK_STACK_SIZE;
+    if( attr != NULL && attr->Priority != GLFW_PRIORITY_NORMAL )
+    {
+        tagList[ tagNR   ].ti_Tag  = NP_Priority;
+        tagList[ tagNR++ ].ti_Data = (ULONG) attr->Priority;
+    }
+    if( attr != NULL && attr->Name != NULL )
+    {
+        tagList[ tagNR   ].ti_Tag  = NP_Name;
+        tagList[ tagNR++ ].ti_Data = (ULONG) attr->Name;
+    }
     tagList[ tagNR   ].ti_Tag  = NP_Input;
     tagList[ tagNR++ ].ti_Data = (ULONG) IDOS->Input();
     tagList[ tagNR   ].ti_Tag  = NP_Output;
@@ -160,7 +173,7 @@ GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg )
     // Did the process creation fail?
     if( !t->AmiProc )
     {
-        free( (void *) t );
+        _glfwFree( (void *) t );
         LEAVE_THREAD_CRITICAL_SECTION
         return -1;
     }
@@ -225,6 +238,17 @@ void _glfwPlatformDestroyThread( GLFWthread ID )
 }
 
 
+//========================================================================
+// _glfwPlatformSetThreadAffinity() - Restrict a thread to a set of
+// processors. AmigaOS does not support this
+//========================================================================
+
+int _glfwPlatformSetThreadAffinity( GLFWthread ID, const GLFWcpumask *mask )
+{
+    return GL_FALSE;
+}
+
+
 //========================================================================
 // _glfwPlatformWaitThread() - Wait for a thread to die
 //========================================================================
@@ -304,7 +328,8 @@ GLFWmutex _glfwPlatformCreateMutex( void )
     struct SignalSemaphore *mutex;
 
     // Allocate memory for mutex
-    mutex = (struct SignalSemaphore *) malloc( sizeof(struct SignalSemaphore) );
+    mutex = (struct SignalSemaphore *)
+        _glfwMallocAs( sizeof(struct SignalSemaphore), GLFW_MEMORY_SYNC );
     if( !mutex )
     {
         return NULL;
@@ -326,7 +351,7 @@ GLFWmutex _glfwPlatformCreateMutex( void )
 void _glfwPlatformDestroyMutex( GLFWmutex mutex )
 {
     // Free memory for mutex object
-    free( (void *) mutex );
+    _glfwFree( (void *) mutex );
 }
 
 
@@ -383,7 +408,7 @@ void _glfwPlatformDestroyCond( GLFWcond cond )
 // _glfwPlatformWaitCond() - Wait for a condition to be raised
 //========================================================================
 
-void _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex,
+int _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex,
     double timeout )
 {
     struct Task *amiTask;
@@ -396,7 +421,7 @@ void _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex,
         IExec->ReleaseSemaphore( (struct SignalSemaphore *) mutex );
         IDOS->Delay( 1 );
         IExec->ObtainSemaphore( (struct SignalSemaphore *) mutex );
-        return;
+        return GL_FALSE;
     }
 
     // Find pointer to this threads structure
@@ -417,6 +442,8 @@ void _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex,
 
     // Reacquire the mutex
     IExec->ObtainSemaphore( (struct SignalSemaphore *) mutex );
+
+    return GL_TRUE;
 }
 
 
@@ -477,3 +504,55 @@ int _glfwPlatformGetNumberOfProcessors( void )
     IExec->GetCPUInfoTags(GCIT_NumberOfCPUs, &cpus, TAG_DONE);
     return cpus;
 }
+
+
+//========================================================================
+// _glfwPlatformGetProcessorTopology() - Describe the processors of the
+// system. AmigaOS does not tell how they are grouped, so the topology
+// is guessed instead
+//========================================================================
+
+int _glfwPlatformGetProcessorTopology( GLFWtopology *topology )
+{
+    return GL_FALSE;
+}
+
+
+//========================================================================
+// _glfwPlatformAtomicAdd() - Atomically add to a value, returning the new
+// value
+//========================================================================
+
+long _glfwPlatformAtomicAdd( volatile long *value, long delta )
+{
+    long result;
+
+    IExec->Forbid();
+    result = ( *value += delta );
+    IExec->Permit();
+
+    return result;
+}
+
+
+//========================================================================
+// _glfwPlatformAtomicCompareSwap() - Atomically replace a value if it
+// equals the expected one, returning the previous value
+//========================================================================
+
+long _glfwPlatformAtomicCompareSwap( volatile long *value, long expected,
+                                     long desired )
+{
+    long result;
+
+    IExec->Forbid();
+    result = *value;
+    if( result == expected )
+    {
+        *value = desired;
+    }
+    IExec->Permit();
+
+    return result;
+}
+
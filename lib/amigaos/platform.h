@@ -148,10 +148,24 @@ struct _GLFWwin_struct
     // OpenGL extensions and context attributes
     int       has_GL_SGIS_generate_mipmap;
     int       has_GL_ARB_texture_non_power_of_two;
+    int       has_GL_ARB_texture_cube_map;
+    int       has_GL_EXT_texture_array;
+    int       has_GL_EXT_texture_compression_s3tc;
+    int       has_GL_ARB_pixel_buffer_object;
     int       glMajor, glMinor, glRevision;
     int       glForward, glDebug, glProfile;
 
     PFNGLGETSTRINGIPROC GetStringi;
+    PFNGLTEXIMAGE3DPROC TexImage3D;
+    PFNGLTEXSUBIMAGE3DPROC TexSubImage3D;
+    PFNGLCOMPRESSEDTEXIMAGE2DPROC CompressedTexImage2D;
+    PFNGLGETCOMPRESSEDTEXIMAGEPROC GetCompressedTexImage;
+    PFNGLGENBUFFERSPROC GenBuffers;
+    PFNGLDELETEBUFFERSPROC DeleteBuffers;
+    PFNGLBINDBUFFERPROC BindBuffer;
+    PFNGLBUFFERDATAPROC BufferData;
+    PFNGLMAPBUFFERPROC MapBuffer;
+    PFNGLUNMAPBUFFERPROC UnmapBuffer;
 
     // ========= PLATFORM SPECIFIC PART ======================================
 
@@ -259,6 +273,9 @@ struct _GLFWthread_struct
     // Pointer to previous and next threads in linked list
     _GLFWthread *Previous, *Next;
 
+    // Next thread in the same thread ID hash bucket
+    _GLFWthread *HashNext;
+
     // GLFW user side thread information
     GLFWthread ID;
 
@@ -288,6 +305,9 @@ GLFWGLOBAL struct
     // First thread in linked list (always the main thread)
     _GLFWthread First;
 
+    // Thread ID hash table (all threads but the main thread)
+    _GLFWthread *Buckets[ _GLFW_THREAD_BUCKETS ];
+
     // ========= PLATFORM SPECIFIC PART ======================================
 
     // Critical section lock
@@ -0,0 +1,591 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+//========================================================================
+// Description:
+//
+// This module packs many small images into a single texture atlas, so
+// that they can be drawn without rebinding textures.
+//
+// glfwPackImages places the images with a skyline bottom-left packer,
+// trying power-of-two atlas sizes from the smallest one that could hold
+// all images up to the given maximum size. Every image is surrounded by
+// a gutter of padding pixels.
+//
+// glfwLoadTextureAtlas2D composes the atlas and uploads it. The gutters
+// are filled by extending the edge pixels of each image, and are filled
+// again for every mipmap level, so that filtering and mipmapping do not
+// bleed neighbouring images into each other.
+//
+//========================================================================
+
+
+#include "internal.h"
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+//========================================================================
+// Skyline segment (the top edge of the packed area over a span of x)
+//========================================================================
+
+typedef struct {
+    int x, y, width;
+} _GLFWskyline;
+
+
+//========================================================================
+// Check whether a rectangle fits on the skyline starting at a segment
+//========================================================================
+
+static int FitSkyline( const _GLFWskyline *nodes, int count, int index,
+    int width, int height, int atlasWidth, int atlasHeight, int *y )
+{
+    int remaining, n;
+
+    if( nodes[ index ].x + width > atlasWidth )
+    {
+        return GL_FALSE;
+    }
+
+    // The rectangle rests on the highest segment it spans
+    *y = nodes[ index ].y;
+    remaining = width;
+    for( n = index; remaining > 0; n ++ )
+    {
+        if( n == count )
+        {
+            return GL_FALSE;
+        }
+        if( nodes[ n ].y > *y )
+        {
+            *y = nodes[ n ].y;
+        }
+        remaining -= nodes[ n ].width;
+    }
+
+    return *y + height <= atlasHeight;
+}
+
+
+//========================================================================
+// Place a rectangle on the skyline and update the segments
+//========================================================================
+
+static int AddSkyline( _GLFWskyline *nodes, int count, int index,
+    int x, int y, int width )
+{
+    int n, shrink;
+
+    // Insert the new segment on top of the rectangle
+    memmove( nodes + index + 1, nodes + index,
+             (count - index) * sizeof( _GLFWskyline ) );
+    nodes[ index ].x     = x;
+    nodes[ index ].y     = y;
+    nodes[ index ].width = width;
+    count ++;
+
+    // Cut away the segments now covered by the rectangle
+    for( n = index + 1; n < count; n ++ )
+    {
+        if( nodes[ n ].x >= x + width )
+        {
+            break;
+        }
+
+        shrink = x + width - nodes[ n ].x;
+        nodes[ n ].x     += shrink;
+        nodes[ n ].width -= shrink;
+        if( nodes[ n ].width > 0 )
+        {
+            break;
+        }
+
+        memmove( nodes + n, nodes + n + 1,
+                 (count - n - 1) * sizeof( _GLFWskyline ) );
+        count --;
+        n --;
+    }
+
+    // Merge neighbouring segments of equal height
+    for( n = 0; n < count - 1; n ++ )
+    {
+        if( nodes[ n ].y == nodes[ n + 1 ].y )
+        {
+            nodes[ n ].width += nodes[ n + 1 ].width;
+            memmove( nodes + n + 1, nodes + n + 2,
+                     (count - n - 2) * sizeof( _GLFWskyline ) );
+            count --;
+            n --;
+        }
+    }
+
+    return count;
+}
+
+
+//========================================================================
+// Try to pack all images into an atlas of the given size
+//========================================================================
+
+static int PackSkyline( const GLFWimage *images, const int *order,
+    int count, int padding, int width, int height, GLFWatlasrect *rects,
+    _GLFWskyline *nodes )
+{
+    int i, n, w, h, y, best, bestx, besty, bestwidth, nodecount;
+
+    nodes[ 0 ].x     = 0;
+    nodes[ 0 ].y     = 0;
+    nodes[ 0 ].width = width;
+    nodecount = 1;
+
+    for( i = 0; i < count; i ++ )
+    {
+        w = images[ order[ i ] ].Width + padding * 2;
+        h = images[ order[ i ] ].Height + padding * 2;
+
+        // Bottom-left rule: lowest top edge, then narrowest segment
+        best = -1;
+        bestx = besty = bestwidth = 0;
+        for( n = 0; n < nodecount; n ++ )
+        {
+            if( FitSkyline( nodes, nodecount, n, w, h, width, height, &y ) )
+            {
+                if( best == -1 || y < besty ||
+                    ( y == besty && nodes[ n ].width < bestwidth ) )
+                {
+                    best      = n;
+                    bestx     = nodes[ n ].x;
+                    besty     = y;
+                    bestwidth = nodes[ n ].width;
+                }
+            }
+        }
+
+        if( best == -1 )
+        {
+            return GL_FALSE;
+        }
+
+        nodecount = AddSkyline( nodes, nodecount, best, bestx, besty + h, w );
+
+        rects[ order[ i ] ].X      = bestx + padding;
+        rects[ order[ i ] ].Y      = besty + padding;
+        rects[ order[ i ] ].Width  = w - padding * 2;
+        rects[ order[ i ] ].Height = h - padding * 2;
+    }
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Extend the edge pixels of an atlas rectangle into its gutter, at the
+// given mipmap level
+//========================================================================
+
+static void FillGutter( GLFWimage *img, const GLFWatlasrect *rect,
+    int padding, int level )
+{
+    int x0, y0, x1, y1, gx0, gy0, gx1, gy1, x, y, bpp, stride;
+    unsigned char *row;
+
+    padding >>= level;
+    if( padding == 0 )
+    {
+        return;
+    }
+
+    bpp    = img->BytesPerPixel;
+    stride = img->Width * bpp;
+
+    // Rectangle interior at this level (never wider than its footprint)
+    x0 = rect->X >> level;
+    y0 = rect->Y >> level;
+    x1 = (rect->X + rect->Width) >> level;
+    y1 = (rect->Y + rect->Height) >> level;
+    if( x1 <= x0 ) x1 = x0 + 1;
+    if( y1 <= y0 ) y1 = y0 + 1;
+
+    gx0 = x0 - padding > 0 ? x0 - padding : 0;
+    gy0 = y0 - padding > 0 ? y0 - padding : 0;
+    gx1 = x1 + padding < img->Width ? x1 + padding : img->Width;
+    gy1 = y1 + padding < img->Height ? y1 + padding : img->Height;
+
+    // Left and right gutters
+    for( y = y0; y < y1; y ++ )
+    {
+        row = img->Data + y * stride;
+        for( x = gx0; x < x0; x ++ )
+        {
+            memcpy( row + x * bpp, row + x0 * bpp, bpp );
+        }
+        for( x = x1; x < gx1; x ++ )
+        {
+            memcpy( row + x * bpp, row + (x1 - 1) * bpp, bpp );
+        }
+    }
+
+    // Bottom and top gutters, including the corners
+    for( y = gy0; y < y0; y ++ )
+    {
+        memcpy( img->Data + y * stride + gx0 * bpp,
+                img->Data + y0 * stride + gx0 * bpp, (gx1 - gx0) * bpp );
+    }
+    for( y = y1; y < gy1; y ++ )
+    {
+        memcpy( img->Data + y * stride + gx0 * bpp,
+                img->Data + (y1 - 1) * stride + gx0 * bpp,
+                (gx1 - gx0) * bpp );
+    }
+}
+
+
+//========================================================================
+// Compose the level zero image of an atlas
+//========================================================================
+
+static int ComposeAtlas( const GLFWimage *images, const GLFWatlas *atlas,
+    int format, GLFWimage *img )
+{
+    int n, y, bpp, glformat;
+    GLFWimage tmp;
+    const GLFWimage *src;
+
+    bpp = _glfwGetPixelFormatSize( format, &glformat );
+
+    img->Width         = atlas->Width;
+    img->Height        = atlas->Height;
+    img->Format        = glformat;
+    img->BytesPerPixel = bpp;
+    img->Data = (unsigned char *)
+        _glfwAllocPixels( atlas->Width * atlas->Height * bpp );
+    if( img->Data == NULL )
+    {
+        return GL_FALSE;
+    }
+    memset( img->Data, 0, atlas->Width * atlas->Height * bpp );
+
+    for( n = 0; n < atlas->Count; n ++ )
+    {
+        // Convert the image to the atlas format, if necessary
+        src = &images[ n ];
+        if( _glfwGetPixelFormat( src ) != format )
+        {
+            if( !glfwConvertImage( src, &tmp, format, 0 ) )
+            {
+                _glfwFreePixels( img->Data );
+                return GL_FALSE;
+            }
+            src = &tmp;
+        }
+
+        for( y = 0; y < src->Height; y ++ )
+        {
+            memcpy( img->Data + ((atlas->Rects[ n ].Y + y) * img->Width +
+                                 atlas->Rects[ n ].X) * bpp,
+                    src->Data + y * src->Width * bpp,
+                    src->Width * bpp );
+        }
+
+        if( src == &tmp )
+        {
+            _glfwFreePixels( tmp.Data );
+        }
+
+        FillGutter( img, &atlas->Rects[ n ], atlas->Padding, 0 );
+    }
+
+    return GL_TRUE;
+}
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Pack a set of images into a texture atlas layout
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwPackImages( const GLFWimage *images,
+    int count, int maxsize, int padding, GLFWatlas *atlas )
+{
+    int *order, n, k, t, width, height, maxwidth, maxheight;
+    long area;
+    GLFWatlasrect *rects;
+    _GLFWskyline *nodes;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return GL_FALSE;
+    }
+
+    atlas->Width   = 0;
+    atlas->Height  = 0;
+    atlas->Padding = 0;
+    atlas->Count   = 0;
+    atlas->Rects   = NULL;
+
+    if( count < 1 || padding < 0 )
+    {
+        return GL_FALSE;
+    }
+
+    for( n = 0; n < count; n ++ )
+    {
+        if( images[ n ].Width < 1 || images[ n ].Height < 1 )
+        {
+            return GL_FALSE;
+        }
+    }
+
+    rects = (GLFWatlasrect *) _glfwMalloc( count * sizeof( GLFWatlasrect ) );
+    order = (int *) _glfwMalloc( count * sizeof( int ) );
+    nodes = (_GLFWskyline *)
+        _glfwMalloc( (count + 2) * sizeof( _GLFWskyline ) );
+    if( rects == NULL || order == NULL || nodes == NULL )
+    {
+        _glfwFree( rects );
+        _glfwFree( order );
+        _glfwFree( nodes );
+        return GL_FALSE;
+    }
+
+    // Pack tall images first (insertion sort keeps the order stable)
+    area = 0;
+    maxwidth = maxheight = 1;
+    for( n = 0; n < count; n ++ )
+    {
+        t = images[ n ].Height;
+        for( k = n; k > 0 && images[ order[ k - 1 ] ].Height < t; k -- )
+        {
+            order[ k ] = order[ k - 1 ];
+        }
+        order[ k ] = n;
+
+        area += (long) (images[ n ].Width + padding * 2) *
+                (long) (images[ n ].Height + padding * 2);
+        if( images[ n ].Width + padding * 2 > maxwidth )
+        {
+            maxwidth = images[ n ].Width + padding * 2;
+        }
+        if( images[ n ].Height + padding * 2 > maxheight )
+        {
+            maxheight = images[ n ].Height + padding * 2;
+        }
+    }
+
+    // Start with the smallest power-of-two square that could possibly fit
+    for( width = 1; width < maxwidth || (long) width * width < area;
+         width <<= 1 )
+      ;
+    for( height = width > 1 ? width >> 1 : 1;
+         height < maxheight || (long) width * height < area; height <<= 1 )
+      ;
+
+    // Grow the atlas until everything fits
+    while( width <= maxsize && height <= maxsize )
+    {
+        if( PackSkyline( images, order, count, padding, width, height,
+                         rects, nodes ) )
+        {
+            break;
+        }
+
+        if( height < width )
+        {
+            height <<= 1;
+        }
+        else
+        {
+            width <<= 1;
+        }
+    }
+
+    _glfwFree( order );
+    _glfwFree( nodes );
+
+    if( width > maxsize || height > maxsize )
+    {
+        _glfwFree( rects );
+        return GL_FALSE;
+    }
+
+    // Compute texture coordinates
+    for( n = 0; n < count; n ++ )
+    {
+        rects[ n ].S0 = (float) rects[ n ].X / (float) width;
+        rects[ n ].T0 = (float) rects[ n ].Y / (float) height;
+        rects[ n ].S1 = (float) (rects[ n ].X + rects[ n ].Width) /
+                        (float) width;
+        rects[ n ].T1 = (float) (rects[ n ].Y + rects[ n ].Height) /
+                        (float) height;
+    }
+
+    atlas->Width   = width;
+    atlas->Height  = height;
+    atlas->Padding = padding;
+    atlas->Count   = count;
+    atlas->Rects   = rects;
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Free memory allocated for an atlas layout
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwFreeAtlas( GLFWatlas *atlas )
+{
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return;
+    }
+
+    if( atlas->Rects != NULL )
+    {
+        _glfwFree( atlas->Rects );
+        atlas->Rects = NULL;
+    }
+
+    atlas->Width   = 0;
+    atlas->Height  = 0;
+    atlas->Padding = 0;
+    atlas->Count   = 0;
+}
+
+
+//========================================================================
+// Compose the images of an atlas and upload it to texture memory
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwLoadTextureAtlas2D( const GLFWimage *images,
+    const GLFWatlas *atlas, int flags )
+{
+    GLint   UnpackAlignment, internalformat;
+    GLenum  format, type;
+    int     n, level, pixelformat, packformat;
+    GLFWimage img;
+    unsigned char *packed, *data;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwWin.opened )
+    {
+        return GL_FALSE;
+    }
+
+    if( atlas->Rects == NULL )
+    {
+        return GL_FALSE;
+    }
+
+    pixelformat = _glfwGetCommonPixelFormat( images, atlas->Count );
+    if( !ComposeAtlas( images, atlas, pixelformat, &img ) )
+    {
+        return GL_FALSE;
+    }
+
+    // Premultiply alpha before any mipmap levels are built
+    if( flags & GLFW_PREMULTIPLY_ALPHA_BIT )
+    {
+        _glfwConvertPixels( &img, img.Data, pixelformat,
+                            GLFW_PREMULTIPLY_ALPHA_BIT );
+    }
+
+    // Should we pack the texture into 16-bit pixels?
+    packformat = _glfwGetPackFormat( pixelformat, flags );
+    packed = NULL;
+    if( packformat )
+    {
+        packed = (unsigned char *)
+            _glfwAllocPixels( img.Width * img.Height * 2 );
+        if( packed == NULL )
+        {
+            _glfwFreePixels( img.Data );
+            return GL_FALSE;
+        }
+    }
+
+    _glfwGetUploadFormat( packformat ? packformat : pixelformat,
+                          &internalformat, &format, &type );
+
+    // Set unpack alignment to one byte
+    glGetIntegerv( GL_UNPACK_ALIGNMENT, &UnpackAlignment );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+    // Mipmaps are always built here, as the gutters must be refilled for
+    // every level
+    level = 0;
+    do
+    {
+        if( level > 0 )
+        {
+            for( n = 0; n < atlas->Count; n ++ )
+            {
+                FillGutter( &img, &atlas->Rects[ n ], atlas->Padding, level );
+            }
+        }
+
+        data = img.Data;
+        if( packformat )
+        {
+            _glfwConvertPixels( &img, packed, packformat,
+                                flags & GLFW_DITHER_BIT );
+            data = packed;
+        }
+
+        glTexImage2D( GL_TEXTURE_2D, level, internalformat,
+            img.Width, img.Height, 0, format, type, (void*) data );
+
+        if( flags & GLFW_BUILD_MIPMAPS_BIT )
+        {
+            level = _glfwHalveImage( img.Data, &img.Width, &img.Height,
+                                     img.BytesPerPixel ) ? level + 1 : 0;
+        }
+    }
+    while( level != 0 );
+
+    // Restore old unpack alignment
+    glPixelStorei( GL_UNPACK_ALIGNMENT, UnpackAlignment );
+
+    if( packed )
+    {
+        _glfwFreePixels( packed );
+    }
+    _glfwFreePixels( img.Data );
+
+    return GL_TRUE;
+}
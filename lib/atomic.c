@@ -0,0 +1,470 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+//========================================================================
+// Description:
+//
+// This module holds the library versions of the atomic operations that
+// glfw.h defines inline for GCC and Clang. They are what other compilers,
+// and languages binding to the library, call.
+//
+// Where the compiler has no atomic builtins, Win32 gets its interlocked
+// functions for 32-bit and pointer sized values. Everything else is done
+// under a spin lock built on the platform compare-and-swap, which is
+// correct but slower.
+//
+//========================================================================
+
+// We define the exported functions, so glfw.h must only declare them
+#define GLFW_NO_INLINE_ATOMICS
+
+#include "internal.h"
+
+
+#if defined( __clang__ ) || ( defined( __GNUC__ ) && \
+    ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 7 ) ) )
+ #define _GLFW_HAS_ATOMIC_BUILTINS
+#elif defined( _WIN32 )
+ #define _GLFW_HAS_INTERLOCKED
+#endif
+
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+
+// A compare-exchange that fails only loads, so it can not release
+#define _glfw_failure_order( order ) \
+    ( (order) == GLFW_ATOMIC_RELEASE ? GLFW_ATOMIC_RELAXED : \
+      (order) == GLFW_ATOMIC_ACQ_REL ? GLFW_ATOMIC_ACQUIRE : (order) )
+
+#else
+
+// Spin lock for the operations that have no lock-free implementation
+static volatile long _glfwAtomicLock = 0;
+
+#endif
+
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+#if !defined( _GLFW_HAS_ATOMIC_BUILTINS )
+
+//========================================================================
+// Enter and leave the atomic operation spin lock. It is only held for a
+// handful of instructions, so waiting for it by spinning is fine
+//========================================================================
+
+static void LockAtomics( void )
+{
+    while( _glfwPlatformAtomicCompareSwap( &_glfwAtomicLock, 0, 1 ) != 0 )
+    {
+    }
+}
+
+static void UnlockAtomics( void )
+{
+    _glfwPlatformAtomicCompareSwap( &_glfwAtomicLock, 1, 0 );
+}
+
+#endif // !_GLFW_HAS_ATOMIC_BUILTINS
+
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Atomically load a 32-bit integer
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwAtomicLoad32( const volatile int *value,
+    int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    return __atomic_load_n( value, order );
+#elif defined( _GLFW_HAS_INTERLOCKED )
+    return (int) InterlockedCompareExchange( (volatile LONG *) value, 0, 0 );
+#else
+    int result;
+
+    LockAtomics();
+    result = *value;
+    UnlockAtomics();
+
+    return result;
+#endif
+}
+
+
+//========================================================================
+// Atomically store a 32-bit integer
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwAtomicStore32( volatile int *value,
+    int desired, int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    __atomic_store_n( value, desired, order );
+#elif defined( _GLFW_HAS_INTERLOCKED )
+    InterlockedExchange( (volatile LONG *) value, (LONG) desired );
+#else
+    LockAtomics();
+    *value = desired;
+    UnlockAtomics();
+#endif
+}
+
+
+//========================================================================
+// Atomically add to a 32-bit integer, returning the previous value
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwAtomicAdd32( volatile int *value, int delta,
+    int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    return __atomic_fetch_add( value, delta, order );
+#elif defined( _GLFW_HAS_INTERLOCKED )
+    return (int) InterlockedExchangeAdd( (volatile LONG *) value,
+                                         (LONG) delta );
+#else
+    int result;
+
+    LockAtomics();
+    result = *value;
+    *value = result + delta;
+    UnlockAtomics();
+
+    return result;
+#endif
+}
+
+
+//========================================================================
+// Atomically replace a 32-bit integer, returning the previous value
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwAtomicExchange32( volatile int *value,
+    int desired, int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    return __atomic_exchange_n( value, desired, order );
+#elif defined( _GLFW_HAS_INTERLOCKED )
+    return (int) InterlockedExchange( (volatile LONG *) value,
+                                      (LONG) desired );
+#else
+    int result;
+
+    LockAtomics();
+    result = *value;
+    *value = desired;
+    UnlockAtomics();
+
+    return result;
+#endif
+}
+
+
+//========================================================================
+// Atomically replace a 32-bit integer if it has the expected value
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwAtomicCompareExchange32( volatile int *value,
+    int *expected, int desired, int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    return __atomic_compare_exchange_n( value, expected, desired, 0, order,
+                                        _glfw_failure_order( order ) );
+#else
+    int result;
+
+ #if defined( _GLFW_HAS_INTERLOCKED )
+    result = (int) InterlockedCompareExchange( (volatile LONG *) value,
+                                               (LONG) desired,
+                                               (LONG) *expected );
+ #else
+    LockAtomics();
+    result = *value;
+    if( result == *expected )
+    {
+        *value = desired;
+    }
+    UnlockAtomics();
+ #endif
+
+    if( result == *expected )
+    {
+        return GL_TRUE;
+    }
+
+    *expected = result;
+    return GL_FALSE;
+#endif
+}
+
+
+//========================================================================
+// Atomically load a 64-bit integer
+//========================================================================
+
+GLFWAPI GLFWint64 GLFWAPIENTRY glfwAtomicLoad64(
+    const volatile GLFWint64 *value, int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    return __atomic_load_n( value, order );
+#else
+    GLFWint64 result;
+
+    LockAtomics();
+    result = *value;
+    UnlockAtomics();
+
+    return result;
+#endif
+}
+
+
+//========================================================================
+// Atomically store a 64-bit integer
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwAtomicStore64( volatile GLFWint64 *value,
+    GLFWint64 desired, int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    __atomic_store_n( value, desired, order );
+#else
+    LockAtomics();
+    *value = desired;
+    UnlockAtomics();
+#endif
+}
+
+
+//========================================================================
+// Atomically add to a 64-bit integer, returning the previous value
+//========================================================================
+
+GLFWAPI GLFWint64 GLFWAPIENTRY glfwAtomicAdd64( volatile GLFWint64 *value,
+    GLFWint64 delta, int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    return __atomic_fetch_add( value, delta, order );
+#else
+    GLFWint64 result;
+
+    LockAtomics();
+    result = *value;
+    *value = result + delta;
+    UnlockAtomics();
+
+    return result;
+#endif
+}
+
+
+//========================================================================
+// Atomically replace a 64-bit integer, returning the previous value
+//========================================================================
+
+GLFWAPI GLFWint64 GLFWAPIENTRY glfwAtomicExchange64(
+    volatile GLFWint64 *value, GLFWint64 desired, int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    return __atomic_exchange_n( value, desired, order );
+#else
+    GLFWint64 result;
+
+    LockAtomics();
+    result = *value;
+    *value = desired;
+    UnlockAtomics();
+
+    return result;
+#endif
+}
+
+
+//========================================================================
+// Atomically replace a 64-bit integer if it has the expected value
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwAtomicCompareExchange64(
+    volatile GLFWint64 *value, GLFWint64 *expected, GLFWint64 desired,
+    int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    return __atomic_compare_exchange_n( value, expected, desired, 0, order,
+                                        _glfw_failure_order( order ) );
+#else
+    GLFWint64 result;
+
+    LockAtomics();
+    result = *value;
+    if( result == *expected )
+    {
+        *value = desired;
+    }
+    UnlockAtomics();
+
+    if( result == *expected )
+    {
+        return GL_TRUE;
+    }
+
+    *expected = result;
+    return GL_FALSE;
+#endif
+}
+
+
+//========================================================================
+// Atomically load a pointer
+//========================================================================
+
+GLFWAPI void * GLFWAPIENTRY glfwAtomicLoadPtr( void * const volatile *value,
+    int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    return __atomic_load_n( value, order );
+#elif defined( _GLFW_HAS_INTERLOCKED )
+    return InterlockedCompareExchangePointer( (PVOID volatile *) value,
+                                              NULL, NULL );
+#else
+    void *result;
+
+    LockAtomics();
+    result = *value;
+    UnlockAtomics();
+
+    return result;
+#endif
+}
+
+
+//========================================================================
+// Atomically store a pointer
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwAtomicStorePtr( void * volatile *value,
+    void *desired, int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    __atomic_store_n( value, desired, order );
+#elif defined( _GLFW_HAS_INTERLOCKED )
+    InterlockedExchangePointer( (PVOID volatile *) value, desired );
+#else
+    LockAtomics();
+    *value = desired;
+    UnlockAtomics();
+#endif
+}
+
+
+//========================================================================
+// Atomically replace a pointer, returning the previous value
+//========================================================================
+
+GLFWAPI void * GLFWAPIENTRY glfwAtomicExchangePtr( void * volatile *value,
+    void *desired, int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    return __atomic_exchange_n( value, desired, order );
+#elif defined( _GLFW_HAS_INTERLOCKED )
+    return InterlockedExchangePointer( (PVOID volatile *) value, desired );
+#else
+    void *result;
+
+    LockAtomics();
+    result = *value;
+    *value = desired;
+    UnlockAtomics();
+
+    return result;
+#endif
+}
+
+
+//========================================================================
+// Atomically replace a pointer if it has the expected value
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwAtomicCompareExchangePtr( void * volatile *value,
+    void **expected, void *desired, int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    return __atomic_compare_exchange_n( value, expected, desired, 0, order,
+                                        _glfw_failure_order( order ) );
+#else
+    void *result;
+
+ #if defined( _GLFW_HAS_INTERLOCKED )
+    result = InterlockedCompareExchangePointer( (PVOID volatile *) value,
+                                                desired, *expected );
+ #else
+    LockAtomics();
+    result = *value;
+    if( result == *expected )
+    {
+        *value = desired;
+    }
+    UnlockAtomics();
+ #endif
+
+    if( result == *expected )
+    {
+        return GL_TRUE;
+    }
+
+    *expected = result;
+    return GL_FALSE;
+#endif
+}
+
+
+//========================================================================
+// Order the memory accesses of the calling thread
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwThreadFence( int order )
+{
+#if defined( _GLFW_HAS_ATOMIC_BUILTINS )
+    __atomic_thread_fence( order );
+#else
+    // Taking and releasing a lock is a full barrier
+    if( order != GLFW_ATOMIC_RELAXED )
+    {
+        LockAtomics();
+        UnlockAtomics();
+    }
+#endif
+}
@@ -0,0 +1,434 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+//========================================================================
+// Description:
+//
+// This module saves the framebuffer to image files without stalling the
+// render thread.
+//
+// With pixel buffer objects, each capture is read back into the next
+// buffer of a small ring, and only mapped when that buffer is reused a
+// couple of captures later, by which time the transfer has completed.
+// Without them, the framebuffer is read back immediately. Either way,
+// the pixels are then handed to a writer thread that encodes the file.
+//
+//========================================================================
+
+
+#include "internal.h"
+
+
+// Pixel formats and pixel buffer object enums that may be missing from
+// old OpenGL headers
+#ifndef GL_VERSION_1_2
+ #define GL_BGR               0x80E0
+ #define GL_BGRA              0x80E1
+#endif // GL_VERSION_1_2
+
+#ifndef GL_VERSION_1_5
+ #define GL_STREAM_READ       0x88E1
+ #define GL_READ_ONLY         0x88B8
+#endif // GL_VERSION_1_5
+
+#ifndef GL_VERSION_2_1
+ #define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif // GL_VERSION_2_1
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+//========================================================================
+// Free a capture job
+//========================================================================
+
+static void FreeCaptureJob( _GLFWcapturejob *job )
+{
+    _glfwFreePixels( job->image.Data );
+    _glfwFree( job->name );
+    _glfwFree( job );
+}
+
+
+//========================================================================
+// Hand a capture with pixels to the writer thread
+//========================================================================
+
+static void QueueCaptureJob( _GLFWcapturejob *job )
+{
+    glfwLockMutex( _glfwCapture.mutex );
+
+    job->next = NULL;
+    if( _glfwCapture.last )
+    {
+        _glfwCapture.last->next = job;
+    }
+    else
+    {
+        _glfwCapture.first = job;
+    }
+    _glfwCapture.last = job;
+
+    glfwBroadcastCond( _glfwCapture.cond );
+    glfwUnlockMutex( _glfwCapture.mutex );
+}
+
+
+//========================================================================
+// Write captures to disk (thread function)
+//========================================================================
+
+static void GLFWCALL WriterThread( void *arg )
+{
+    _GLFWcapturejob     *job;
+    const unsigned char *src;
+    unsigned char       *dst, *row, tmp;
+    int                 n, rowsize;
+
+    (void) arg;
+
+    glfwLockMutex( _glfwCapture.mutex );
+
+    for( ;; )
+    {
+        job = _glfwCapture.first;
+        if( job == NULL )
+        {
+            if( _glfwCapture.stop )
+            {
+                break;
+            }
+            glfwWaitCond( _glfwCapture.cond, _glfwCapture.mutex,
+                          GLFW_INFINITY );
+            continue;
+        }
+
+        _glfwCapture.first = job->next;
+        if( _glfwCapture.first == NULL )
+        {
+            _glfwCapture.last = NULL;
+        }
+        _glfwCapture.writing = GL_TRUE;
+        glfwUnlockMutex( _glfwCapture.mutex );
+
+        // Drop the (usually meaningless) framebuffer alpha
+        src = dst = job->image.Data;
+        for( n = job->image.Width * job->image.Height; n > 0; n -- )
+        {
+            dst[ 0 ] = src[ 0 ];
+            dst[ 1 ] = src[ 1 ];
+            dst[ 2 ] = src[ 2 ];
+            src += 4;
+            dst += 3;
+        }
+        job->image.Format        = GL_BGR;
+        job->image.BytesPerPixel = 3;
+
+        // The framebuffer is read bottom row first, which is also the
+        // natural TGA order, so rows are only flipped on request
+        if( job->flags & GLFW_ORIGIN_UL_BIT )
+        {
+            rowsize = job->image.Width * 3;
+            row = job->image.Data;
+            dst = job->image.Data + ( job->image.Height - 1 ) * rowsize;
+            while( row < dst )
+            {
+                for( n = 0; n < rowsize; n ++ )
+                {
+                    tmp      = row[ n ];
+                    row[ n ] = dst[ n ];
+                    dst[ n ] = tmp;
+                }
+                row += rowsize;
+                dst -= rowsize;
+            }
+        }
+
+        glfwWriteImage( job->name, &job->image, job->flags );
+        FreeCaptureJob( job );
+
+        glfwLockMutex( _glfwCapture.mutex );
+        _glfwCapture.writing = GL_FALSE;
+        glfwBroadcastCond( _glfwCapture.cond );
+    }
+
+    glfwUnlockMutex( _glfwCapture.mutex );
+}
+
+
+//========================================================================
+// Map a readback buffer and hand its capture to the writer thread
+//========================================================================
+
+static void MapCapture( int index )
+{
+    _GLFWcapturejob *job;
+    void            *ptr;
+    int             size;
+
+    job = _glfwCapture.pending[ index ];
+    if( job == NULL )
+    {
+        return;
+    }
+    _glfwCapture.pending[ index ] = NULL;
+
+    size = job->image.Width * job->image.Height * 4;
+    job->image.Data = (unsigned char *) _glfwAllocPixels( size );
+
+    _glfwWin.BindBuffer( GL_PIXEL_PACK_BUFFER,
+                         _glfwCapture.buffers[ index ] );
+    ptr = _glfwWin.MapBuffer( GL_PIXEL_PACK_BUFFER, GL_READ_ONLY );
+    if( ptr && job->image.Data )
+    {
+        memcpy( job->image.Data, ptr, size );
+    }
+    if( ptr )
+    {
+        _glfwWin.UnmapBuffer( GL_PIXEL_PACK_BUFFER );
+    }
+    _glfwWin.BindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+    if( ptr == NULL || job->image.Data == NULL )
+    {
+        FreeCaptureJob( job );
+        return;
+    }
+
+    QueueCaptureJob( job );
+}
+
+
+//========================================================================
+// Map all pending readback buffers, oldest first, and free the buffers
+// (called before the OpenGL context is destroyed)
+//========================================================================
+
+void _glfwFlushCaptures( void )
+{
+    int n, index;
+
+    if( _glfwCapture.buffers[ 0 ] == 0 )
+    {
+        return;
+    }
+
+    for( n = 0; n < _GLFW_CAPTURE_BUFFERS; n ++ )
+    {
+        index = ( _glfwCapture.next + n ) % _GLFW_CAPTURE_BUFFERS;
+        MapCapture( index );
+    }
+
+    _glfwWin.DeleteBuffers( _GLFW_CAPTURE_BUFFERS, _glfwCapture.buffers );
+    memset( _glfwCapture.buffers, 0, sizeof( _glfwCapture.buffers ) );
+    _glfwCapture.next = 0;
+}
+
+
+//========================================================================
+// Write all remaining captures and stop the writer thread
+//========================================================================
+
+void _glfwTerminateCapture( void )
+{
+    if( _glfwWin.opened )
+    {
+        _glfwFlushCaptures();
+    }
+
+    if( _glfwCapture.writer > 0 )
+    {
+        glfwLockMutex( _glfwCapture.mutex );
+        _glfwCapture.stop = GL_TRUE;
+        glfwSignalCond( _glfwCapture.cond );
+        glfwUnlockMutex( _glfwCapture.mutex );
+
+        glfwWaitThread( _glfwCapture.writer, GLFW_WAIT );
+    }
+
+    if( _glfwCapture.mutex )
+    {
+        glfwDestroyMutex( _glfwCapture.mutex );
+    }
+    if( _glfwCapture.cond )
+    {
+        glfwDestroyCond( _glfwCapture.cond );
+    }
+
+    memset( &_glfwCapture, 0, sizeof( _glfwCapture ) );
+}
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Save the contents of the current read buffer to an image file, without
+// waiting for the readback or the encoding to finish
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwCaptureFramebufferAsync( const char *name,
+    int flags )
+{
+    _GLFWcapturejob *job;
+    GLint           PackAlignment;
+    int             index;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwWin.opened )
+    {
+        return GL_FALSE;
+    }
+
+    // Start the writer thread on first use
+    if( _glfwCapture.writer == 0 )
+    {
+        if( !_glfwCapture.mutex )
+        {
+            _glfwCapture.mutex = glfwCreateMutex();
+            _glfwCapture.cond  = glfwCreateCond();
+        }
+        if( !_glfwCapture.mutex || !_glfwCapture.cond )
+        {
+            return GL_FALSE;
+        }
+
+        _glfwCapture.stop = GL_FALSE;
+        _glfwCapture.writer = glfwCreateThread( WriterThread, NULL );
+        if( _glfwCapture.writer < 0 )
+        {
+            _glfwCapture.writer = 0;
+            return GL_FALSE;
+        }
+    }
+
+    job = (_GLFWcapturejob *) _glfwCalloc( 1, sizeof( _GLFWcapturejob ) );
+    if( job == NULL )
+    {
+        return GL_FALSE;
+    }
+    job->name = (char *) _glfwMalloc( strlen( name ) + 1 );
+    if( job->name == NULL )
+    {
+        _glfwFree( job );
+        return GL_FALSE;
+    }
+    strcpy( job->name, name );
+    job->flags               = flags & ( GLFW_ORIGIN_UL_BIT |
+                                         GLFW_COMPRESS_BIT );
+    job->image.Width         = _glfwWin.width;
+    job->image.Height        = _glfwWin.height;
+    job->image.Format        = GL_BGRA;
+    job->image.BytesPerPixel = 4;
+
+    // BGRA rows are always four byte aligned, and are the native
+    // framebuffer layout on most hardware
+    glGetIntegerv( GL_PACK_ALIGNMENT, &PackAlignment );
+    glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+
+    if( _glfwWin.has_GL_ARB_pixel_buffer_object )
+    {
+        if( _glfwCapture.buffers[ 0 ] == 0 )
+        {
+            _glfwWin.GenBuffers( _GLFW_CAPTURE_BUFFERS,
+                                 _glfwCapture.buffers );
+        }
+
+        // The capture in the buffer being reused was issued long enough
+        // ago that mapping it does not stall
+        index = _glfwCapture.next;
+        MapCapture( index );
+        _glfwCapture.next = ( index + 1 ) % _GLFW_CAPTURE_BUFFERS;
+
+        _glfwWin.BindBuffer( GL_PIXEL_PACK_BUFFER,
+                             _glfwCapture.buffers[ index ] );
+        _glfwWin.BufferData( GL_PIXEL_PACK_BUFFER,
+                             job->image.Width * job->image.Height * 4,
+                             NULL, GL_STREAM_READ );
+        glReadPixels( 0, 0, job->image.Width, job->image.Height, GL_BGRA,
+                      GL_UNSIGNED_BYTE, NULL );
+        _glfwWin.BindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+
+        _glfwCapture.pending[ index ] = job;
+    }
+    else
+    {
+        job->image.Data = (unsigned char *)
+            _glfwAllocPixels( job->image.Width * job->image.Height * 4 );
+        if( job->image.Data == NULL )
+        {
+            glPixelStorei( GL_PACK_ALIGNMENT, PackAlignment );
+            FreeCaptureJob( job );
+            return GL_FALSE;
+        }
+
+        glReadPixels( 0, 0, job->image.Width, job->image.Height, GL_BGRA,
+                      GL_UNSIGNED_BYTE, job->image.Data );
+        QueueCaptureJob( job );
+    }
+
+    glPixelStorei( GL_PACK_ALIGNMENT, PackAlignment );
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Wait until all captures have been written
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwFinishCaptures( void )
+{
+    int n;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || _glfwCapture.writer == 0 )
+    {
+        return;
+    }
+
+    if( _glfwWin.opened )
+    {
+        for( n = 0; n < _GLFW_CAPTURE_BUFFERS; n ++ )
+        {
+            MapCapture( ( _glfwCapture.next + n ) % _GLFW_CAPTURE_BUFFERS );
+        }
+    }
+
+    glfwLockMutex( _glfwCapture.mutex );
+    while( _glfwCapture.first || _glfwCapture.writing )
+    {
+        glfwWaitCond( _glfwCapture.cond, _glfwCapture.mutex, GLFW_INFINITY );
+    }
+    glfwUnlockMutex( _glfwCapture.mutex );
+}
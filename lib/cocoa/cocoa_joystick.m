@@ -148,7 +148,9 @@ static void addJoystickElement( _glfwJoystick* joystick, CFTypeRef refElement )
             long number;
             CFTypeRef refType;
 
-            _glfwJoystickElement* element = (_glfwJoystickElement*) malloc( sizeof( _glfwJoystickElement ) );
+            _glfwJoystickElement* element = (_glfwJoystickElement*)
+                _glfwMallocAs( sizeof( _glfwJoystickElement ),
+                               GLFW_MEMORY_JOYSTICK );
 
             CFArrayAppendValue( elementsArray, element );
 
@@ -250,7 +252,7 @@ static void removeJoystick( _glfwJoystick* joystick )
         {
             _glfwJoystickElement* axes =
                 (_glfwJoystickElement*) CFArrayGetValueAtIndex( joystick->axes, i );
-            free( axes );
+            _glfwFree( axes );
         }
         CFArrayRemoveAllValues( joystick->axes );
         joystick->numAxes = 0;
@@ -259,7 +261,7 @@ static void removeJoystick( _glfwJoystick* joystick )
         {
             _glfwJoystickElement* button =
                 (_glfwJoystickElement*) CFArrayGetValueAtIndex( joystick->buttons, i );
-            free( button );
+            _glfwFree( button );
         }
         CFArrayRemoveAllValues( joystick->buttons );
         joystick->numButtons = 0;
@@ -268,7 +270,7 @@ static void removeJoystick( _glfwJoystick* joystick )
         {
             _glfwJoystickElement* hat =
                 (_glfwJoystickElement*) CFArrayGetValueAtIndex( joystick->hats, i );
-            free( hat );
+            _glfwFree( hat );
         }
         CFArrayRemoveAllValues( joystick->hats );
         joystick->hats = 0;
@@ -30,13 +30,54 @@
 #include "internal.h"
 
 #include <sys/time.h>
+#include <unistd.h>
+#include <limits.h>
 #include <sys/sysctl.h>
+#include <libkern/OSAtomic.h>
+#include <errno.h>
 
 
 //************************************************************************
 //****                  GLFW internal functions                       ****
 //************************************************************************
 
+//========================================================================
+// Set the scheduling policy and priority of a thread
+//========================================================================
+
+static void SetThreadSchedule( pthread_t thread, int policy, int priority )
+{
+    struct sched_param param;
+    int                sched, low, high;
+
+    switch( policy )
+    {
+        case GLFW_SCHED_FIFO:
+            sched = SCHED_FIFO;
+            break;
+        case GLFW_SCHED_RR:
+            sched = SCHED_RR;
+            break;
+        default:
+            sched = SCHED_OTHER;
+            break;
+    }
+
+    // Spread the GLFW priorities evenly over the range of the policy
+    low  = sched_get_priority_min( sched );
+    high = sched_get_priority_max( sched );
+    if( low == -1 || high == -1 )
+    {
+        return;
+    }
+    param.sched_priority = low + ( high - low ) *
+        ( priority - GLFW_PRIORITY_LOWEST ) /
+        ( GLFW_PRIORITY_HIGHEST - GLFW_PRIORITY_LOWEST );
+
+    (void) pthread_setschedparam( thread, sched, &param );
+}
+
+
 //========================================================================
 // _glfwNewThread() - This is simply a "wrapper" for calling the user
 // thread function.
@@ -78,21 +119,48 @@ void * _glfwNewThread( void * arg )
 // _glfwPlatformCreateThread() - Create a new thread
 //========================================================================
 
-GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg )
+GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg,
+                                      const GLFWthreadattr *attr )
 {
-    GLFWthread  ID;
-    _GLFWthread *t;
-    int         result;
+    GLFWthread     ID;
+    _GLFWthread    *t;
+    pthread_attr_t pattr;
+    size_t         stacksize, pagesize;
+    int            result;
+
+    // Set up the attributes that must be given at creation
+    if( pthread_attr_init( &pattr ) != 0 )
+    {
+        return -1;
+    }
+    if( attr != NULL && attr->StackSize > 0 )
+    {
+        // Round up to whole pages and the system minimum
+        pagesize = (size_t) sysconf( _SC_PAGESIZE );
+        stacksize = ( (size_t) attr->StackSize + pagesize - 1 ) &
+                    ~( pagesize - 1 );
+        if( stacksize < PTHREAD_STACK_MIN )
+        {
+            stacksize = PTHREAD_STACK_MIN;
+        }
+        if( pthread_attr_setstacksize( &pattr, stacksize ) != 0 )
+        {
+            pthread_attr_destroy( &pattr );
+            return -1;
+        }
+    }
 
     // Enter critical section
     ENTER_THREAD_CRITICAL_SECTION
 
     // Create a new thread information memory area
-    t = (_GLFWthread *) malloc( sizeof(_GLFWthread) );
+    t = (_GLFWthread *) _glfwMallocAs( sizeof(_GLFWthread),
+                                       GLFW_MEMORY_THREAD );
     if( t == NULL )
     {
         // Leave critical section
         LEAVE_THREAD_CRITICAL_SECTION
+        pthread_attr_destroy( &pattr );
         return -1;
     }
 
@@ -106,19 +174,28 @@ GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg )
     // Create thread
     result = pthread_create(
                             &t->PosixID,      // Thread handle
-                            NULL,             // Default thread attributes
+                            &pattr,           // Thread attributes
                             _glfwNewThread,   // Thread function (a wrapper function)
                             (void *)arg       // Argument to thread is user argument
                             );
 
+    pthread_attr_destroy( &pattr );
+
     // Did the thread creation fail?
     if( result != 0 )
     {
-        free( (void *) t );
+        _glfwFree( (void *) t );
         LEAVE_THREAD_CRITICAL_SECTION
         return -1;
     }
 
+    // Processor affinity and thread names can not be set from here
+    if( attr != NULL && ( attr->Policy != GLFW_SCHED_NORMAL ||
+                          attr->Priority != GLFW_PRIORITY_NORMAL ) )
+    {
+        SetThreadSchedule( t->PosixID, attr->Policy, attr->Priority );
+    }
+
     // Append thread to thread list
     _glfwAppendThread( t );
 
@@ -162,6 +239,17 @@ void _glfwPlatformDestroyThread( GLFWthread ID )
 }
 
 
+//========================================================================
+// _glfwPlatformSetThreadAffinity() - Restrict a thread to a set of
+// processors. Mac OS X does not support this
+//========================================================================
+
+int _glfwPlatformSetThreadAffinity( GLFWthread ID, const GLFWcpumask *mask )
+{
+    return GL_FALSE;
+}
+
+
 //========================================================================
 // _glfwPlatformWaitThread() - Wait for a thread to die
 //========================================================================
@@ -249,7 +337,8 @@ GLFWmutex _glfwPlatformCreateMutex( void )
     pthread_mutex_t *mutex;
 
     // Allocate memory for mutex
-    mutex = (pthread_mutex_t *) malloc( sizeof( pthread_mutex_t ) );
+    mutex = (pthread_mutex_t *) _glfwMallocAs( sizeof( pthread_mutex_t ),
+                                               GLFW_MEMORY_SYNC );
     if( !mutex )
     {
         return NULL;
@@ -273,7 +362,7 @@ void _glfwPlatformDestroyMutex( GLFWmutex mutex )
     pthread_mutex_destroy( (pthread_mutex_t *) mutex );
 
     // Free memory for mutex object
-    free( (void *) mutex );
+    _glfwFree( (void *) mutex );
 }
 
 
@@ -308,7 +397,8 @@ GLFWcond _glfwPlatformCreateCond( void )
     pthread_cond_t *cond;
 
     // Allocate memory for condition variable
-    cond = (pthread_cond_t *) malloc( sizeof(pthread_cond_t) );
+    cond = (pthread_cond_t *) _glfwMallocAs( sizeof(pthread_cond_t),
+                                             GLFW_MEMORY_SYNC );
     if( !cond )
     {
         return NULL;
@@ -332,7 +422,7 @@ void _glfwPlatformDestroyCond( GLFWcond cond )
     (void) pthread_cond_destroy( (pthread_cond_t *) cond );
 
     // Free memory for condition variable object
-    free( (void *) cond );
+    _glfwFree( (void *) cond );
 }
 
 
@@ -340,8 +430,8 @@ void _glfwPlatformDestroyCond( GLFWcond cond )
 // _glfwPlatformWaitCond() - Wait for a condition to be raised
 //========================================================================
 
-void _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex,
-                            double timeout )
+int _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex,
+                           double timeout )
 {
     struct timeval  currenttime;
     struct timespec wait;
@@ -353,6 +443,7 @@ void _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex,
         // Wait for condition (infinite wait)
         (void) pthread_cond_wait( (pthread_cond_t *) cond,
                                   (pthread_mutex_t *) mutex );
+        return GL_TRUE;
     }
     else
     {
@@ -361,7 +452,7 @@ void _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex,
         dt_sec  = (long) timeout;
         dt_usec = (long) ((timeout - (double)dt_sec) * 1000000.0);
         wait.tv_nsec = (currenttime.tv_usec + dt_usec) * 1000L;
-        if( wait.tv_nsec > 1000000000L )
+        if( wait.tv_nsec >= 1000000000L )
         {
             wait.tv_nsec -= 1000000000L;
             dt_sec ++;
@@ -369,8 +460,9 @@ void _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex,
         wait.tv_sec  = currenttime.tv_sec + dt_sec;
 
         // Wait for condition (timed wait)
-        (void) pthread_cond_timedwait( (pthread_cond_t *) cond,
-                                       (pthread_mutex_t *) mutex, &wait );
+        return pthread_cond_timedwait( (pthread_cond_t *) cond,
+                                       (pthread_mutex_t *) mutex,
+                                       &wait ) != ETIMEDOUT;
     }
 }
 
@@ -412,3 +504,57 @@ int _glfwPlatformGetNumberOfProcessors( void )
     return n;
 }
 
+
+//========================================================================
+// _glfwPlatformGetProcessorTopology() - Describe the processors of the
+// system. Mac OS X does not tell how they are grouped, so the topology
+// is guessed instead
+//========================================================================
+
+int _glfwPlatformGetProcessorTopology( GLFWtopology *topology )
+{
+    return GL_FALSE;
+}
+
+
+//========================================================================
+// Atomically add to a value, returning the new value
+//========================================================================
+
+long _glfwPlatformAtomicAdd( volatile long *value, long delta )
+{
+    long old;
+
+    do
+    {
+        old = *value;
+    }
+    while( !OSAtomicCompareAndSwapLongBarrier( old, old + delta, value ) );
+
+    return old + delta;
+}
+
+
+//========================================================================
+// Atomically replace a value if it equals the expected one, returning the
+// previous value
+//========================================================================
+
+long _glfwPlatformAtomicCompareSwap( volatile long *value, long expected,
+                                     long desired )
+{
+    long old;
+
+    do
+    {
+        old = *value;
+        if( old != expected )
+        {
+            return old;
+        }
+    }
+    while( !OSAtomicCompareAndSwapLongBarrier( expected, desired, value ) );
+
+    return expected;
+}
+
@@ -0,0 +1,645 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+//========================================================================
+// Description:
+//
+// This module implements a persistent cache of processed textures. When
+// a cache directory has been set with glfwSetTextureCacheDir, the
+// texture loading functions first look for an entry keyed by the content
+// hash of the source file, the load flags and the GLFW version. On a hit,
+// the stored mipmap chain is uploaded as it is, skipping decoding,
+// rescaling and mipmap generation. On a miss, the texture is processed as
+// usual and then read back from OpenGL and stored.
+//
+// Since entries are keyed by content, a changed source file simply maps
+// to a new entry. Textures compressed by the driver (GLFW_COMPRESS_BIT)
+// are stored in their compressed form.
+//
+//========================================================================
+
+
+#include "internal.h"
+
+
+// Texture parameters that may be missing from old OpenGL headers
+#ifndef GL_VERSION_1_3
+ #define GL_TEXTURE_COMPRESSED_IMAGE_SIZE 0x86A0
+ #define GL_TEXTURE_COMPRESSED            0x86A1
+#endif // GL_VERSION_1_3
+
+// S3TC compressed internal formats
+#ifndef GL_EXT_texture_compression_s3tc
+ #define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+ #define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+ #define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+ #define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif // GL_EXT_texture_compression_s3tc
+
+#ifndef GL_VERSION_1_2
+ #define GL_UNSIGNED_SHORT_4_4_4_4      0x8033
+ #define GL_UNSIGNED_SHORT_5_5_5_1      0x8034
+ #define GL_UNSIGNED_SHORT_5_6_5        0x8363
+#endif // GL_VERSION_1_2
+
+// Maximum number of mipmap levels in a cache entry
+#define _GLFW_MAX_CACHE_LEVELS 32
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+//========================================================================
+// Cache entry header (entries are only read by the machine that wrote
+// them, so the byte order marker merely guards against shared caches)
+//========================================================================
+
+typedef struct {
+    char         magic[ 8 ];
+    int          byteOrder;
+    int          version[ 3 ];
+    unsigned int hash[ 2 ];
+    int          size;
+    int          flags;
+    int          levels;
+    int          compressed;
+    int          internalformat;
+    int          format;
+    int          type;
+} _GLFWcacheheader;
+
+static const char CacheMagic[ 8 ] = { 'G','L','F','W','T','E','X', 0 };
+
+
+//========================================================================
+// Cache entry mipmap level header
+//========================================================================
+
+typedef struct {
+    int width, height;
+    int bytes;
+} _GLFWcachelevel;
+
+
+//========================================================================
+// Fill in the header that identifies the cache entry of a source image
+//========================================================================
+
+static void InitCacheHeader( _GLFWcacheheader *header, const void *data,
+    long size, int flags )
+{
+    memset( header, 0, sizeof( _GLFWcacheheader ) );
+    memcpy( header->magic, CacheMagic, sizeof( CacheMagic ) );
+    header->byteOrder    = 0x01020304;
+    header->version[ 0 ] = GLFW_VERSION_MAJOR;
+    header->version[ 1 ] = GLFW_VERSION_MINOR;
+    header->version[ 2 ] = GLFW_VERSION_REVISION;
+    _glfwHashData( data, size, header->hash );
+    header->size  = (int) size;
+    header->flags = flags;
+}
+
+
+//========================================================================
+// Build the path of the cache entry file of a source image, with a suffix
+// appended to the file name
+//========================================================================
+
+static char *GetCacheEntryPath( const _GLFWcacheheader *header,
+    const char *suffix )
+{
+    char *path;
+
+    path = (char *) _glfwMalloc( strlen( _glfwTexCache.diskPath ) +
+                                 strlen( suffix ) + 32 );
+    if( path == NULL )
+    {
+        return NULL;
+    }
+
+    sprintf( path, "%s/%08x%08x%04x.glt%s", _glfwTexCache.diskPath,
+             header->hash[ 0 ], header->hash[ 1 ], header->flags & 0xffff,
+             suffix );
+
+    return path;
+}
+
+
+//========================================================================
+// Open the cache entry file of a source image
+//========================================================================
+
+static FILE *OpenCacheEntry( const _GLFWcacheheader *header,
+    const char *mode )
+{
+    char *path;
+    FILE *file;
+
+    path = GetCacheEntryPath( header, "" );
+    if( path == NULL )
+    {
+        return NULL;
+    }
+
+    file = fopen( path, mode );
+    _glfwFree( path );
+
+    return file;
+}
+
+
+//========================================================================
+// Find the size of a 4x4 block of a compressed internal format, or return
+// zero if it is not one that GLFW creates
+//========================================================================
+
+static int GetBlockSize( GLint internalformat )
+{
+    switch( internalformat )
+    {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+            return 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+
+//========================================================================
+// Find the pixel transfer format, type and pixel size used to read back a
+// texture of a given internal format, or return GL_FALSE if it can not
+// be cached
+//========================================================================
+
+static int GetReadbackFormat( GLint internalformat, GLenum *format,
+    GLenum *type, int *bpp )
+{
+    *type = GL_UNSIGNED_BYTE;
+
+    switch( internalformat )
+    {
+        case GL_LUMINANCE:
+        case GL_LUMINANCE8:
+            *format = GL_LUMINANCE;
+            *bpp = 1;
+            return GL_TRUE;
+        case GL_ALPHA:
+        case GL_ALPHA8:
+            *format = GL_ALPHA;
+            *bpp = 1;
+            return GL_TRUE;
+        case GL_LUMINANCE_ALPHA:
+        case GL_LUMINANCE8_ALPHA8:
+            *format = GL_LUMINANCE_ALPHA;
+            *bpp = 2;
+            return GL_TRUE;
+        case GL_RGB:
+        case GL_RGB8:
+            *format = GL_RGB;
+            *bpp = 3;
+            return GL_TRUE;
+        case GL_RGBA:
+        case GL_RGBA8:
+            *format = GL_RGBA;
+            *bpp = 4;
+            return GL_TRUE;
+        case GL_RGB5:
+            *format = GL_RGB;
+            *type = GL_UNSIGNED_SHORT_5_6_5;
+            *bpp = 2;
+            return GL_TRUE;
+        case GL_RGBA4:
+            *format = GL_RGBA;
+            *type = GL_UNSIGNED_SHORT_4_4_4_4;
+            *bpp = 2;
+            return GL_TRUE;
+        case GL_RGB5_A1:
+            *format = GL_RGBA;
+            *type = GL_UNSIGNED_SHORT_5_5_5_1;
+            *bpp = 2;
+            return GL_TRUE;
+        default:
+            return GL_FALSE;
+    }
+}
+
+
+//========================================================================
+// Check that a level record of a cache entry has the size that halving
+// the level above gives, and that its pixel data has the matching size
+//========================================================================
+
+static int CheckCacheLevel( const _GLFWcachelevel *level,
+    const _GLFWcachelevel *above, int bpp, int blocksize )
+{
+    double bytes;
+
+    if( level->width < 1 || level->height < 1 )
+    {
+        return GL_FALSE;
+    }
+
+    if( above != NULL &&
+        ( level->width != ( above->width > 1 ? above->width >> 1 : 1 ) ||
+          level->height != ( above->height > 1 ? above->height >> 1 : 1 ) ) )
+    {
+        return GL_FALSE;
+    }
+
+    // Computed in floating point, as corrupt sizes may overflow an int
+    if( blocksize )
+    {
+        bytes = (double) ( ( level->width + 3 ) / 4 ) *
+                (double) ( ( level->height + 3 ) / 4 ) * blocksize;
+    }
+    else
+    {
+        bytes = (double) level->width * (double) level->height * bpp;
+    }
+
+    return (double) level->bytes == bytes;
+}
+
+
+//========================================================================
+// Read a whole file, and upload it as a texture through the disk cache
+//========================================================================
+
+int _glfwLoadFileTexture( const char *name, int flags )
+{
+    _GLFWstream stream;
+    void *data;
+    long size;
+    int success;
+
+    if( !_glfwOpenFileStream( &stream, name, "rb" ) )
+    {
+        return GL_FALSE;
+    }
+
+    // Find the file size
+    if( !_glfwSeekStream( &stream, 0, SEEK_END ) ||
+        ( size = _glfwTellStream( &stream ) ) <= 0 ||
+        !_glfwSeekStream( &stream, 0, SEEK_SET ) )
+    {
+        _glfwCloseStream( &stream );
+        return GL_FALSE;
+    }
+
+    data = _glfwMalloc( size );
+    if( data == NULL )
+    {
+        _glfwCloseStream( &stream );
+        return GL_FALSE;
+    }
+
+    if( _glfwReadStream( &stream, data, size ) != size )
+    {
+        _glfwFree( data );
+        _glfwCloseStream( &stream );
+        return GL_FALSE;
+    }
+
+    _glfwCloseStream( &stream );
+
+    success = glfwLoadMemoryTexture2D( data, size, flags );
+
+    _glfwFree( data );
+
+    return success;
+}
+
+
+//========================================================================
+// Upload a texture from its disk cache entry, if there is a valid one
+//========================================================================
+
+int _glfwLoadDiskCachedTexture( const void *data, long size, int flags )
+{
+    _GLFWcacheheader wanted, header;
+    _GLFWcachelevel  level, above;
+    GLint  UnpackAlignment;
+    GLenum format, type;
+    FILE   *file;
+    void   *pixels;
+    int    n, bpp, blocksize, success;
+
+    InitCacheHeader( &wanted, data, size, flags );
+
+    file = OpenCacheEntry( &wanted, "rb" );
+    if( file == NULL )
+    {
+        return GL_FALSE;
+    }
+
+    // Does the entry belong to this source image and GLFW version?
+    if( fread( &header, sizeof( header ), 1, file ) != 1 ||
+        memcmp( &header, &wanted,
+                (char *) &header.levels - (char *) &header ) != 0 ||
+        header.levels < 1 || header.levels > _GLFW_MAX_CACHE_LEVELS ||
+        ( header.compressed &&
+          !_glfwWin.has_GL_EXT_texture_compression_s3tc ) )
+    {
+        fclose( file );
+        return GL_FALSE;
+    }
+
+    // The pixel size or block size of the levels follows from the formats
+    bpp = blocksize = 0;
+    if( header.compressed )
+    {
+        blocksize = GetBlockSize( header.internalformat );
+        success = blocksize != 0;
+    }
+    else
+    {
+        success = GetReadbackFormat( header.internalformat, &format, &type,
+                                     &bpp ) &&
+                  (GLenum) header.format == format &&
+                  (GLenum) header.type == type;
+    }
+    if( !success )
+    {
+        fclose( file );
+        return GL_FALSE;
+    }
+
+    // Set unpack alignment to one byte
+    glGetIntegerv( GL_UNPACK_ALIGNMENT, &UnpackAlignment );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+    success = GL_TRUE;
+    pixels  = NULL;
+    for( n = 0; n < header.levels && success; n ++ )
+    {
+        success = fread( &level, sizeof( level ), 1, file ) == 1 &&
+                  CheckCacheLevel( &level, n > 0 ? &above : NULL, bpp,
+                                   blocksize ) &&
+                  ( pixels = _glfwAllocPixels( level.bytes ) ) != NULL &&
+                  fread( pixels, level.bytes, 1, file ) == 1;
+
+        if( success )
+        {
+            if( header.compressed )
+            {
+                _glfwWin.CompressedTexImage2D( GL_TEXTURE_2D, n,
+                    header.internalformat, level.width, level.height, 0,
+                    level.bytes, pixels );
+            }
+            else
+            {
+                glTexImage2D( GL_TEXTURE_2D, n, header.internalformat,
+                    level.width, level.height, 0, header.format,
+                    header.type, pixels );
+            }
+        }
+
+        if( pixels )
+        {
+            _glfwFreePixels( pixels );
+            pixels = NULL;
+        }
+
+        above = level;
+    }
+
+    // Restore old unpack alignment
+    glPixelStorei( GL_UNPACK_ALIGNMENT, UnpackAlignment );
+
+    fclose( file );
+
+    return success;
+}
+
+
+//========================================================================
+// Read back the bound texture, and store it as the disk cache entry of
+// its source image
+//========================================================================
+
+void _glfwStoreDiskCachedTexture( const void *data, long size, int flags )
+{
+    _GLFWcacheheader header;
+    _GLFWcachelevel  levels[ _GLFW_MAX_CACHE_LEVELS ];
+    GLint  PackAlignment, internalformat, compressed, width, height, bytes;
+    GLenum format, type;
+    FILE   *file;
+    void   *pixels;
+    char   suffix[ 32 ], *path, *temppath;
+    int    n, count, bpp, success;
+
+    InitCacheHeader( &header, data, size, flags );
+
+    glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT,
+                              &internalformat );
+
+    compressed = GL_FALSE;
+    if( _glfwWin.has_GL_EXT_texture_compression_s3tc )
+    {
+        glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED,
+                                  &compressed );
+    }
+
+    format = type = 0;
+    bpp = 0;
+    if( compressed ? !GetBlockSize( internalformat ) :
+        !GetReadbackFormat( internalformat, &format, &type, &bpp ) )
+    {
+        return;
+    }
+
+    // Find the size of every level
+    count = 0;
+    do
+    {
+        glGetTexLevelParameteriv( GL_TEXTURE_2D, count, GL_TEXTURE_WIDTH,
+                                  &width );
+        glGetTexLevelParameteriv( GL_TEXTURE_2D, count, GL_TEXTURE_HEIGHT,
+                                  &height );
+        if( width < 1 || height < 1 )
+        {
+            break;
+        }
+
+        if( compressed )
+        {
+            glGetTexLevelParameteriv( GL_TEXTURE_2D, count,
+                GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &bytes );
+        }
+        else
+        {
+            bytes = width * height * bpp;
+        }
+
+        levels[ count ].width  = width;
+        levels[ count ].height = height;
+        levels[ count ].bytes  = bytes;
+
+        // Entries that would not pass the checks on loading are useless
+        if( !CheckCacheLevel( &levels[ count ],
+                              count > 0 ? &levels[ count - 1 ] : NULL, bpp,
+                              compressed ? GetBlockSize( internalformat ) :
+                                           0 ) )
+        {
+            return;
+        }
+
+        count ++;
+    }
+    while( ( flags & GLFW_BUILD_MIPMAPS_BIT ) &&
+           ( width > 1 || height > 1 ) && count < _GLFW_MAX_CACHE_LEVELS );
+
+    if( count == 0 )
+    {
+        return;
+    }
+
+    header.levels         = count;
+    header.compressed     = compressed ? GL_TRUE : GL_FALSE;
+    header.internalformat = internalformat;
+    header.format         = format;
+    header.type           = type;
+
+    // The entry is written to a file of its own and then renamed, so that
+    // other readers and writers never see a partial entry. The stack
+    // address and time only serve to tell concurrent writers apart
+    sprintf( suffix, ".%08x%08x", (unsigned int) (size_t) &header,
+             (unsigned int) ( glfwGetTime() * 1000000.0 ) );
+    path     = GetCacheEntryPath( &header, "" );
+    temppath = GetCacheEntryPath( &header, suffix );
+    file     = temppath ? fopen( temppath, "wb" ) : NULL;
+    if( path == NULL || file == NULL )
+    {
+        if( file )
+        {
+            fclose( file );
+            remove( temppath );
+        }
+        _glfwFree( path );
+        _glfwFree( temppath );
+        return;
+    }
+
+    // Set pack alignment to one byte
+    glGetIntegerv( GL_PACK_ALIGNMENT, &PackAlignment );
+    glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+
+    success = fwrite( &header, sizeof( header ), 1, file ) == 1;
+    for( n = 0; n < count && success; n ++ )
+    {
+        pixels = _glfwAllocPixels( levels[ n ].bytes );
+        if( pixels == NULL )
+        {
+            success = GL_FALSE;
+            break;
+        }
+
+        if( compressed )
+        {
+            _glfwWin.GetCompressedTexImage( GL_TEXTURE_2D, n, pixels );
+        }
+        else
+        {
+            glGetTexImage( GL_TEXTURE_2D, n, format, type, pixels );
+        }
+
+        success = fwrite( &levels[ n ], sizeof( levels[ n ] ), 1, file ) == 1 &&
+                  fwrite( pixels, levels[ n ].bytes, 1, file ) == 1;
+
+        _glfwFreePixels( pixels );
+    }
+
+    // Restore old pack alignment
+    glPixelStorei( GL_PACK_ALIGNMENT, PackAlignment );
+
+    if( fclose( file ) != 0 )
+    {
+        success = GL_FALSE;
+    }
+
+    // Incomplete entries are never moved into place. Renaming onto an
+    // existing file fails on some systems, so remove it and try again
+    if( success && rename( temppath, path ) != 0 )
+    {
+        remove( path );
+        success = rename( temppath, path ) == 0;
+    }
+    if( !success )
+    {
+        remove( temppath );
+    }
+
+    _glfwFree( path );
+    _glfwFree( temppath );
+}
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Set the directory of the persistent texture cache (NULL disables it)
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwSetTextureCacheDir( const char *path )
+{
+    char *copy;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return GL_FALSE;
+    }
+
+    copy = NULL;
+    if( path != NULL )
+    {
+        copy = (char *) _glfwMalloc( strlen( path ) + 1 );
+        if( copy == NULL )
+        {
+            return GL_FALSE;
+        }
+        strcpy( copy, path );
+    }
+
+    if( _glfwTexCache.diskPath )
+    {
+        _glfwFree( _glfwTexCache.diskPath );
+    }
+    _glfwTexCache.diskPath = copy;
+
+    return GL_TRUE;
+}
@@ -0,0 +1,376 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+//========================================================================
+// Description:
+//
+// This module turns a high resolution alpha map into a smaller signed
+// distance field, where 128 is the shape edge and values above it are
+// inside the shape.
+//
+// The exact Euclidean distance transform of Felzenszwalb and Huttenlocher
+// is used, which takes linear time: a one-dimensional transform is run
+// on every column and then on every row. Both passes are split into
+// bands of lines that are transformed in parallel.
+//
+//========================================================================
+
+
+#include "internal.h"
+
+#include <math.h>
+
+
+// Distance used for pixels without a feature
+#define _GLFW_SDF_INF 1e20f
+
+// Maximum number of threads used to transform lines
+#define _GLFW_MAX_SDF_THREADS 8
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+//========================================================================
+// Band of lines transformed by one thread
+//========================================================================
+
+typedef struct {
+    float *grids[ 2 ];          // Squared distances to inside and outside
+    int   width, height;
+    int   rows;                 // Transform rows instead of columns
+    int   first, last;          // Lines of the band
+    int   failed;               // Scratch memory could not be allocated
+} _GLFWdistband;
+
+
+//========================================================================
+// One-dimensional squared distance transform of a sampled function
+//========================================================================
+
+static void Transform1D( const float *f, float *d, int *v, float *z, int n )
+{
+    float s;
+    int   k, q;
+
+    // Find the lower envelope of the parabolas rooted at each sample
+    k = 0;
+    v[ 0 ] = 0;
+    z[ 0 ] = -_GLFW_SDF_INF;
+    z[ 1 ] = _GLFW_SDF_INF;
+    for( q = 1; q < n; q ++ )
+    {
+        // The sentinel at z[ 0 ] ends this loop, as no intersection is
+        // anywhere near that far away
+        for( ;; )
+        {
+            s = ( ( f[ q ] + (float) ( q * q ) ) -
+                  ( f[ v[ k ] ] + (float) ( v[ k ] * v[ k ] ) ) ) /
+                (float) ( 2 * q - 2 * v[ k ] );
+            if( s > z[ k ] )
+            {
+                break;
+            }
+            k --;
+        }
+        k ++;
+        v[ k ] = q;
+        z[ k ] = s;
+        z[ k + 1 ] = _GLFW_SDF_INF;
+    }
+
+    // Evaluate the envelope
+    k = 0;
+    for( q = 0; q < n; q ++ )
+    {
+        while( z[ k + 1 ] < (float) q )
+        {
+            k ++;
+        }
+        d[ q ] = (float) ( ( q - v[ k ] ) * ( q - v[ k ] ) ) + f[ v[ k ] ];
+    }
+}
+
+
+//========================================================================
+// Transform a band of lines (thread function)
+//========================================================================
+
+static void GLFWCALL TransformBand( void *arg )
+{
+    _GLFWdistband *band = (_GLFWdistband *) arg;
+    float         *f, *d, *z, *line;
+    int           *v;
+    int           n, stride, count, size, i, k;
+
+    if( band->rows )
+    {
+        count  = band->width;
+        stride = 1;
+    }
+    else
+    {
+        count  = band->height;
+        stride = band->width;
+    }
+
+    size = band->width > band->height ? band->width : band->height;
+    f = (float *) _glfwMalloc( ( 3 * size + 1 ) * sizeof( float ) );
+    v = (int *) _glfwMalloc( size * sizeof( int ) );
+    if( f == NULL || v == NULL )
+    {
+        _glfwFree( f );
+        _glfwFree( v );
+        band->failed = GL_TRUE;
+        return;
+    }
+    d = f + size;
+    z = d + size;
+
+    for( n = band->first; n < band->last; n ++ )
+    {
+        for( k = 0; k < 2; k ++ )
+        {
+            if( band->rows )
+            {
+                line = band->grids[ k ] + n * band->width;
+            }
+            else
+            {
+                line = band->grids[ k ] + n;
+            }
+
+            for( i = 0; i < count; i ++ )
+            {
+                f[ i ] = line[ i * stride ];
+            }
+            Transform1D( f, d, v, z, count );
+            for( i = 0; i < count; i ++ )
+            {
+                line[ i * stride ] = d[ i ];
+            }
+        }
+    }
+
+    _glfwFree( f );
+    _glfwFree( v );
+}
+
+
+//========================================================================
+// Transform all columns or all rows, in parallel bands
+//========================================================================
+
+static int TransformLines( float **grids, int width, int height,
+    int rows )
+{
+    _GLFWdistband bands[ _GLFW_MAX_SDF_THREADS ];
+    GLFWthread    threads[ _GLFW_MAX_SDF_THREADS ];
+    int           n, lines, bandcount;
+
+    lines = rows ? height : width;
+
+    bandcount = glfwGetNumberOfProcessors();
+    if( bandcount > _GLFW_MAX_SDF_THREADS )
+    {
+        bandcount = _GLFW_MAX_SDF_THREADS;
+    }
+    if( bandcount > lines )
+    {
+        bandcount = lines;
+    }
+    if( bandcount < 1 )
+    {
+        bandcount = 1;
+    }
+
+    for( n = 0; n < bandcount; n ++ )
+    {
+        bands[ n ].grids[ 0 ] = grids[ 0 ];
+        bands[ n ].grids[ 1 ] = grids[ 1 ];
+        bands[ n ].width      = width;
+        bands[ n ].height     = height;
+        bands[ n ].rows       = rows;
+        bands[ n ].first      = lines * n / bandcount;
+        bands[ n ].last       = lines * ( n + 1 ) / bandcount;
+        bands[ n ].failed     = GL_FALSE;
+    }
+
+    // The calling thread transforms the first band, and also any band
+    // that could not get a thread of its own
+    for( n = 1; n < bandcount; n ++ )
+    {
+        threads[ n ] = glfwCreateThread( TransformBand, &bands[ n ] );
+        if( threads[ n ] < 0 )
+        {
+            TransformBand( &bands[ n ] );
+        }
+    }
+
+    TransformBand( &bands[ 0 ] );
+
+    for( n = 1; n < bandcount; n ++ )
+    {
+        if( threads[ n ] >= 0 )
+        {
+            glfwWaitThread( threads[ n ], GLFW_WAIT );
+        }
+    }
+
+    for( n = 0; n < bandcount; n ++ )
+    {
+        if( bands[ n ].failed )
+        {
+            return GL_FALSE;
+        }
+    }
+
+    return GL_TRUE;
+}
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Replace an alpha map with a signed distance field, downscaled by an
+// integer factor. Spread is the distance, in source pixels, that maps to
+// the full range of the result
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwGenerateDistanceField( GLFWimage *alpha,
+    int spread, int downscale )
+{
+    float         *grids[ 2 ], sum, dist, scale;
+    unsigned char *src, *dst, *pixels;
+    int           width, height, x, y, m, n, count, i;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return GL_FALSE;
+    }
+
+    if( alpha->BytesPerPixel != 1 || alpha->Data == NULL ||
+        spread < 1 || downscale < 1 )
+    {
+        return GL_FALSE;
+    }
+
+    width  = ( alpha->Width + downscale - 1 ) / downscale;
+    height = ( alpha->Height + downscale - 1 ) / downscale;
+
+    grids[ 0 ] = (float *) _glfwAllocPixels( alpha->Width * alpha->Height *
+                                             sizeof( float ) );
+    grids[ 1 ] = (float *) _glfwAllocPixels( alpha->Width * alpha->Height *
+                                             sizeof( float ) );
+    pixels = (unsigned char *) _glfwAllocPixels( width * height );
+    if( grids[ 0 ] == NULL || grids[ 1 ] == NULL || pixels == NULL )
+    {
+        _glfwFreePixels( grids[ 0 ] );
+        _glfwFreePixels( grids[ 1 ] );
+        _glfwFreePixels( pixels );
+        return GL_FALSE;
+    }
+
+    // Pixels at least half opaque are inside the shape. The first grid
+    // gets the squared distance to the inside, the second to the outside
+    src = alpha->Data;
+    for( i = 0; i < alpha->Width * alpha->Height; i ++ )
+    {
+        if( src[ i ] >= 128 )
+        {
+            grids[ 0 ][ i ] = 0.f;
+            grids[ 1 ][ i ] = _GLFW_SDF_INF;
+        }
+        else
+        {
+            grids[ 0 ][ i ] = _GLFW_SDF_INF;
+            grids[ 1 ][ i ] = 0.f;
+        }
+    }
+
+    if( !TransformLines( grids, alpha->Width, alpha->Height, GL_FALSE ) ||
+        !TransformLines( grids, alpha->Width, alpha->Height, GL_TRUE ) )
+    {
+        _glfwFreePixels( grids[ 0 ] );
+        _glfwFreePixels( grids[ 1 ] );
+        _glfwFreePixels( pixels );
+        return GL_FALSE;
+    }
+
+    // Average the signed distance over each block of source pixels. Edges
+    // lie half way between inside and outside pixels
+    scale = 127.5f / (float) spread;
+    dst = pixels;
+    for( y = 0; y < height; y ++ )
+    {
+        for( x = 0; x < width; x ++ )
+        {
+            sum = 0.f;
+            count = 0;
+            for( m = y * downscale;
+                 m < ( y + 1 ) * downscale && m < alpha->Height; m ++ )
+            {
+                for( n = x * downscale;
+                     n < ( x + 1 ) * downscale && n < alpha->Width; n ++ )
+                {
+                    i = m * alpha->Width + n;
+                    if( src[ i ] >= 128 )
+                    {
+                        sum += (float) sqrt( grids[ 1 ][ i ] ) - 0.5f;
+                    }
+                    else
+                    {
+                        sum -= (float) sqrt( grids[ 0 ][ i ] ) - 0.5f;
+                    }
+                    count ++;
+                }
+            }
+
+            dist = 127.5f + scale * sum / (float) count;
+            *dst ++ = (unsigned char) ( dist < 0.f ? 0 :
+                                        dist > 255.f ? 255 :
+                                        (int) ( dist + 0.5f ) );
+        }
+    }
+
+    _glfwFreePixels( grids[ 0 ] );
+    _glfwFreePixels( grids[ 1 ] );
+
+    _glfwFreePixels( alpha->Data );
+    alpha->Data   = pixels;
+    alpha->Width  = width;
+    alpha->Height = height;
+
+    return GL_TRUE;
+}
@@ -50,11 +50,27 @@
 // method is included when GL_SGIS_generate_mipmap is not supported (it
 // generates all mipmaps of a 256x256 RGB texture in ~3 ms on a P3-500).
 //
+// Images can be converted between pixel formats (glfwConvertImage),
+// including the packed 16-bit formats, with optional ordered dithering
+// and alpha premultiplication. glfwLoadTexture2D can use this to upload
+// textures with half the memory and bandwidth of 8-bit channels.
+//
+// glfwLoadCachedTexture2D and glfwLoadCachedMemoryTexture2D share
+// texture objects between callers that load the same file (by name, flags
+// and modification time) or the same memory image (by content hash). The
+// textures are reference counted, and released textures are kept in an
+// LRU list until they no longer fit in the budget set with
+// glfwSetTextureCacheSize. Entries are found through hash indices on
+// their source and on their texture name, so loads and releases do not
+// depend on the number of cached textures.
+//
 //========================================================================
 
 
 #include "internal.h"
 
+#include <sys/stat.h>
+
 
 // We want to support automatic mipmap generation
 #ifndef GL_SGIS_generate_mipmap
@@ -63,6 +79,33 @@
  #define GL_SGIS_generate_mipmap    1
 #endif // GL_SGIS_generate_mipmap
 
+// BGRA and packed 16-bit pixel types are part of OpenGL 1.2
+#ifndef GL_VERSION_1_2
+ #define GL_BGRA                        0x80E1
+ #define GL_UNSIGNED_SHORT_4_4_4_4      0x8033
+ #define GL_UNSIGNED_SHORT_5_5_5_1      0x8034
+ #define GL_UNSIGNED_SHORT_5_6_5        0x8363
+#endif // GL_VERSION_1_2
+
+// S3TC compressed internal formats
+#ifndef GL_EXT_texture_compression_s3tc
+ #define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+ #define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif // GL_EXT_texture_compression_s3tc
+
+// SIMD pixel conversion kernels are used where the compiler supports them
+// (the AVX2 versions are selected at run-time)
+#if defined( __SSE2__ )
+ #include <emmintrin.h>
+ #define _GLFW_USE_SSE2
+#endif
+
+#if defined( _GLFW_USE_SSE2 ) && defined( __GNUC__ ) && \
+    ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) )
+ #include <immintrin.h>
+ #define _GLFW_USE_AVX2
+#endif
+
 
 //************************************************************************
 //****                  GLFW internal functions                       ****
@@ -144,7 +187,7 @@ static void UpsampleImage( unsigned char *src, unsigned char *dst,
 // Build the next mip-map level
 //========================================================================
 
-static int HalveImage( GLubyte *src, int *width, int *height,
+int _glfwHalveImage( GLubyte *src, int *width, int *height,
     int components )
 {
     int     halfwidth, halfheight, m, n, k, idx1, idx2;
@@ -223,45 +266,1334 @@ static int RescaleImage( GLFWimage* image )
     width  = (int) 1 << log2;
     if( width < image->Width )
     {
-        width <<= 1;
+        width <<= 1;
+    }
+
+    // Calculate next larger 2^M height
+    for( log2 = 0, height = image->Height; height > 1; height >>= 1, log2 ++ )
+      ;
+
+    height = (int) 1 << log2;
+    if( height < image->Height )
+    {
+        height <<= 1;
+    }
+
+    // Do we really need to rescale?
+    if( width != image->Width || height != image->Height )
+    {
+        // Allocate memory for new (upsampled) image data
+        newsize = width * height * image->BytesPerPixel;
+        data = (unsigned char *) _glfwAllocPixels( newsize );
+        if( data == NULL )
+        {
+            _glfwFreePixels( image->Data );
+            return GL_FALSE;
+        }
+
+        // Copy old image data to new image data with interpolation
+        UpsampleImage( image->Data, data, image->Width, image->Height,
+                       width, height, image->BytesPerPixel );
+
+        // Free memory for old image data (not needed anymore)
+        _glfwFreePixels( image->Data );
+
+        // Set pointer to new image data, and set new image dimensions
+        image->Data   = data;
+        image->Width  = width;
+        image->Height = height;
+    }
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Pixel format conversion
+//
+// Every conversion goes through one row of 8-bit RGBA pixels. The byte
+// swizzle, premultiplication and 16-bit packing stages have SSE2 and
+// AVX2 kernels, the remaining (cheap) stages are plain C.
+//========================================================================
+
+// 4x4 ordered dither matrix
+static const unsigned char BayerMatrix[ 4 ][ 4 ] =
+{
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 }
+};
+
+
+//========================================================================
+// Translate an image descriptor into a GLFW_PIXEL_* format
+//========================================================================
+
+int _glfwGetPixelFormat( const GLFWimage *img )
+{
+    switch( img->Format )
+    {
+        case GL_LUMINANCE:
+            return GLFW_PIXEL_L;
+        case GL_ALPHA:
+            return GLFW_PIXEL_ALPHA;
+        case GL_LUMINANCE_ALPHA:
+            return GLFW_PIXEL_LA;
+        case GL_RGB:
+            return GLFW_PIXEL_RGB;
+        case GL_RGBA:
+            return GLFW_PIXEL_RGBA;
+        case GL_BGRA:
+            return GLFW_PIXEL_BGRA;
+        case GLFW_PIXEL_RGB565:
+        case GLFW_PIXEL_RGBA4444:
+        case GLFW_PIXEL_RGBA5551:
+            return img->Format;
+    }
+
+    // Unknown format, fall back to the pixel size
+    switch( img->BytesPerPixel )
+    {
+        case 1:
+            return GLFW_PIXEL_L;
+        case 2:
+            return GLFW_PIXEL_LA;
+        case 3:
+            return GLFW_PIXEL_RGB;
+        case 4:
+            return GLFW_PIXEL_RGBA;
+    }
+
+    return 0;
+}
+
+
+//========================================================================
+// Return the pixel size and image Format value of a GLFW_PIXEL_* format
+//========================================================================
+
+int _glfwGetPixelFormatSize( int format, int *glformat )
+{
+    switch( format )
+    {
+        case GLFW_PIXEL_L:
+            *glformat = GL_LUMINANCE;
+            return 1;
+        case GLFW_PIXEL_ALPHA:
+            *glformat = GL_ALPHA;
+            return 1;
+        case GLFW_PIXEL_LA:
+            *glformat = GL_LUMINANCE_ALPHA;
+            return 2;
+        case GLFW_PIXEL_RGB:
+            *glformat = GL_RGB;
+            return 3;
+        case GLFW_PIXEL_RGBA:
+            *glformat = GL_RGBA;
+            return 4;
+        case GLFW_PIXEL_BGRA:
+            *glformat = GL_BGRA;
+            return 4;
+        case GLFW_PIXEL_RGB565:
+        case GLFW_PIXEL_RGBA4444:
+        case GLFW_PIXEL_RGBA5551:
+            *glformat = format;
+            return 2;
+    }
+
+    return 0;
+}
+
+
+//========================================================================
+// Swap the R and B bytes of 8-bit RGBA/BGRA pixels
+//========================================================================
+
+#if defined( _GLFW_USE_AVX2 )
+__attribute__(( target( "avx2" ) ))
+static int SwapRedBlueAVX2( const unsigned char *src, unsigned char *dst,
+    int count )
+{
+    __m256i v, ag, rb, mask_ag, mask_b;
+    int n;
+
+    mask_ag = _mm256_set1_epi32( (int) 0xff00ff00 );
+    mask_b  = _mm256_set1_epi32( 0x000000ff );
+
+    for( n = 0; n + 8 <= count; n += 8 )
+    {
+        v  = _mm256_loadu_si256( (const __m256i *) (src + n*4) );
+        ag = _mm256_and_si256( v, mask_ag );
+        rb = _mm256_or_si256(
+                 _mm256_and_si256( _mm256_srli_epi32( v, 16 ), mask_b ),
+                 _mm256_slli_epi32( _mm256_and_si256( v, mask_b ), 16 ) );
+        _mm256_storeu_si256( (__m256i *) (dst + n*4),
+                             _mm256_or_si256( ag, rb ) );
+    }
+
+    return n;
+}
+#endif // _GLFW_USE_AVX2
+
+static void SwapRedBlue( const unsigned char *src, unsigned char *dst,
+    int count )
+{
+    unsigned char tmp;
+    int n = 0;
+
+#if defined( _GLFW_USE_AVX2 )
+    if( __builtin_cpu_supports( "avx2" ) )
+    {
+        n = SwapRedBlueAVX2( src, dst, count );
+    }
+#endif
+
+#if defined( _GLFW_USE_SSE2 )
+    {
+        __m128i v, ag, rb, mask_ag, mask_b;
+
+        mask_ag = _mm_set1_epi32( (int) 0xff00ff00 );
+        mask_b  = _mm_set1_epi32( 0x000000ff );
+
+        for( ; n + 4 <= count; n += 4 )
+        {
+            v  = _mm_loadu_si128( (const __m128i *) (src + n*4) );
+            ag = _mm_and_si128( v, mask_ag );
+            rb = _mm_or_si128(
+                     _mm_and_si128( _mm_srli_epi32( v, 16 ), mask_b ),
+                     _mm_slli_epi32( _mm_and_si128( v, mask_b ), 16 ) );
+            _mm_storeu_si128( (__m128i *) (dst + n*4),
+                              _mm_or_si128( ag, rb ) );
+        }
+    }
+#endif // _GLFW_USE_SSE2
+
+    for( src += n*4, dst += n*4; n < count; n ++ )
+    {
+        tmp    = src[ 0 ];
+        dst[0] = src[ 2 ];
+        dst[1] = src[ 1 ];
+        dst[2] = tmp;
+        dst[3] = src[ 3 ];
+        src += 4;
+        dst += 4;
+    }
+}
+
+
+//========================================================================
+// Multiply the color channels of 8-bit RGBA pixels by their alpha
+//========================================================================
+
+#if defined( _GLFW_USE_AVX2 )
+__attribute__(( target( "avx2" ) ))
+static __m256i PremultiplyAVX2Half( __m256i v, __m256i alphalane,
+    __m256i round )
+{
+    __m256i a;
+
+    // Alpha is multiplied by 255 (i.e. kept), colors by alpha
+    a = _mm256_shufflelo_epi16( v, 0xff );
+    a = _mm256_shufflehi_epi16( a, 0xff );
+    a = _mm256_or_si256( a, alphalane );
+    v = _mm256_add_epi16( _mm256_mullo_epi16( v, a ), round );
+    return _mm256_srli_epi16(
+               _mm256_add_epi16( v, _mm256_srli_epi16( v, 8 ) ), 8 );
+}
+
+__attribute__(( target( "avx2" ) ))
+static int PremultiplyAVX2( unsigned char *pixels, int count )
+{
+    __m256i v, lo, hi, zero, alphalane, round;
+    int n;
+
+    zero      = _mm256_setzero_si256();
+    alphalane = _mm256_set1_epi64x( (long long) 0x00ff000000000000LL );
+    round     = _mm256_set1_epi16( 128 );
+
+    for( n = 0; n + 8 <= count; n += 8 )
+    {
+        v  = _mm256_loadu_si256( (const __m256i *) (pixels + n*4) );
+        lo = PremultiplyAVX2Half( _mm256_unpacklo_epi8( v, zero ),
+                                  alphalane, round );
+        hi = PremultiplyAVX2Half( _mm256_unpackhi_epi8( v, zero ),
+                                  alphalane, round );
+        _mm256_storeu_si256( (__m256i *) (pixels + n*4),
+                             _mm256_packus_epi16( lo, hi ) );
+    }
+
+    return n;
+}
+#endif // _GLFW_USE_AVX2
+
+#if defined( _GLFW_USE_SSE2 )
+static __m128i PremultiplySSE2Half( __m128i v, __m128i alphalane,
+    __m128i round )
+{
+    __m128i a;
+
+    // Alpha is multiplied by 255 (i.e. kept), colors by alpha
+    a = _mm_shufflelo_epi16( v, 0xff );
+    a = _mm_shufflehi_epi16( a, 0xff );
+    a = _mm_or_si128( a, alphalane );
+    v = _mm_add_epi16( _mm_mullo_epi16( v, a ), round );
+    return _mm_srli_epi16( _mm_add_epi16( v, _mm_srli_epi16( v, 8 ) ), 8 );
+}
+#endif // _GLFW_USE_SSE2
+
+static void PremultiplyAlpha( unsigned char *pixels, int count )
+{
+    int n = 0, k, t;
+
+#if defined( _GLFW_USE_AVX2 )
+    if( __builtin_cpu_supports( "avx2" ) )
+    {
+        n = PremultiplyAVX2( pixels, count );
+    }
+#endif
+
+#if defined( _GLFW_USE_SSE2 )
+    {
+        __m128i v, lo, hi, zero, alphalane, round;
+
+        zero      = _mm_setzero_si128();
+        alphalane = _mm_set_epi16( 255, 0, 0, 0, 255, 0, 0, 0 );
+        round     = _mm_set1_epi16( 128 );
+
+        for( ; n + 4 <= count; n += 4 )
+        {
+            v  = _mm_loadu_si128( (const __m128i *) (pixels + n*4) );
+            lo = PremultiplySSE2Half( _mm_unpacklo_epi8( v, zero ),
+                                      alphalane, round );
+            hi = PremultiplySSE2Half( _mm_unpackhi_epi8( v, zero ),
+                                      alphalane, round );
+            _mm_storeu_si128( (__m128i *) (pixels + n*4),
+                              _mm_packus_epi16( lo, hi ) );
+        }
+    }
+#endif // _GLFW_USE_SSE2
+
+    for( pixels += n*4; n < count; n ++ )
+    {
+        for( k = 0; k < 3; k ++ )
+        {
+            t = (int) pixels[ k ] * (int) pixels[ 3 ] + 128;
+            pixels[ k ] = (unsigned char) ((t + (t >> 8)) >> 8);
+        }
+        pixels += 4;
+    }
+}
+
+
+//========================================================================
+// Pack 8-bit RGBA pixels into 16-bit pixels. Each channel is first scaled
+// by v - (v >> shift), which makes the truncation below approximate
+// round( v * (2^bits-1) / 255 ), and then biased (with saturation) by a
+// rounding term or one row of the ordered dither matrix.
+//========================================================================
+
+typedef struct {
+    unsigned char bias[ 16 ];      // Bias for four consecutive pixels
+    unsigned char mask[ 3 ][ 16 ]; // Bytes scaled with a shift of 4, 5, 6
+} _GLFWpack;
+
+#if defined( _GLFW_USE_AVX2 )
+__attribute__(( target( "avx2" ) ))
+static __m256i PackAVX2( __m256i v, int format, const __m256i *scale )
+{
+    __m256i m8, m4, s;
+
+    // Scale and bias the channels
+    s = _mm256_or_si256( _mm256_or_si256(
+            _mm256_and_si256( _mm256_srli_epi16( v, 4 ), scale[0] ),
+            _mm256_and_si256( _mm256_srli_epi16( v, 5 ), scale[1] ) ),
+            _mm256_and_si256( _mm256_srli_epi16( v, 6 ), scale[2] ) );
+    v = _mm256_adds_epu8( _mm256_sub_epi8( v, s ), scale[3] );
+
+    m8 = _mm256_set1_epi32( 0xf8 );
+    m4 = _mm256_set1_epi32( 0xf0 );
+
+    switch( format )
+    {
+        case GLFW_PIXEL_RGB565:
+            return _mm256_or_si256( _mm256_or_si256(
+                _mm256_slli_epi32( _mm256_and_si256( v, m8 ), 8 ),
+                _mm256_slli_epi32( _mm256_and_si256( _mm256_srli_epi32( v, 8 ),
+                                   _mm256_set1_epi32( 0xfc ) ), 3 ) ),
+                _mm256_srli_epi32( _mm256_and_si256( _mm256_srli_epi32( v, 16 ),
+                                   m8 ), 3 ) );
+        case GLFW_PIXEL_RGBA4444:
+            return _mm256_or_si256( _mm256_or_si256(
+                _mm256_slli_epi32( _mm256_and_si256( v, m4 ), 8 ),
+                _mm256_slli_epi32( _mm256_and_si256( _mm256_srli_epi32( v, 8 ),
+                                   m4 ), 4 ) ),
+                _mm256_or_si256(
+                _mm256_and_si256( _mm256_srli_epi32( v, 16 ), m4 ),
+                _mm256_srli_epi32( v, 28 ) ) );
+        default:
+            return _mm256_or_si256( _mm256_or_si256(
+                _mm256_slli_epi32( _mm256_and_si256( v, m8 ), 8 ),
+                _mm256_slli_epi32( _mm256_and_si256( _mm256_srli_epi32( v, 8 ),
+                                   m8 ), 3 ) ),
+                _mm256_or_si256(
+                _mm256_srli_epi32( _mm256_and_si256( _mm256_srli_epi32( v, 16 ),
+                                   m8 ), 2 ),
+                _mm256_srli_epi32( v, 31 ) ) );
+    }
+}
+
+__attribute__(( target( "avx2" ) ))
+static int PackPixelsAVX2( const unsigned char *src, unsigned short *dst,
+    int count, int format, const _GLFWpack *pack )
+{
+    __m256i scale[ 4 ], v1, v2;
+    int n;
+
+    for( n = 0; n < 3; n ++ )
+    {
+        scale[ n ] = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128( (const __m128i *) pack->mask[ n ] ) );
+    }
+    scale[ 3 ] = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128( (const __m128i *) pack->bias ) );
+
+    for( n = 0; n + 16 <= count; n += 16 )
+    {
+        v1 = _mm256_loadu_si256( (const __m256i *) (src + n*4) );
+        v2 = _mm256_loadu_si256( (const __m256i *) (src + n*4 + 32) );
+        v1 = PackAVX2( v1, format, scale );
+        v2 = PackAVX2( v2, format, scale );
+
+        // Sign extend so that the signed saturating pack is exact
+        v1 = _mm256_srai_epi32( _mm256_slli_epi32( v1, 16 ), 16 );
+        v2 = _mm256_srai_epi32( _mm256_slli_epi32( v2, 16 ), 16 );
+        v1 = _mm256_permute4x64_epi64( _mm256_packs_epi32( v1, v2 ), 0xd8 );
+        _mm256_storeu_si256( (__m256i *) (dst + n), v1 );
+    }
+
+    return n;
+}
+#endif // _GLFW_USE_AVX2
+
+#if defined( _GLFW_USE_SSE2 )
+static __m128i PackSSE2( __m128i v, int format, const __m128i *scale )
+{
+    __m128i m8, m4, s;
+
+    // Scale and bias the channels
+    s = _mm_or_si128( _mm_or_si128(
+            _mm_and_si128( _mm_srli_epi16( v, 4 ), scale[0] ),
+            _mm_and_si128( _mm_srli_epi16( v, 5 ), scale[1] ) ),
+            _mm_and_si128( _mm_srli_epi16( v, 6 ), scale[2] ) );
+    v = _mm_adds_epu8( _mm_sub_epi8( v, s ), scale[3] );
+
+    m8 = _mm_set1_epi32( 0xf8 );
+    m4 = _mm_set1_epi32( 0xf0 );
+
+    switch( format )
+    {
+        case GLFW_PIXEL_RGB565:
+            return _mm_or_si128( _mm_or_si128(
+                _mm_slli_epi32( _mm_and_si128( v, m8 ), 8 ),
+                _mm_slli_epi32( _mm_and_si128( _mm_srli_epi32( v, 8 ),
+                                _mm_set1_epi32( 0xfc ) ), 3 ) ),
+                _mm_srli_epi32( _mm_and_si128( _mm_srli_epi32( v, 16 ),
+                                m8 ), 3 ) );
+        case GLFW_PIXEL_RGBA4444:
+            return _mm_or_si128( _mm_or_si128(
+                _mm_slli_epi32( _mm_and_si128( v, m4 ), 8 ),
+                _mm_slli_epi32( _mm_and_si128( _mm_srli_epi32( v, 8 ),
+                                m4 ), 4 ) ),
+                _mm_or_si128(
+                _mm_and_si128( _mm_srli_epi32( v, 16 ), m4 ),
+                _mm_srli_epi32( v, 28 ) ) );
+        default:
+            return _mm_or_si128( _mm_or_si128(
+                _mm_slli_epi32( _mm_and_si128( v, m8 ), 8 ),
+                _mm_slli_epi32( _mm_and_si128( _mm_srli_epi32( v, 8 ),
+                                m8 ), 3 ) ),
+                _mm_or_si128(
+                _mm_srli_epi32( _mm_and_si128( _mm_srli_epi32( v, 16 ),
+                                m8 ), 2 ),
+                _mm_srli_epi32( v, 31 ) ) );
+    }
+}
+#endif // _GLFW_USE_SSE2
+
+static void PackPixels( const unsigned char *src, unsigned short *dst,
+    int count, int format, const _GLFWpack *pack )
+{
+    int n = 0, k, i, c[ 4 ];
+
+#if defined( _GLFW_USE_AVX2 )
+    if( __builtin_cpu_supports( "avx2" ) )
+    {
+        n = PackPixelsAVX2( src, dst, count, format, pack );
+    }
+#endif
+
+#if defined( _GLFW_USE_SSE2 )
+    {
+        __m128i scale[ 4 ], v1, v2;
+
+        for( i = 0; i < 3; i ++ )
+        {
+            scale[ i ] = _mm_loadu_si128( (const __m128i *) pack->mask[ i ] );
+        }
+        scale[ 3 ] = _mm_loadu_si128( (const __m128i *) pack->bias );
+
+        for( ; n + 8 <= count; n += 8 )
+        {
+            v1 = _mm_loadu_si128( (const __m128i *) (src + n*4) );
+            v2 = _mm_loadu_si128( (const __m128i *) (src + n*4 + 16) );
+            v1 = PackSSE2( v1, format, scale );
+            v2 = PackSSE2( v2, format, scale );
+
+            // Sign extend so that the signed saturating pack is exact
+            v1 = _mm_srai_epi32( _mm_slli_epi32( v1, 16 ), 16 );
+            v2 = _mm_srai_epi32( _mm_slli_epi32( v2, 16 ), 16 );
+            _mm_storeu_si128( (__m128i *) (dst + n),
+                              _mm_packs_epi32( v1, v2 ) );
+        }
+    }
+#endif // _GLFW_USE_SSE2
+
+    for( src += n*4; n < count; n ++ )
+    {
+        for( k = 0; k < 4; k ++ )
+        {
+            c[ k ] = src[ k ];
+            for( i = 0; i < 3; i ++ )
+            {
+                c[ k ] -= (c[ k ] >> (i + 4)) & pack->mask[ i ][ k ];
+            }
+            c[ k ] += pack->bias[ (n & 3)*4 + k ];
+            if( c[ k ] > 255 ) c[ k ] = 255;
+        }
+
+        switch( format )
+        {
+            case GLFW_PIXEL_RGB565:
+                dst[ n ] = (unsigned short) (((c[0] & 0xf8) << 8) |
+                                             ((c[1] & 0xfc) << 3) |
+                                             (c[2] >> 3));
+                break;
+            case GLFW_PIXEL_RGBA4444:
+                dst[ n ] = (unsigned short) (((c[0] & 0xf0) << 8) |
+                                             ((c[1] & 0xf0) << 4) |
+                                             (c[2] & 0xf0) | (c[3] >> 4));
+                break;
+            default:
+                dst[ n ] = (unsigned short) (((c[0] & 0xf8) << 8) |
+                                             ((c[1] & 0xf8) << 3) |
+                                             ((c[2] & 0xf8) >> 2) |
+                                             (c[3] >> 7));
+                break;
+        }
+
+        src += 4;
+    }
+}
+
+
+//========================================================================
+// Set up the per-row scaling and bias used by PackPixels
+//========================================================================
+
+static void GetPackParams( _GLFWpack *pack, int format, int y, int flags )
+{
+    int n, k, bits[ 4 ], step;
+
+    switch( format )
+    {
+        case GLFW_PIXEL_RGB565:
+            bits[0] = 5; bits[1] = 6; bits[2] = 5; bits[3] = 8;
+            break;
+        case GLFW_PIXEL_RGBA4444:
+            bits[0] = 4; bits[1] = 4; bits[2] = 4; bits[3] = 4;
+            break;
+        default:
+            bits[0] = 5; bits[1] = 5; bits[2] = 5; bits[3] = 1;
+            break;
+    }
+
+    memset( pack, 0, sizeof( _GLFWpack ) );
+
+    for( n = 0; n < 4; n ++ )
+    {
+        for( k = 0; k < 4; k ++ )
+        {
+            // Channels that are kept at 8 bits and one bit alpha (which
+            // is a plain threshold) are neither scaled nor biased
+            if( bits[ k ] == 1 || bits[ k ] == 8 )
+            {
+                continue;
+            }
+
+            step = 1 << (8 - bits[ k ]);
+            pack->mask[ bits[ k ] - 4 ][ n*4 + k ] =
+                (unsigned char) (0xff >> bits[ k ]);
+
+            if( (flags & GLFW_DITHER_BIT) && k < 3 )
+            {
+                pack->bias[ n*4 + k ] = (unsigned char)
+                    ((BayerMatrix[ y & 3 ][ n ] * step) >> 4);
+            }
+            else
+            {
+                pack->bias[ n*4 + k ] = (unsigned char) ((step >> 1) - 1);
+            }
+        }
+    }
+}
+
+
+//========================================================================
+// Expand a row of pixels to 8-bit RGBA
+//========================================================================
+
+static void ExpandRow( const unsigned char *src, unsigned char *dst,
+    int count, int format )
+{
+    const unsigned short *packed = (const unsigned short *) src;
+    int n, p;
+
+    switch( format )
+    {
+        case GLFW_PIXEL_RGBA:
+            memcpy( dst, src, count*4 );
+            return;
+        case GLFW_PIXEL_BGRA:
+            SwapRedBlue( src, dst, count );
+            return;
+    }
+
+    for( n = 0; n < count; n ++ )
+    {
+        switch( format )
+        {
+            case GLFW_PIXEL_L:
+                dst[0] = dst[1] = dst[2] = src[ n ];
+                dst[3] = 255;
+                break;
+            case GLFW_PIXEL_ALPHA:
+                dst[0] = dst[1] = dst[2] = 255;
+                dst[3] = src[ n ];
+                break;
+            case GLFW_PIXEL_LA:
+                dst[0] = dst[1] = dst[2] = src[ n*2 ];
+                dst[3] = src[ n*2 + 1 ];
+                break;
+            case GLFW_PIXEL_RGB:
+                dst[0] = src[ n*3 ];
+                dst[1] = src[ n*3 + 1 ];
+                dst[2] = src[ n*3 + 2 ];
+                dst[3] = 255;
+                break;
+            case GLFW_PIXEL_RGB565:
+                p = packed[ n ];
+                dst[0] = (unsigned char) (((p >> 8) & 0xf8) | (p >> 13));
+                dst[1] = (unsigned char) (((p >> 3) & 0xfc) | ((p >> 9) & 3));
+                dst[2] = (unsigned char) (((p << 3) & 0xf8) | ((p >> 2) & 7));
+                dst[3] = 255;
+                break;
+            case GLFW_PIXEL_RGBA4444:
+                p = packed[ n ];
+                dst[0] = (unsigned char) (((p >> 12) & 15) * 17);
+                dst[1] = (unsigned char) (((p >> 8) & 15) * 17);
+                dst[2] = (unsigned char) (((p >> 4) & 15) * 17);
+                dst[3] = (unsigned char) ((p & 15) * 17);
+                break;
+            case GLFW_PIXEL_RGBA5551:
+                p = packed[ n ];
+                dst[0] = (unsigned char) (((p >> 8) & 0xf8) | (p >> 13));
+                dst[1] = (unsigned char) (((p >> 3) & 0xf8) | ((p >> 8) & 7));
+                dst[2] = (unsigned char) (((p << 2) & 0xf8) | ((p >> 3) & 7));
+                dst[3] = (p & 1) ? 255 : 0;
+                break;
+        }
+        dst += 4;
+    }
+}
+
+
+//========================================================================
+// Convert a row of 8-bit RGBA pixels to the target format
+//========================================================================
+
+static void CompressRow( const unsigned char *src, unsigned char *dst,
+    int count, int format, int y, int flags )
+{
+    _GLFWpack pack;
+    int n;
+
+    switch( format )
+    {
+        case GLFW_PIXEL_RGBA:
+            memcpy( dst, src, count*4 );
+            return;
+        case GLFW_PIXEL_BGRA:
+            SwapRedBlue( src, dst, count );
+            return;
+        case GLFW_PIXEL_RGB565:
+        case GLFW_PIXEL_RGBA4444:
+        case GLFW_PIXEL_RGBA5551:
+            GetPackParams( &pack, format, y, flags );
+            PackPixels( src, (unsigned short *) dst, count, format, &pack );
+            return;
+    }
+
+    for( n = 0; n < count; n ++ )
+    {
+        switch( format )
+        {
+            case GLFW_PIXEL_L:
+                *dst ++ = (unsigned char) ((77 * src[0] + 150 * src[1] +
+                                            29 * src[2] + 128) >> 8);
+                break;
+            case GLFW_PIXEL_ALPHA:
+                *dst ++ = src[3];
+                break;
+            case GLFW_PIXEL_LA:
+                *dst ++ = (unsigned char) ((77 * src[0] + 150 * src[1] +
+                                            29 * src[2] + 128) >> 8);
+                *dst ++ = src[3];
+                break;
+            case GLFW_PIXEL_RGB:
+                *dst ++ = src[0];
+                *dst ++ = src[1];
+                *dst ++ = src[2];
+                break;
+        }
+        src += 4;
+    }
+}
+
+
+//========================================================================
+// Convert the pixels of an image to another pixel format. The rows of
+// source and destination may overlap if both formats have equal size.
+//========================================================================
+
+int _glfwConvertPixels( const GLFWimage *img, unsigned char *dst,
+    int format, int flags )
+{
+    int srcformat, srcbpp, dstbpp, glformat, y;
+    unsigned char *row;
+    const unsigned char *src;
+
+    srcformat = _glfwGetPixelFormat( img );
+    srcbpp = _glfwGetPixelFormatSize( srcformat, &glformat );
+    dstbpp = _glfwGetPixelFormatSize( format, &glformat );
+    if( !srcbpp || !dstbpp )
+    {
+        return GL_FALSE;
+    }
+
+    // Premultiplication only makes sense if there is an alpha channel
+    if( srcformat == GLFW_PIXEL_L || srcformat == GLFW_PIXEL_RGB ||
+        srcformat == GLFW_PIXEL_RGB565 )
+    {
+        flags &= ~GLFW_PREMULTIPLY_ALPHA_BIT;
+    }
+
+    // Nothing to do?
+    if( srcformat == format && !(flags & GLFW_PREMULTIPLY_ALPHA_BIT) )
+    {
+        if( dst != img->Data )
+        {
+            memcpy( dst, img->Data, img->Width * img->Height * dstbpp );
+        }
+        return GL_TRUE;
+    }
+
+    // One row of intermediate RGBA pixels
+    row = (unsigned char *) _glfwMallocAs( img->Width * 4,
+                                           GLFW_MEMORY_IMAGE );
+    if( row == NULL )
+    {
+        return GL_FALSE;
+    }
+
+    src = img->Data;
+    for( y = 0; y < img->Height; y ++ )
+    {
+        ExpandRow( src, row, img->Width, srcformat );
+
+        if( flags & GLFW_PREMULTIPLY_ALPHA_BIT )
+        {
+            PremultiplyAlpha( row, img->Width );
+        }
+
+        CompressRow( row, dst, img->Width, format, y, flags );
+
+        src += img->Width * srcbpp;
+        dst += img->Width * dstbpp;
+    }
+
+    _glfwFree( row );
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Return the glTexImage2D parameters for a GLFW_PIXEL_* format
+//========================================================================
+
+void _glfwGetUploadFormat( int pixelformat, GLint *internalformat,
+    GLenum *format, GLenum *type )
+{
+    *type = GL_UNSIGNED_BYTE;
+
+    switch( pixelformat )
+    {
+        case GLFW_PIXEL_L:
+            *format = GL_LUMINANCE;
+            break;
+        case GLFW_PIXEL_ALPHA:
+            *format = GL_ALPHA;
+            break;
+        case GLFW_PIXEL_LA:
+            *format = GL_LUMINANCE_ALPHA;
+            break;
+        case GLFW_PIXEL_RGB:
+            *format = GL_RGB;
+            break;
+        default:
+        case GLFW_PIXEL_RGBA:
+            *format = GL_RGBA;
+            break;
+        case GLFW_PIXEL_BGRA:
+            *internalformat = GL_RGBA;
+            *format = GL_BGRA;
+            return;
+        case GLFW_PIXEL_RGB565:
+            *internalformat = GL_RGB5;
+            *format = GL_RGB;
+            *type = GL_UNSIGNED_SHORT_5_6_5;
+            return;
+        case GLFW_PIXEL_RGBA4444:
+            *internalformat = GL_RGBA4;
+            *format = GL_RGBA;
+            *type = GL_UNSIGNED_SHORT_4_4_4_4;
+            return;
+        case GLFW_PIXEL_RGBA5551:
+            *internalformat = GL_RGB5_A1;
+            *format = GL_RGBA;
+            *type = GL_UNSIGNED_SHORT_5_5_5_1;
+            return;
+    }
+
+    *internalformat = *format;
+}
+
+
+//========================================================================
+// Return a pixel format that can hold the pixels of all given images
+//========================================================================
+
+int _glfwGetCommonPixelFormat( const GLFWimage *images, int count )
+{
+    int n, color = GL_FALSE, alpha = GL_FALSE, lum = GL_FALSE;
+
+    for( n = 0; n < count; n ++ )
+    {
+        switch( _glfwGetPixelFormat( &images[ n ] ) )
+        {
+            case GLFW_PIXEL_L:
+                lum = GL_TRUE;
+                break;
+            case GLFW_PIXEL_ALPHA:
+                alpha = GL_TRUE;
+                break;
+            case GLFW_PIXEL_LA:
+                lum = alpha = GL_TRUE;
+                break;
+            case GLFW_PIXEL_RGB:
+            case GLFW_PIXEL_RGB565:
+                color = GL_TRUE;
+                break;
+            default:
+                color = alpha = GL_TRUE;
+                break;
+        }
+    }
+
+    if( color )
+    {
+        return alpha ? GLFW_PIXEL_RGBA : GLFW_PIXEL_RGB;
+    }
+    if( lum )
+    {
+        return alpha ? GLFW_PIXEL_LA : GLFW_PIXEL_L;
+    }
+
+    return GLFW_PIXEL_ALPHA;
+}
+
+
+//========================================================================
+// Return the 16-bit format that pixels should be packed into before
+// uploading, or zero if they should be uploaded as they are
+//========================================================================
+
+int _glfwGetPackFormat( int pixelformat, int flags )
+{
+    // Packed 16-bit pixel types require OpenGL 1.2
+    if( !( flags & GLFW_PACKED_16BIT_BIT ) ||
+        ( _glfwWin.glMajor == 1 && _glfwWin.glMinor < 2 ) )
+    {
+        return 0;
+    }
+
+    if( pixelformat == GLFW_PIXEL_RGB )
+    {
+        return GLFW_PIXEL_RGB565;
+    }
+    else if( pixelformat == GLFW_PIXEL_RGBA ||
+             pixelformat == GLFW_PIXEL_BGRA )
+    {
+        return ( flags & GLFW_PACKED_ALPHA1_BIT ) ?
+               GLFW_PIXEL_RGBA5551 : GLFW_PIXEL_RGBA4444;
+    }
+
+    return 0;
+}
+
+
+//========================================================================
+// Return the compressed internal format that the driver should compress
+// pixels into, or zero if they should not be compressed
+//========================================================================
+
+static GLint GetCompressedFormat( int pixelformat, int flags )
+{
+    if( !( flags & GLFW_COMPRESS_BIT ) ||
+        !_glfwWin.has_GL_EXT_texture_compression_s3tc )
+    {
+        return 0;
+    }
+
+    if( pixelformat == GLFW_PIXEL_RGB )
+    {
+        return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    }
+    else if( pixelformat == GLFW_PIXEL_RGBA ||
+             pixelformat == GLFW_PIXEL_BGRA )
+    {
+        return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    }
+
+    return 0;
+}
+
+
+//========================================================================
+// Texture cache
+//========================================================================
+
+//========================================================================
+// Compute a 64-bit content hash of a memory buffer (two 32-bit lanes)
+//========================================================================
+
+void _glfwHashData( const void *data, long size, unsigned int *hash )
+{
+    const unsigned char *bytes = (const unsigned char *) data;
+    unsigned int h0 = 2166136261u, h1 = 0x9e3779b9u, word;
+    long n;
+
+    // Hash one 32-bit word at a time, which is much faster than FNV-1a
+    // on single bytes, and mix it into two independent lanes
+    for( n = 0; n + 4 <= size; n += 4 )
+    {
+        memcpy( &word, bytes + n, 4 );
+        h0 = ( h0 ^ word ) * 16777619u;
+        h1 = ( h1 ^ word ) * 0x85ebca6bu;
+        h1 ^= h1 >> 13;
+    }
+    for( ; n < size; n ++ )
+    {
+        h0 = ( h0 ^ bytes[ n ] ) * 16777619u;
+        h1 = ( h1 ^ bytes[ n ] ) * 0x85ebca6bu;
+    }
+
+    hash[ 0 ] = h0 ^ ( h0 >> 15 );
+    hash[ 1 ] = h1 ^ ( h1 >> 16 );
+}
+
+
+//========================================================================
+// Unlink a texture cache entry
+//========================================================================
+
+static void UnlinkTexEntry( _GLFWtexentry *entry )
+{
+    if( entry->previous )
+    {
+        entry->previous->next = entry->next;
+    }
+    else
+    {
+        _glfwTexCache.first = entry->next;
+    }
+
+    if( entry->next )
+    {
+        entry->next->previous = entry->previous;
+    }
+    else
+    {
+        _glfwTexCache.last = entry->previous;
+    }
+}
+
+
+//========================================================================
+// Make a texture cache entry the most recently used one
+//========================================================================
+
+static void TouchTexEntry( _GLFWtexentry *entry )
+{
+    if( _glfwTexCache.first == entry )
+    {
+        return;
+    }
+
+    if( entry->previous || entry->next || _glfwTexCache.last == entry )
+    {
+        UnlinkTexEntry( entry );
+    }
+
+    entry->previous = NULL;
+    entry->next = _glfwTexCache.first;
+    if( _glfwTexCache.first )
+    {
+        _glfwTexCache.first->previous = entry;
+    }
+    else
+    {
+        _glfwTexCache.last = entry;
+    }
+    _glfwTexCache.first = entry;
+}
+
+
+//========================================================================
+// Hash the source and flags of a texture cache entry
+//========================================================================
+
+static unsigned int GetTexEntryKey( const char *path,
+    const unsigned int *hash, int flags )
+{
+    unsigned int pathhash[ 2 ];
+
+    if( path )
+    {
+        _glfwHashData( path, (long) strlen( path ), pathhash );
+        hash = pathhash;
+    }
+
+    return ( hash[ 0 ] ^ ( hash[ 1 ] * 31u ) ) +
+           (unsigned int) flags * 2654435761u;
+}
+
+
+//========================================================================
+// Find the name index bucket of a texture
+//========================================================================
+
+static _GLFWtexentry **GetNameBucket( GLuint texture )
+{
+    return &_glfwTexCache.nameIndex[ ( (unsigned int) texture *
+                                       2654435761u ) &
+                                     ( _glfwTexCache.indexSize - 1 ) ];
+}
+
+
+//========================================================================
+// Make room in the texture cache indices for one more entry, growing them
+// when there are as many entries as buckets
+//========================================================================
+
+static int ReserveTexIndex( void )
+{
+    _GLFWtexentry **keyindex, **nameindex, **bucket, *entry;
+    int size;
+
+    if( _glfwTexCache.count < _glfwTexCache.indexSize )
+    {
+        return GL_TRUE;
+    }
+
+    size = _glfwTexCache.indexSize ? _glfwTexCache.indexSize * 2 : 64;
+    keyindex = (_GLFWtexentry **)
+        _glfwCalloc( size, sizeof( _GLFWtexentry * ) );
+    nameindex = (_GLFWtexentry **)
+        _glfwCalloc( size, sizeof( _GLFWtexentry * ) );
+    if( keyindex == NULL || nameindex == NULL )
+    {
+        _glfwFree( keyindex );
+        _glfwFree( nameindex );
+
+        // Longer chains are still better than failing the load
+        return _glfwTexCache.indexSize > 0;
+    }
+
+    _glfwFree( _glfwTexCache.keyIndex );
+    _glfwFree( _glfwTexCache.nameIndex );
+    _glfwTexCache.keyIndex  = keyindex;
+    _glfwTexCache.nameIndex = nameindex;
+    _glfwTexCache.indexSize = size;
+
+    for( entry = _glfwTexCache.first; entry; entry = entry->next )
+    {
+        bucket = &keyindex[ entry->key & ( size - 1 ) ];
+        entry->keyNext = *bucket;
+        *bucket = entry;
+
+        bucket = GetNameBucket( entry->texture );
+        entry->nameNext = *bucket;
+        *bucket = entry;
+    }
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Add a texture cache entry to the indices (ReserveTexIndex must have
+// made room for it)
+//========================================================================
+
+static void IndexTexEntry( _GLFWtexentry *entry )
+{
+    _GLFWtexentry **bucket;
+
+    bucket = &_glfwTexCache.keyIndex[ entry->key &
+                                      ( _glfwTexCache.indexSize - 1 ) ];
+    entry->keyNext = *bucket;
+    *bucket = entry;
+
+    bucket = GetNameBucket( entry->texture );
+    entry->nameNext = *bucket;
+    *bucket = entry;
+
+    _glfwTexCache.count ++;
+}
+
+
+//========================================================================
+// Remove a texture cache entry from the indices
+//========================================================================
+
+static void UnindexTexEntry( _GLFWtexentry *entry )
+{
+    _GLFWtexentry **link;
+
+    for( link = &_glfwTexCache.keyIndex[ entry->key &
+                                         ( _glfwTexCache.indexSize - 1 ) ];
+         *link != entry; link = &(*link)->keyNext )
+      ;
+    *link = entry->keyNext;
+
+    for( link = GetNameBucket( entry->texture ); *link != entry;
+         link = &(*link)->nameNext )
+      ;
+    *link = entry->nameNext;
+
+    _glfwTexCache.count --;
+}
+
+
+//========================================================================
+// Delete a texture cache entry and its texture
+//========================================================================
+
+static void FreeTexEntry( _GLFWtexentry *entry )
+{
+    UnindexTexEntry( entry );
+    UnlinkTexEntry( entry );
+    _glfwTexCache.bytes -= entry->bytes;
+
+    glDeleteTextures( 1, &entry->texture );
+
+    if( entry->path )
+    {
+        _glfwFree( entry->path );
+    }
+    _glfwFree( entry );
+}
+
+
+//========================================================================
+// Delete released textures, least recently used first, until the cache
+// fits in its budget
+//========================================================================
+
+static void TrimTextureCache( void )
+{
+    _GLFWtexentry *entry, *previous;
+
+    for( entry = _glfwTexCache.last;
+         entry && _glfwTexCache.bytes > _glfwTexCache.budget;
+         entry = previous )
+    {
+        previous = entry->previous;
+        if( entry->refCount == 0 )
+        {
+            FreeTexEntry( entry );
+        }
+    }
+}
+
+
+//========================================================================
+// Find a cached texture, and claim a reference to it
+//========================================================================
+
+static GLuint FindCachedTexture( const char *path, const unsigned int *hash,
+    long size, long mtime, int flags )
+{
+    _GLFWtexentry *entry;
+    unsigned int  key;
+
+    if( _glfwTexCache.indexSize == 0 )
+    {
+        return 0;
+    }
+
+    key = GetTexEntryKey( path, hash, flags );
+    for( entry = _glfwTexCache.keyIndex[ key &
+                                         ( _glfwTexCache.indexSize - 1 ) ];
+         entry; entry = entry->keyNext )
+    {
+        if( entry->key != key || entry->flags != flags ||
+            entry->size != size || entry->mtime != mtime )
+        {
+            continue;
+        }
+
+        if( path ? ( entry->path && !strcmp( entry->path, path ) ) :
+                   ( !entry->path && entry->hash[ 0 ] == hash[ 0 ] &&
+                     entry->hash[ 1 ] == hash[ 1 ] ) )
+        {
+            entry->refCount ++;
+            TouchTexEntry( entry );
+            glBindTexture( GL_TEXTURE_2D, entry->texture );
+            return entry->texture;
+        }
+    }
+
+    return 0;
+}
+
+
+//========================================================================
+// Upload an image to a new texture object and add it to the cache
+//========================================================================
+
+static GLuint AddCachedTexture( GLFWimage *img, const char *path,
+    const unsigned int *hash, long size, long mtime, int flags )
+{
+    _GLFWtexentry *entry;
+    int pixelformat, glformat, bpp, packformat;
+
+    entry = ReserveTexIndex() ?
+        (_GLFWtexentry *) _glfwCalloc( 1, sizeof( _GLFWtexentry ) ) : NULL;
+    if( entry == NULL )
+    {
+        glfwFreeImage( img );
+        return 0;
+    }
+
+    if( path )
+    {
+        entry->path = (char *) _glfwMalloc( strlen( path ) + 1 );
+        if( entry->path == NULL )
+        {
+            _glfwFree( entry );
+            glfwFreeImage( img );
+            return 0;
+        }
+        strcpy( entry->path, path );
+    }
+    else
+    {
+        entry->hash[ 0 ] = hash[ 0 ];
+        entry->hash[ 1 ] = hash[ 1 ];
     }
 
-    // Calculate next larger 2^M height
-    for( log2 = 0, height = image->Height; height > 1; height >>= 1, log2 ++ )
-      ;
-
-    height = (int) 1 << log2;
-    if( height < image->Height )
+    // Estimate the texture memory use, including a third for mipmaps
+    pixelformat = _glfwGetPixelFormat( img );
+    packformat  = _glfwGetPackFormat( pixelformat, flags );
+    bpp = _glfwGetPixelFormatSize( packformat ? packformat : pixelformat,
+                                   &glformat );
+    entry->bytes = (long) img->Width * img->Height * bpp;
+    switch( GetCompressedFormat( pixelformat, flags ) )
     {
-        height <<= 1;
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+            entry->bytes = (long) img->Width * img->Height / 2;
+            break;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            entry->bytes = (long) img->Width * img->Height;
+            break;
+    }
+    if( flags & GLFW_BUILD_MIPMAPS_BIT )
+    {
+        entry->bytes += entry->bytes / 3;
     }
 
-    // Do we really need to rescale?
-    if( width != image->Width || height != image->Height )
+    entry->key      = GetTexEntryKey( path, hash, flags );
+    entry->size     = size;
+    entry->mtime    = mtime;
+    entry->flags    = flags;
+    entry->refCount = 1;
+
+    glGenTextures( 1, &entry->texture );
+    glBindTexture( GL_TEXTURE_2D, entry->texture );
+
+    if( !glfwLoadTextureImage2D( img, flags ) )
     {
-        // Allocate memory for new (upsampled) image data
-        newsize = width * height * image->BytesPerPixel;
-        data = (unsigned char *) malloc( newsize );
-        if( data == NULL )
+        glDeleteTextures( 1, &entry->texture );
+        if( entry->path )
         {
-            free( image->Data );
-            return GL_FALSE;
+            _glfwFree( entry->path );
         }
+        _glfwFree( entry );
+        glfwFreeImage( img );
+        return 0;
+    }
 
-        // Copy old image data to new image data with interpolation
-        UpsampleImage( image->Data, data, image->Width, image->Height,
-                       width, height, image->BytesPerPixel );
+    // Data buffer is not needed anymore
+    glfwFreeImage( img );
 
-        // Free memory for old image data (not needed anymore)
-        free( image->Data );
+    IndexTexEntry( entry );
+    TouchTexEntry( entry );
+    _glfwTexCache.bytes += entry->bytes;
+    TrimTextureCache();
 
-        // Set pointer to new image data, and set new image dimensions
-        image->Data   = data;
-        image->Width  = width;
-        image->Height = height;
+    return entry->texture;
+}
+
+
+//========================================================================
+// Delete all cached textures (called before the context is destroyed)
+//========================================================================
+
+void _glfwClearTextureCache( void )
+{
+    while( _glfwTexCache.first )
+    {
+        FreeTexEntry( _glfwTexCache.first );
     }
 
-    return GL_TRUE;
+    _glfwFree( _glfwTexCache.keyIndex );
+    _glfwFree( _glfwTexCache.nameIndex );
+    _glfwTexCache.keyIndex  = NULL;
+    _glfwTexCache.nameIndex = NULL;
+    _glfwTexCache.indexSize = 0;
 }
 
 
@@ -427,7 +1759,7 @@ GLFWAPI void GLFWAPIENTRY glfwFreeImage( GLFWimage *img )
     // Free memory
     if( img->Data != NULL )
     {
-        free( img->Data );
+        _glfwFreePixels( img->Data );
         img->Data = NULL;
     }
 
@@ -439,6 +1771,93 @@ GLFWAPI void GLFWAPIENTRY glfwFreeImage( GLFWimage *img )
 }
 
 
+//========================================================================
+// Write an image to a file
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwWriteImage( const char *name,
+    const GLFWimage *img, int flags )
+{
+    FILE *file;
+    int  success;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return GL_FALSE;
+    }
+
+    file = fopen( name, "wb" );
+    if( file == NULL )
+    {
+        return GL_FALSE;
+    }
+
+    // We only support TGA files at the moment
+    success = _glfwWriteTGA( file, img, flags );
+
+    if( fclose( file ) != 0 )
+    {
+        success = GL_FALSE;
+    }
+
+    return success;
+}
+
+
+//========================================================================
+// Convert an image to another pixel format
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwConvertImage( const GLFWimage *src,
+    GLFWimage *dst, int format, int flags )
+{
+    int bpp, glformat;
+    unsigned char *data;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return GL_FALSE;
+    }
+
+    // Is it a valid target format?
+    bpp = _glfwGetPixelFormatSize( format, &glformat );
+    if( !bpp || src->Data == NULL )
+    {
+        return GL_FALSE;
+    }
+
+    // Allocate memory for converted image data
+    data = (unsigned char *)
+        _glfwAllocPixels( src->Width * src->Height * bpp );
+    if( data == NULL )
+    {
+        return GL_FALSE;
+    }
+
+    if( !_glfwConvertPixels( src, data, format, flags ) )
+    {
+        _glfwFreePixels( data );
+        return GL_FALSE;
+    }
+
+    // In-place conversion replaces the old image data
+    if( dst == src )
+    {
+        _glfwFreePixels( dst->Data );
+    }
+
+    dst->Width         = src->Width;
+    dst->Height        = src->Height;
+    dst->Format        = glformat;
+    dst->BytesPerPixel = bpp;
+    dst->Data          = data;
+
+    return GL_TRUE;
+}
+
+
 //========================================================================
 // Read an image from a file, and upload it to texture memory
 //========================================================================
@@ -459,6 +1878,12 @@ GLFWAPI int GLFWAPIENTRY glfwLoadTexture2D( const char *name, int flags )
         flags &= (~GLFW_NO_RESCALE_BIT);
     }
 
+    // The disk cache is keyed by file contents, so load the whole file
+    if( _glfwTexCache.diskPath )
+    {
+        return _glfwLoadFileTexture( name, flags );
+    }
+
     // Read image from file
     if( !glfwReadImage( name, &img, flags ) )
     {
@@ -497,6 +1922,13 @@ GLFWAPI int  GLFWAPIENTRY glfwLoadMemoryTexture2D( const void *data, long size,
         flags &= (~GLFW_NO_RESCALE_BIT);
     }
 
+    // Use the processed texture from the disk cache, if there is one
+    if( _glfwTexCache.diskPath &&
+        _glfwLoadDiskCachedTexture( data, size, flags ) )
+    {
+        return GL_TRUE;
+    }
+
     // Read image from file
     if( !glfwReadMemoryImage( data, size, &img, flags ) )
     {
@@ -511,6 +1943,12 @@ GLFWAPI int  GLFWAPIENTRY glfwLoadMemoryTexture2D( const void *data, long size,
     // Data buffer is not needed anymore
     glfwFreeImage( &img );
 
+    // Store the processed texture in the disk cache
+    if( _glfwTexCache.diskPath )
+    {
+        _glfwStoreDiskCachedTexture( data, size, flags );
+    }
+
     return GL_TRUE;
 }
 
@@ -521,9 +1959,11 @@ GLFWAPI int  GLFWAPIENTRY glfwLoadMemoryTexture2D( const void *data, long size,
 
 GLFWAPI int  GLFWAPIENTRY glfwLoadTextureImage2D( GLFWimage *img, int flags )
 {
-    GLint   UnpackAlignment, GenMipMap;
-    int     level, format, AutoGen, newsize, n;
-    unsigned char *data, *dataptr;
+    GLint   UnpackAlignment, GenMipMap, internalformat, compressedformat;
+    GLenum  format, type;
+    int     level, AutoGen, HasPacked, newsize, n;
+    int     pixelformat, packformat;
+    unsigned char *data, *dataptr, *packed;
 
     // Is GLFW initialized?
     if( !_glfwInitialized || !_glfwWin.opened )
@@ -544,10 +1984,10 @@ GLFWAPI int  GLFWAPIENTRY glfwLoadTextureImage2D( GLFWimage *img, int flags )
 
         // Allocate memory for new RGBA image data
         newsize = img->Width * img->Height * img->BytesPerPixel;
-        data = (unsigned char *) malloc( newsize );
+        data = (unsigned char *) _glfwAllocPixels( newsize );
         if( data == NULL )
         {
-            free( img->Data );
+            _glfwFreePixels( img->Data );
             return GL_FALSE;
         }
 
@@ -562,20 +2002,86 @@ GLFWAPI int  GLFWAPIENTRY glfwLoadTextureImage2D( GLFWimage *img, int flags )
         }
 
         // Free memory for old image data (not needed anymore)
-        free( img->Data );
+        _glfwFreePixels( img->Data );
 
         // Set pointer to new image data
         img->Data = data;
     }
 
-    // Set unpack alignment to one byte
-    glGetIntegerv( GL_UNPACK_ALIGNMENT, &UnpackAlignment );
-    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
-
     // Should we use automatic mipmap generation?
     AutoGen = ( flags & GLFW_BUILD_MIPMAPS_BIT ) &&
               _glfwWin.has_GL_SGIS_generate_mipmap;
 
+    // BGRA and packed 16-bit pixel types require OpenGL 1.2
+    HasPacked = _glfwWin.glMajor > 1 || _glfwWin.glMinor >= 2;
+
+    pixelformat = _glfwGetPixelFormat( img );
+    packformat  = 0;
+
+    // Images that are already packed have to be expanded if they cannot
+    // be uploaded as they are, or if their mipmaps are built here
+    if( pixelformat == GLFW_PIXEL_RGB565 ||
+        pixelformat == GLFW_PIXEL_RGBA4444 ||
+        pixelformat == GLFW_PIXEL_RGBA5551 ||
+        pixelformat == GLFW_PIXEL_BGRA )
+    {
+        if( !HasPacked ||
+            ( ( flags & GLFW_BUILD_MIPMAPS_BIT ) && !AutoGen &&
+              pixelformat != GLFW_PIXEL_BGRA ) )
+        {
+            if( HasPacked )
+            {
+                // Pack each mipmap level again before uploading it
+                packformat = pixelformat;
+            }
+
+            if( !glfwConvertImage( img, img, GLFW_PIXEL_RGBA, 0 ) )
+            {
+                return GL_FALSE;
+            }
+
+            pixelformat = GLFW_PIXEL_RGBA;
+        }
+    }
+
+    // Premultiply alpha before any mipmap levels are built
+    if( flags & GLFW_PREMULTIPLY_ALPHA_BIT )
+    {
+        if( !_glfwConvertPixels( img, img->Data, pixelformat,
+                            GLFW_PREMULTIPLY_ALPHA_BIT ) )
+        {
+            return GL_FALSE;
+        }
+    }
+
+    // Should the driver compress the texture? Otherwise, should we pack
+    // it into 16-bit pixels?
+    compressedformat = GetCompressedFormat( pixelformat, flags );
+    if( compressedformat )
+    {
+        packformat = 0;
+    }
+    else if( !packformat )
+    {
+        packformat = _glfwGetPackFormat( pixelformat, flags );
+    }
+
+    // Allocate memory for packed mipmap levels
+    packed = NULL;
+    if( packformat )
+    {
+        packed = (unsigned char *)
+            _glfwAllocPixels( img->Width * img->Height * 2 );
+        if( packed == NULL )
+        {
+            return GL_FALSE;
+        }
+    }
+
+    // Set unpack alignment to one byte
+    glGetIntegerv( GL_UNPACK_ALIGNMENT, &UnpackAlignment );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
     // Enable automatic mipmap generation
     if( AutoGen )
     {
@@ -588,26 +2094,43 @@ GLFWAPI int  GLFWAPIENTRY glfwLoadTextureImage2D( GLFWimage *img, int flags )
     // Format specification is different for OpenGL 1.0
     if( _glfwWin.glMajor == 1 && _glfwWin.glMinor == 0 )
     {
+        internalformat = img->BytesPerPixel;
         format = img->BytesPerPixel;
+        type = GL_UNSIGNED_BYTE;
     }
     else
     {
-        format = img->Format;
+        _glfwGetUploadFormat( packformat ? packformat : pixelformat,
+                         &internalformat, &format, &type );
+    }
+
+    if( compressedformat )
+    {
+        internalformat = compressedformat;
     }
 
     // Upload to texture memeory
     level = 0;
     do
     {
+        data = img->Data;
+
+        // Pack this mipmap level, if required
+        if( packformat )
+        {
+            _glfwConvertPixels( img, packed, packformat,
+                           flags & GLFW_DITHER_BIT );
+            data = packed;
+        }
+
         // Upload this mipmap level
-        glTexImage2D( GL_TEXTURE_2D, level, format,
-            img->Width, img->Height, 0, format,
-            GL_UNSIGNED_BYTE, (void*) img->Data );
+        glTexImage2D( GL_TEXTURE_2D, level, internalformat,
+            img->Width, img->Height, 0, format, type, (void*) data );
 
         // Build next mipmap level manually, if required
         if( ( flags & GLFW_BUILD_MIPMAPS_BIT ) && !AutoGen )
         {
-            level = HalveImage( img->Data, &img->Width,
+            level = _glfwHalveImage( img->Data, &img->Width,
                         &img->Height, img->BytesPerPixel ) ?
                     level + 1 : 0;
         }
@@ -624,5 +2147,155 @@ GLFWAPI int  GLFWAPIENTRY glfwLoadTextureImage2D( GLFWimage *img, int flags )
     // Restore old unpack alignment
     glPixelStorei( GL_UNPACK_ALIGNMENT, UnpackAlignment );
 
+    if( packed )
+    {
+        _glfwFreePixels( packed );
+    }
+
     return GL_TRUE;
 }
+
+
+//========================================================================
+// Set the memory budget of the texture cache (released textures are
+// deleted, least recently used first, while the cache exceeds it)
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwSetTextureCacheSize( long bytes )
+{
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return;
+    }
+
+    _glfwTexCache.budget = bytes > 0 ? bytes : 0;
+
+    if( _glfwWin.opened )
+    {
+        TrimTextureCache();
+    }
+}
+
+
+//========================================================================
+// Load a texture from a file into a shared texture object, and return its
+// name (the texture is left bound to GL_TEXTURE_2D)
+//========================================================================
+
+GLFWAPI GLuint GLFWAPIENTRY glfwLoadCachedTexture2D( const char *name,
+    int flags )
+{
+    struct stat info;
+    GLuint    texture;
+    GLFWimage img;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwWin.opened )
+    {
+        return 0;
+    }
+
+    // Force rescaling if necessary
+    if( !_glfwWin.has_GL_ARB_texture_non_power_of_two )
+    {
+        flags &= (~GLFW_NO_RESCALE_BIT);
+    }
+
+    // The modification time tells us whether the file has changed
+    if( stat( name, &info ) != 0 )
+    {
+        return 0;
+    }
+
+    texture = FindCachedTexture( name, NULL, (long) info.st_size,
+                                 (long) info.st_mtime, flags );
+    if( texture )
+    {
+        return texture;
+    }
+
+    if( !glfwReadImage( name, &img, flags ) )
+    {
+        return 0;
+    }
+
+    return AddCachedTexture( &img, name, NULL, (long) info.st_size,
+                             (long) info.st_mtime, flags );
+}
+
+
+//========================================================================
+// Load a texture from a buffer into a shared texture object, and return
+// its name (the texture is left bound to GL_TEXTURE_2D)
+//========================================================================
+
+GLFWAPI GLuint GLFWAPIENTRY glfwLoadCachedMemoryTexture2D( const void *data,
+    long size, int flags )
+{
+    unsigned int hash[ 2 ];
+    GLuint    texture;
+    GLFWimage img;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwWin.opened )
+    {
+        return 0;
+    }
+
+    // Force rescaling if necessary
+    if( !_glfwWin.has_GL_ARB_texture_non_power_of_two )
+    {
+        flags &= (~GLFW_NO_RESCALE_BIT);
+    }
+
+    _glfwHashData( data, size, hash );
+
+    texture = FindCachedTexture( NULL, hash, size, 0, flags );
+    if( texture )
+    {
+        return texture;
+    }
+
+    if( !glfwReadMemoryImage( data, size, &img, flags ) )
+    {
+        return 0;
+    }
+
+    return AddCachedTexture( &img, NULL, hash, size, 0, flags );
+}
+
+
+//========================================================================
+// Release a texture returned by glfwLoadCached[Memory]Texture2D
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwReleaseCachedTexture( GLuint texture )
+{
+    _GLFWtexentry *entry;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwWin.opened )
+    {
+        return;
+    }
+
+    if( _glfwTexCache.indexSize == 0 )
+    {
+        return;
+    }
+
+    for( entry = *GetNameBucket( texture ); entry; entry = entry->nameNext )
+    {
+        if( entry->texture == texture )
+        {
+            if( entry->refCount > 0 )
+            {
+                entry->refCount --;
+            }
+            break;
+        }
+    }
+
+    TrimTextureCache();
+}
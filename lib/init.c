@@ -51,6 +51,9 @@ GLFWAPI int GLFWAPIENTRY glfwInit( void )
     memset( &_glfwLibrary, 0, sizeof( _glfwLibrary ) );
     memset( &_glfwWin, 0, sizeof( _glfwWin ) );
 
+    // Threads left over from a previous session were freed on termination
+    memset( _glfwThrd.Buckets, 0, sizeof( _glfwThrd.Buckets ) );
+
     // Window is not yet opened
     _glfwWin.opened = GL_FALSE;
 
@@ -69,6 +72,9 @@ GLFWAPI int GLFWAPIENTRY glfwInit( void )
     // Form now on, GLFW state is valid
     _glfwInitialized = GL_TRUE;
 
+    // The pixel buffer pool needs the thread API
+    _glfwInitImagePool();
+
     return GL_TRUE;
 }
 
@@ -86,12 +92,26 @@ GLFWAPI void GLFWAPIENTRY glfwTerminate( void )
         return;
     }
 
+    // Stop the texture loader and capture writer threads
+    _glfwTerminateResidency();
+    _glfwTerminateCapture();
+
+    // Free the pixel buffers kept for reuse
+    _glfwTerminateImagePool();
+
     // Platform specific termination
     if( !_glfwPlatformTerminate() )
     {
         return;
     }
 
+    // Forget the texture cache directory
+    if( _glfwTexCache.diskPath )
+    {
+        _glfwFree( _glfwTexCache.diskPath );
+        _glfwTexCache.diskPath = NULL;
+    }
+
     // GLFW is no longer initialized
     _glfwInitialized = GL_FALSE;
 }
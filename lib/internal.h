@@ -51,10 +51,19 @@
 #define GLFW_STICK 2
 
 
+//========================================================================
+// Thread handling definitions
+//========================================================================
+
+// Number of buckets in the thread ID hash table (must be a power of two)
+#define _GLFW_THREAD_BUCKETS 64
+
+
 //========================================================================
 // System independent include files
 //========================================================================
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -158,6 +167,161 @@ typedef struct {
 } _GLFWstream;
 
 
+//------------------------------------------------------------------------
+// Texture cache entry (for glfwLoadCachedTexture2D)
+//------------------------------------------------------------------------
+typedef struct _GLFWtexentry_struct _GLFWtexentry;
+struct _GLFWtexentry_struct {
+    _GLFWtexentry *previous;    // Previous entry (more recently used)
+    _GLFWtexentry *next;        // Next entry (less recently used)
+    _GLFWtexentry *keyNext;     // Next entry in the same key bucket
+    _GLFWtexentry *nameNext;    // Next entry in the same name bucket
+    unsigned int  key;          // Hash of the source and flags
+    char          *path;        // File name, or NULL for memory images
+    unsigned int  hash[ 2 ];    // Content hash of memory images
+    long          size;         // Memory image size
+    long          mtime;        // File modification time
+    int           flags;        // Flags passed when loading
+    GLuint        texture;      // OpenGL texture name
+    int           refCount;     // Number of unreleased loads
+    long          bytes;        // Estimated texture memory use
+};
+
+
+//------------------------------------------------------------------------
+// Texture cache (an LRU list of loaded textures, indexed by source and
+// by texture name)
+//------------------------------------------------------------------------
+typedef struct {
+    _GLFWtexentry *first;       // Most recently used entry
+    _GLFWtexentry *last;        // Least recently used entry
+    _GLFWtexentry **keyIndex;   // Buckets of entries by source and flags
+    _GLFWtexentry **nameIndex;  // Buckets of entries by texture name
+    int           indexSize;    // Number of buckets (a power of two)
+    int           count;        // Number of entries
+    long          budget;       // Budget in bytes for all entries
+    long          bytes;        // Bytes used by all entries
+    char          *diskPath;    // Disk cache directory, or NULL
+} _GLFWtexcache;
+
+GLFWGLOBAL _GLFWtexcache _glfwTexCache;
+
+
+//------------------------------------------------------------------------
+// Resident texture (for glfwCreateResidentTexture)
+//------------------------------------------------------------------------
+typedef struct {
+    char          *name;        // Source file name, or NULL
+    GLFWimage     source;       // Decoded source image, if there is no file
+    int           flags;        // Flags passed when loading
+    GLuint        texture;      // OpenGL texture name, or 0 if evicted
+    long          bytes;        // Texture memory use while resident
+    int           lastFrame;    // Last frame the texture was used in
+    int           state;        // Background loading state
+    int           order;        // Background loading request order
+    GLFWimage     pending;      // Image decoded by the loader thread
+} _GLFWresident;
+
+
+//------------------------------------------------------------------------
+// Texture residency manager
+//------------------------------------------------------------------------
+typedef struct {
+    _GLFWresident **entries;    // Entries, indexed by handle - 1
+    int           count;        // Size of entry array
+    long          budget;       // Budget in bytes, or 0 for no limit
+    long          bytes;        // Bytes used by resident textures
+    int           frame;        // Current frame number
+    int           order;        // Next loading request order
+    GLFWthread    loader;       // Background loader thread, or 0
+    GLFWmutex     mutex;        // Protects loading state and pending images
+    GLFWcond      cond;         // Signalled when loads are requested
+    int           stop;         // Asks the loader thread to exit
+} _GLFWresidency;
+
+GLFWGLOBAL _GLFWresidency _glfwResidency;
+
+
+//------------------------------------------------------------------------
+// Framebuffer capture waiting to be written to disk
+//------------------------------------------------------------------------
+typedef struct _GLFWcapturejob {
+    struct _GLFWcapturejob *next;
+    char          *name;        // File name
+    int           flags;
+    GLFWimage     image;        // BGRA pixels, or 0 if not yet mapped
+} _GLFWcapturejob;
+
+
+//------------------------------------------------------------------------
+// Asynchronous framebuffer capture
+//------------------------------------------------------------------------
+#define _GLFW_CAPTURE_BUFFERS 3
+
+typedef struct {
+    GLuint          buffers[ _GLFW_CAPTURE_BUFFERS ]; // Readback buffers
+    _GLFWcapturejob *pending[ _GLFW_CAPTURE_BUFFERS ]; // Captures in them
+    int             next;       // Next readback buffer to use
+    _GLFWcapturejob *first;     // Captures waiting for the writer thread
+    _GLFWcapturejob *last;
+    int             writing;    // A capture is being written
+    GLFWthread      writer;     // Writer thread, or 0
+    GLFWmutex       mutex;      // Protects the writer queue
+    GLFWcond        cond;       // Signalled when the queue changes
+    int             stop;       // Asks the writer thread to exit
+} _GLFWcapture;
+
+GLFWGLOBAL _GLFWcapture _glfwCapture;
+
+
+//------------------------------------------------------------------------
+// User memory allocator (all members are NULL for the C library heap)
+//------------------------------------------------------------------------
+GLFWGLOBAL GLFWallocator _glfwAllocator;
+
+
+//------------------------------------------------------------------------
+// Memory usage counters, one per usage category plus one for the total
+// (updated with atomic operations)
+//------------------------------------------------------------------------
+typedef struct {
+    volatile long bytes;        // Bytes currently allocated
+    volatile long peak;         // Highest value of bytes
+    volatile long count;        // Blocks currently allocated
+    volatile long total;        // Blocks ever allocated
+} _GLFWmemcounter;
+
+GLFWGLOBAL _GLFWmemcounter _glfwMemUsage[ GLFW_MEMORY_USAGES + 1 ];
+
+
+//------------------------------------------------------------------------
+// Pixel buffer allocated by the image pool
+//------------------------------------------------------------------------
+typedef struct _GLFWpoolblock {
+    struct _GLFWpoolblock *next; // Next free buffer of the same class
+    void          *base;        // Start of the underlying allocation
+    size_t        size;         // Usable size of the buffer
+    int           sizeclass;    // Size class, or -1 if too large to keep
+} _GLFWpoolblock;
+
+
+//------------------------------------------------------------------------
+// Pool of freed pixel buffers
+//------------------------------------------------------------------------
+#define _GLFW_POOL_CLASSES 32
+
+typedef struct {
+    _GLFWpoolblock *free[ _GLFW_POOL_CLASSES ]; // Free buffers per class
+    long          retained;     // Bytes in free buffers
+    long          limit;        // Maximum bytes in free buffers
+    void          **owned;      // Hash set of all buffers of the pool
+    int           ownedCount, ownedCapacity;
+    GLFWmutex     mutex;        // Protects the free lists and owned set
+} _GLFWimagepool;
+
+GLFWGLOBAL _GLFWimagepool _glfwImagePool;
+
+
 //========================================================================
 // Prototypes for platform specific implementation functions
 //========================================================================
@@ -184,8 +348,9 @@ int _glfwPlatformGetJoystickPos( int joy, float *pos, int numaxes );
 int _glfwPlatformGetJoystickButtons( int joy, unsigned char *buttons, int numbuttons );
 
 // Threads
-GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg );
+GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg, const GLFWthreadattr *attr );
 void _glfwPlatformDestroyThread( GLFWthread ID );
+int _glfwPlatformSetThreadAffinity( GLFWthread ID, const GLFWcpumask *mask );
 int _glfwPlatformWaitThread( GLFWthread ID, int waitmode );
 GLFWthread _glfwPlatformGetThreadID( void );
 GLFWmutex _glfwPlatformCreateMutex( void );
@@ -194,10 +359,20 @@ void _glfwPlatformLockMutex( GLFWmutex mutex );
 void _glfwPlatformUnlockMutex( GLFWmutex mutex );
 GLFWcond _glfwPlatformCreateCond( void );
 void _glfwPlatformDestroyCond( GLFWcond cond );
-void _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex, double timeout );
+int  _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex, double timeout );
 void _glfwPlatformSignalCond( GLFWcond cond );
 void _glfwPlatformBroadcastCond( GLFWcond cond );
+#if defined( _GLFW_HAS_STATIC_SYNC )
+void _glfwPlatformLockStaticMutex( GLFWstaticmutex *mutex );
+void _glfwPlatformUnlockStaticMutex( GLFWstaticmutex *mutex );
+int  _glfwPlatformWaitStaticCond( GLFWstaticcond *cond, GLFWstaticmutex *mutex, double timeout );
+void _glfwPlatformSignalStaticCond( GLFWstaticcond *cond );
+void _glfwPlatformBroadcastStaticCond( GLFWstaticcond *cond );
+#endif
 int _glfwPlatformGetNumberOfProcessors( void );
+int _glfwPlatformGetProcessorTopology( GLFWtopology *topology );
+long _glfwPlatformAtomicAdd( volatile long *value, long delta );
+long _glfwPlatformAtomicCompareSwap( volatile long *value, long expected, long desired );
 
 // Time
 double _glfwPlatformGetTime( void );
@@ -254,8 +429,53 @@ long _glfwTellStream( _GLFWstream *stream );
 int _glfwSeekStream( _GLFWstream *stream, long offset, int whence );
 void _glfwCloseStream( _GLFWstream *stream );
 
+// Image processing (image.c)
+int _glfwHalveImage( GLubyte *src, int *width, int *height, int components );
+int _glfwGetPixelFormat( const GLFWimage *img );
+int _glfwGetPixelFormatSize( int format, int *glformat );
+int _glfwConvertPixels( const GLFWimage *img, unsigned char *dst, int format, int flags );
+void _glfwGetUploadFormat( int pixelformat, GLint *internalformat, GLenum *format, GLenum *type );
+int _glfwGetCommonPixelFormat( const GLFWimage *images, int count );
+int _glfwGetPackFormat( int pixelformat, int flags );
+void _glfwClearTextureCache( void );
+void _glfwHashData( const void *data, long size, unsigned int *hash );
+
+// Disk texture cache (diskcache.c)
+int _glfwLoadFileTexture( const char *name, int flags );
+int _glfwLoadDiskCachedTexture( const void *data, long size, int flags );
+void _glfwStoreDiskCachedTexture( const void *data, long size, int flags );
+
+// Thread pools (threadpool.c)
+void _glfwSubmitPoolJob( GLFWthreadpool pool, GLFWjobfun fun, void *arg, volatile long *pending );
+void _glfwWaitPoolJobs( GLFWthreadpool pool, volatile long *pending );
+
+// Processor topology (topology.c)
+int _glfwGetCoreCount( void );
+
+// Texture residency (residency.c)
+void _glfwEvictResidentTextures( void );
+void _glfwTerminateResidency( void );
+
+// Memory management (memory.c)
+void * _glfwMallocAligned( size_t size, size_t alignment, int usage );
+void * _glfwMallocAs( size_t size, int usage );
+void * _glfwCallocAs( size_t count, size_t size, int usage );
+void * _glfwMalloc( size_t size );
+void * _glfwCalloc( size_t count, size_t size );
+void * _glfwRealloc( void *ptr, size_t size );
+void _glfwFree( void *ptr );
+void _glfwInitImagePool( void );
+void _glfwTerminateImagePool( void );
+void * _glfwAllocPixels( size_t size );
+void _glfwFreePixels( void *ptr );
+
+// Framebuffer capture (capture.c)
+void _glfwFlushCaptures( void );
+void _glfwTerminateCapture( void );
+
 // Targa image I/O (tga.c)
 int _glfwReadTGA( _GLFWstream *s, GLFWimage *img, int flags );
+int _glfwWriteTGA( FILE *file, const GLFWimage *img, int flags );
 
 // Framebuffer configs
 const _GLFWfbconfig *_glfwChooseFBConfig( const _GLFWfbconfig *desired,
@@ -0,0 +1,765 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+//========================================================================
+// Description:
+//
+// This module routes all library allocations through the user allocator,
+// if one has been set, and keeps freed pixel buffers for reuse, so that
+// loading one image after another does not keep returning memory to the
+// heap and faulting it back in.
+//
+// Every block carries a small header with its size and usage category,
+// so that the memory held by GLFW can be accounted for per category
+// without locking.
+//
+// Buffers are rounded up to size classes, two per power of two, and
+// freed buffers are kept on a free list per class until the retained
+// total would exceed a limit. Buffers are aligned for SIMD access, and
+// large buffers to whole pages.
+//
+// Image data may also have been allocated by the application, so the
+// pool keeps a set of the buffers it owns. Anything else is released
+// with free(), as GLFW has always done with image data.
+//
+//========================================================================
+
+
+#include "internal.h"
+
+
+// Alignment requested for ordinary allocations
+#define _GLFW_DEFAULT_ALIGN  16
+
+// Largest alignment that _glfwMallocAligned supports
+#define _GLFW_MAX_ALIGN      32768
+
+// Alignment of all pixel buffers
+#define _GLFW_POOL_ALIGN     64
+
+// Size from which buffers are aligned to pages
+#define _GLFW_POOL_PAGE      4096
+
+// Default limit of retained bytes
+#define _GLFW_POOL_DEFAULT_LIMIT ( 64L * 1024 * 1024 )
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+//========================================================================
+// Header placed right before every block, recording what to account for
+// it and where the allocation it was carved from starts
+//========================================================================
+
+typedef union {
+    struct {
+        size_t         size;      // Requested size of the block
+        int            usage;     // Usage category (GLFW_MEMORY_*)
+        unsigned short offset;    // Distance from the allocation start
+        unsigned short alignment; // Alignment of the block
+    } info;
+    double align[ 2 ];            // Keeps the block malloc() aligned
+} _GLFWmemheader;
+
+
+//========================================================================
+// Add a change in allocated bytes and blocks to a counter
+//========================================================================
+
+static void CountUsage( _GLFWmemcounter *counter, long bytes, long count )
+{
+    long current, peak;
+
+    current = _glfwPlatformAtomicAdd( &counter->bytes, bytes );
+    _glfwPlatformAtomicAdd( &counter->count, count );
+
+    if( count > 0 )
+    {
+        _glfwPlatformAtomicAdd( &counter->total, count );
+    }
+
+    // Raise the peak, unless another thread raised it further
+    peak = counter->peak;
+    while( current > peak )
+    {
+        peak = _glfwPlatformAtomicCompareSwap( &counter->peak, peak,
+                                               current );
+    }
+}
+
+
+//========================================================================
+// Account for a block being allocated or freed
+//========================================================================
+
+static void AddUsage( int usage, long bytes, long count )
+{
+    CountUsage( &_glfwMemUsage[ usage ], bytes, count );
+    CountUsage( &_glfwMemUsage[ GLFW_MEMORY_USAGES ], bytes, count );
+}
+
+
+//========================================================================
+// Allocate memory for a usage category, aligned to a power of two of up
+// to 32 KB. Only malloc() alignment is relied on, so larger alignments
+// are reached by padding the header
+//========================================================================
+
+void * _glfwMallocAligned( size_t size, size_t alignment, int usage )
+{
+    _GLFWmemheader *header;
+    unsigned char  *base, *ptr;
+    size_t         padding;
+
+    if( alignment < _GLFW_DEFAULT_ALIGN )
+    {
+        alignment = _GLFW_DEFAULT_ALIGN;
+    }
+    if( alignment > _GLFW_MAX_ALIGN || ( alignment & ( alignment - 1 ) ) )
+    {
+        return NULL;
+    }
+    padding = alignment > _GLFW_DEFAULT_ALIGN ? alignment - 1 : 0;
+
+    if( _glfwAllocator.Alloc )
+    {
+        base = (unsigned char *)
+            _glfwAllocator.Alloc( sizeof( _GLFWmemheader ) + padding + size,
+                                  alignment, _glfwAllocator.User );
+    }
+    else
+    {
+        base = (unsigned char *)
+            malloc( sizeof( _GLFWmemheader ) + padding + size );
+    }
+
+    if( base == NULL )
+    {
+        return NULL;
+    }
+
+    ptr = base + sizeof( _GLFWmemheader ) + padding;
+    ptr -= (size_t) ptr & ( alignment - 1 );
+
+    header = ( (_GLFWmemheader *) ptr ) - 1;
+    header->info.size      = size;
+    header->info.usage     = usage;
+    header->info.offset    = (unsigned short) ( ptr - base );
+    header->info.alignment = (unsigned short) alignment;
+    AddUsage( usage, (long) size, 1 );
+
+    return (void *) ptr;
+}
+
+
+//========================================================================
+// Allocate memory for a usage category
+//========================================================================
+
+void * _glfwMallocAs( size_t size, int usage )
+{
+    return _glfwMallocAligned( size, _GLFW_DEFAULT_ALIGN, usage );
+}
+
+
+//========================================================================
+// Allocate zeroed memory for a usage category
+//========================================================================
+
+void * _glfwCallocAs( size_t count, size_t size, int usage )
+{
+    void *ptr;
+
+    ptr = _glfwMallocAs( count * size, usage );
+    if( ptr )
+    {
+        memset( ptr, 0, count * size );
+    }
+
+    return ptr;
+}
+
+
+//========================================================================
+// Allocate memory not belonging to any particular category
+//========================================================================
+
+void * _glfwMalloc( size_t size )
+{
+    return _glfwMallocAs( size, GLFW_MEMORY_OTHER );
+}
+
+
+//========================================================================
+// Allocate zeroed memory not belonging to any particular category
+//========================================================================
+
+void * _glfwCalloc( size_t count, size_t size )
+{
+    return _glfwCallocAs( count, size, GLFW_MEMORY_OTHER );
+}
+
+
+//========================================================================
+// Resize memory, keeping its usage category
+//========================================================================
+
+void * _glfwRealloc( void *ptr, size_t size )
+{
+    _GLFWmemheader *header;
+    size_t         oldsize;
+    void           *copy;
+
+    if( ptr == NULL )
+    {
+        return _glfwMalloc( size );
+    }
+
+    header  = ( (_GLFWmemheader *) ptr ) - 1;
+    oldsize = header->info.size;
+
+    // The padding before an over-aligned block depends on its address,
+    // so such blocks are moved by hand
+    if( header->info.alignment > _GLFW_DEFAULT_ALIGN )
+    {
+        copy = _glfwMallocAligned( size, header->info.alignment,
+                                   header->info.usage );
+        if( copy == NULL )
+        {
+            return NULL;
+        }
+
+        memcpy( copy, ptr, oldsize < size ? oldsize : size );
+        _glfwFree( ptr );
+        return copy;
+    }
+
+    if( _glfwAllocator.Realloc )
+    {
+        header = (_GLFWmemheader *)
+            _glfwAllocator.Realloc( header, sizeof( _GLFWmemheader ) + size,
+                                    _GLFW_DEFAULT_ALIGN,
+                                    _glfwAllocator.User );
+    }
+    else
+    {
+        header = (_GLFWmemheader *)
+            realloc( header, sizeof( _GLFWmemheader ) + size );
+    }
+
+    if( header == NULL )
+    {
+        return NULL;
+    }
+
+    header->info.size = size;
+    AddUsage( header->info.usage, (long) size - (long) oldsize, 0 );
+
+    return (void *) ( header + 1 );
+}
+
+
+//========================================================================
+// Free memory allocated by any of the functions above
+//========================================================================
+
+void _glfwFree( void *ptr )
+{
+    _GLFWmemheader *header;
+
+    if( ptr == NULL )
+    {
+        return;
+    }
+
+    header = ( (_GLFWmemheader *) ptr ) - 1;
+    AddUsage( header->info.usage, -(long) header->info.size, -1 );
+
+    ptr = (unsigned char *) ptr - header->info.offset;
+
+    if( _glfwAllocator.Free )
+    {
+        _glfwAllocator.Free( ptr, _glfwAllocator.User );
+        return;
+    }
+
+    free( ptr );
+}
+
+
+//========================================================================
+// Size of the buffers in a size class (4 KB, 6 KB, 8 KB, 12 KB, ...)
+//========================================================================
+
+static size_t GetClassSize( int sizeclass )
+{
+    return (size_t) ( 2 + ( sizeclass & 1 ) ) << ( 11 + sizeclass / 2 );
+}
+
+
+//========================================================================
+// Find the smallest size class that fits a size, or -1 if none does
+//========================================================================
+
+static int GetSizeClass( size_t size )
+{
+    int sizeclass;
+
+    for( sizeclass = 0; sizeclass < _GLFW_POOL_CLASSES; sizeclass ++ )
+    {
+        if( GetClassSize( sizeclass ) >= size )
+        {
+            return sizeclass;
+        }
+    }
+
+    return -1;
+}
+
+
+//========================================================================
+// Hash a buffer address into the owned set
+//========================================================================
+
+static int HashBuffer( void *ptr )
+{
+    // Buffers are at least pool aligned, so the low bits carry nothing
+    return (int) ( ( (size_t) ptr / _GLFW_POOL_ALIGN ) * 2654435761u &
+                   (size_t) ( _glfwImagePool.ownedCapacity - 1 ) );
+}
+
+
+//========================================================================
+// Find a buffer in the owned set, returning its slot or -1 (the pool must
+// be locked)
+//========================================================================
+
+static int FindOwned( void *ptr )
+{
+    int i;
+
+    if( _glfwImagePool.ownedCount == 0 )
+    {
+        return -1;
+    }
+
+    for( i = HashBuffer( ptr ); _glfwImagePool.owned[ i ];
+         i = ( i + 1 ) & ( _glfwImagePool.ownedCapacity - 1 ) )
+    {
+        if( _glfwImagePool.owned[ i ] == ptr )
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
+//========================================================================
+// Find the empty slot a buffer goes into in the owned set (the pool must
+// be locked)
+//========================================================================
+
+static int FindFreeSlot( void *ptr )
+{
+    int i;
+
+    for( i = HashBuffer( ptr ); _glfwImagePool.owned[ i ];
+         i = ( i + 1 ) & ( _glfwImagePool.ownedCapacity - 1 ) )
+    {
+    }
+
+    return i;
+}
+
+
+//========================================================================
+// Add a buffer to the owned set (the pool must be locked)
+//========================================================================
+
+static int AddOwned( void *ptr )
+{
+    void **old;
+    int  i, capacity;
+
+    // Keep the set at most half full
+    if( ( _glfwImagePool.ownedCount + 1 ) * 2 >
+        _glfwImagePool.ownedCapacity )
+    {
+        old      = _glfwImagePool.owned;
+        capacity = _glfwImagePool.ownedCapacity;
+
+        _glfwImagePool.ownedCapacity = capacity ? capacity * 2 : 64;
+        _glfwImagePool.owned = (void **)
+            _glfwCallocAs( _glfwImagePool.ownedCapacity, sizeof( void * ),
+                           GLFW_MEMORY_IMAGE );
+        if( _glfwImagePool.owned == NULL )
+        {
+            _glfwImagePool.owned         = old;
+            _glfwImagePool.ownedCapacity = capacity;
+            return GL_FALSE;
+        }
+
+        for( i = 0; i < capacity; i ++ )
+        {
+            if( old[ i ] )
+            {
+                _glfwImagePool.owned[ FindFreeSlot( old[ i ] ) ] = old[ i ];
+            }
+        }
+        _glfwFree( old );
+    }
+
+    _glfwImagePool.owned[ FindFreeSlot( ptr ) ] = ptr;
+    _glfwImagePool.ownedCount ++;
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Remove a buffer from the owned set, moving later entries of the same
+// probe sequence back into the gap (the pool must be locked)
+//========================================================================
+
+static void RemoveOwned( int slot )
+{
+    int i, j, home, mask;
+
+    mask = _glfwImagePool.ownedCapacity - 1;
+    i = slot;
+    for( j = ( i + 1 ) & mask; _glfwImagePool.owned[ j ];
+         j = ( j + 1 ) & mask )
+    {
+        // An entry may fill the gap unless its home slot lies
+        // cyclically between the gap and itself
+        home = HashBuffer( _glfwImagePool.owned[ j ] );
+        if( ( ( j - home ) & mask ) >= ( ( j - i ) & mask ) )
+        {
+            _glfwImagePool.owned[ i ] = _glfwImagePool.owned[ j ];
+            i = j;
+        }
+    }
+
+    _glfwImagePool.owned[ i ] = NULL;
+    _glfwImagePool.ownedCount --;
+}
+
+
+//========================================================================
+// Free retained buffers, largest first, until at most limit bytes remain
+// (the pool must be locked)
+//========================================================================
+
+static void TrimPool( long limit )
+{
+    _GLFWpoolblock *block;
+    int            sizeclass;
+
+    for( sizeclass = _GLFW_POOL_CLASSES - 1; sizeclass >= 0; sizeclass -- )
+    {
+        while( _glfwImagePool.retained > limit &&
+               _glfwImagePool.free[ sizeclass ] )
+        {
+            block = _glfwImagePool.free[ sizeclass ];
+            _glfwImagePool.free[ sizeclass ] = block->next;
+            _glfwImagePool.retained -= (long) block->size;
+
+            RemoveOwned( FindOwned( (void *) ( block + 1 ) ) );
+            _glfwFree( block->base );
+        }
+    }
+}
+
+
+//========================================================================
+// Initialize the pixel buffer pool
+//========================================================================
+
+void _glfwInitImagePool( void )
+{
+    memset( &_glfwImagePool, 0, sizeof( _glfwImagePool ) );
+    _glfwImagePool.limit = _GLFW_POOL_DEFAULT_LIMIT;
+
+    // Without a mutex, buffers are simply not retained
+    _glfwImagePool.mutex = glfwCreateMutex();
+}
+
+
+//========================================================================
+// Free all retained buffers and the pool itself
+//========================================================================
+
+void _glfwTerminateImagePool( void )
+{
+    TrimPool( 0 );
+
+    // Buffers still in use are leaked rather than freed under the user
+    _glfwFree( _glfwImagePool.owned );
+
+    if( _glfwImagePool.mutex )
+    {
+        glfwDestroyMutex( _glfwImagePool.mutex );
+    }
+
+    memset( &_glfwImagePool, 0, sizeof( _glfwImagePool ) );
+}
+
+
+//========================================================================
+// Allocate a pixel buffer
+//========================================================================
+
+void * _glfwAllocPixels( size_t size )
+{
+    _GLFWpoolblock *block;
+    unsigned char  *base, *ptr;
+    size_t         align;
+    int            sizeclass;
+
+    // Without a pool, buffers are plain malloc() blocks, and are freed as
+    // such by _glfwFreePixels
+    if( !_glfwImagePool.mutex )
+    {
+        return malloc( size );
+    }
+
+    sizeclass = GetSizeClass( size );
+
+    // Reuse a retained buffer of the same class if there is one
+    if( sizeclass >= 0 )
+    {
+        glfwLockMutex( _glfwImagePool.mutex );
+        block = _glfwImagePool.free[ sizeclass ];
+        if( block )
+        {
+            _glfwImagePool.free[ sizeclass ] = block->next;
+            _glfwImagePool.retained -= (long) block->size;
+        }
+        glfwUnlockMutex( _glfwImagePool.mutex );
+
+        if( block )
+        {
+            return (void *) ( block + 1 );
+        }
+    }
+
+    if( sizeclass >= 0 )
+    {
+        size = GetClassSize( sizeclass );
+    }
+    align = size >= _GLFW_POOL_PAGE ? _GLFW_POOL_PAGE : _GLFW_POOL_ALIGN;
+
+    // The block header is placed right before the aligned buffer
+    base = (unsigned char *)
+        _glfwMallocAs( size + align + sizeof( _GLFWpoolblock ),
+                       GLFW_MEMORY_IMAGE );
+    if( base == NULL )
+    {
+        return NULL;
+    }
+    ptr = base + sizeof( _GLFWpoolblock ) + align - 1;
+    ptr -= (size_t) ptr % align;
+
+    block = ( (_GLFWpoolblock *) ptr ) - 1;
+    block->next      = NULL;
+    block->base      = base;
+    block->size      = size;
+    block->sizeclass = sizeclass;
+
+    glfwLockMutex( _glfwImagePool.mutex );
+    if( !AddOwned( (void *) ptr ) )
+    {
+        ptr = NULL;
+    }
+    glfwUnlockMutex( _glfwImagePool.mutex );
+
+    if( ptr == NULL )
+    {
+        _glfwFree( base );
+    }
+
+    return (void *) ptr;
+}
+
+
+//========================================================================
+// Free a pixel buffer, keeping it for reuse if the pool has room for it.
+// Buffers that the pool does not own, such as image data allocated by
+// the application, are released with free()
+//========================================================================
+
+void _glfwFreePixels( void *ptr )
+{
+    _GLFWpoolblock *block;
+    int            slot;
+
+    if( ptr == NULL )
+    {
+        return;
+    }
+
+    if( !_glfwImagePool.mutex )
+    {
+        free( ptr );
+        return;
+    }
+
+    block = ( (_GLFWpoolblock *) ptr ) - 1;
+
+    glfwLockMutex( _glfwImagePool.mutex );
+    slot = FindOwned( ptr );
+    if( slot < 0 )
+    {
+        block = NULL;
+    }
+    else if( block->sizeclass >= 0 &&
+             _glfwImagePool.retained + (long) block->size <=
+             _glfwImagePool.limit )
+    {
+        block->next = _glfwImagePool.free[ block->sizeclass ];
+        _glfwImagePool.free[ block->sizeclass ] = block;
+        _glfwImagePool.retained += (long) block->size;
+        ptr = NULL;
+    }
+    else
+    {
+        RemoveOwned( slot );
+    }
+    glfwUnlockMutex( _glfwImagePool.mutex );
+
+    if( block == NULL )
+    {
+        free( ptr );
+    }
+    else if( ptr != NULL )
+    {
+        _glfwFree( block->base );
+    }
+}
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Set the allocator used for all library memory (only possible while
+// GLFW is not initialized, so no block outlives its allocator)
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwSetAllocator( const GLFWallocator *allocator )
+{
+    // Is GLFW initialized?
+    if( _glfwInitialized )
+    {
+        return GL_FALSE;
+    }
+
+    if( allocator == NULL )
+    {
+        memset( &_glfwAllocator, 0, sizeof( _glfwAllocator ) );
+        return GL_TRUE;
+    }
+
+    if( !allocator->Alloc || !allocator->Realloc || !allocator->Free )
+    {
+        return GL_FALSE;
+    }
+
+    _glfwAllocator = *allocator;
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Set the maximum number of bytes kept in freed pixel buffers
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwSetImagePoolSize( long bytes )
+{
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwImagePool.mutex )
+    {
+        return;
+    }
+
+    glfwLockMutex( _glfwImagePool.mutex );
+    _glfwImagePool.limit = bytes > 0 ? bytes : 0;
+    TrimPool( _glfwImagePool.limit );
+    glfwUnlockMutex( _glfwImagePool.mutex );
+}
+
+
+//========================================================================
+// Free all pixel buffers kept for reuse
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwTrimImagePool( void )
+{
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwImagePool.mutex )
+    {
+        return;
+    }
+
+    glfwLockMutex( _glfwImagePool.mutex );
+    TrimPool( 0 );
+    glfwUnlockMutex( _glfwImagePool.mutex );
+}
+
+
+//========================================================================
+// Get the memory currently and at most held by GLFW, per usage category.
+// This may be called at any time, so that leaks can be checked for after
+// glfwTerminate
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwGetMemoryStats( GLFWmemstats *stats )
+{
+    GLFWmemusage *dst;
+    int          usage;
+
+    for( usage = 0; usage <= GLFW_MEMORY_USAGES; usage ++ )
+    {
+        dst = usage < GLFW_MEMORY_USAGES ? &stats->Usage[ usage ] :
+                                           &stats->Total;
+        dst->Bytes            = _glfwMemUsage[ usage ].bytes;
+        dst->PeakBytes        = _glfwMemUsage[ usage ].peak;
+        dst->Allocations      = _glfwMemUsage[ usage ].count;
+        dst->TotalAllocations = _glfwMemUsage[ usage ].total;
+    }
+
+    stats->PoolBytes = _glfwImagePool.retained;
+}
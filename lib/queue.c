@@ -0,0 +1,635 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+//========================================================================
+// Description:
+//
+// This module implements bounded lock-free queues of fixed size elements
+// on ring buffers, in two variants:
+//
+// Single-producer/single-consumer queues are a plain ring with a head
+// and a tail index. Each side keeps a private copy of the other's index
+// and only reads the shared one when the copy says the ring is full or
+// empty, so a batch costs one atomic operation.
+//
+// Multi-producer/multi-consumer queues follow Dmitry Vyukov's design:
+// every cell carries a sequence number telling which lap of the ring it
+// is ready for, and threads claim runs of ready cells with a single
+// compare-and-swap on the head or tail.
+//
+// In both, the producer and consumer indices live on separate cache
+// lines. Blocking calls poll for a while and then park on a condition
+// variable (a futex where available). Threads only touch the lock when
+// the count of parked threads shows that someone is asleep.
+//
+//========================================================================
+
+
+#include "internal.h"
+
+
+// Maximum capacity of a queue
+#define _GLFW_MAX_QUEUE_SIZE ( 1L << 24 )
+
+// Failed attempts of a blocking call before it parks
+#define _GLFW_QUEUE_SPIN 100
+
+// Cache line size, for keeping the two ends of a queue apart
+#define _GLFW_CACHE_LINE 64
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+//========================================================================
+// Cell of a multi-producer/multi-consumer queue. The element follows the
+// sequence number
+//========================================================================
+
+typedef struct {
+    volatile long sequence;     // Position the cell is ready for
+} _GLFWqueuecell;
+
+
+//========================================================================
+// Queue
+//========================================================================
+
+typedef struct {
+    // Producer side
+    volatile long tail;         // Next position to push to
+    long          headCache;    // Head last seen by the producer (SPSC)
+    char          pad1[ _GLFW_CACHE_LINE - 2 * sizeof( long ) ];
+
+    // Consumer side
+    volatile long head;         // Next position to pop from
+    long          tailCache;    // Tail last seen by the consumer (SPSC)
+    char          pad2[ _GLFW_CACHE_LINE - 2 * sizeof( long ) ];
+
+    volatile long waitingPushers;  // Threads parked or about to park
+    volatile long waitingPoppers;
+    int           mode;
+    long          capacity;     // Power of two
+    int           elemSize;
+    int           cellSize;
+    unsigned char *cells;
+    GLFWmutex     mutex;
+    GLFWcond      notFull;
+    GLFWcond      notEmpty;
+} _GLFWqueue;
+
+
+//========================================================================
+// Return the cell or element slot of a position
+//========================================================================
+
+static unsigned char * GetCell( _GLFWqueue *q, long pos )
+{
+    return q->cells + (size_t) ( pos & ( q->capacity - 1 ) ) * q->cellSize;
+}
+
+
+//========================================================================
+// Push up to count elements to a single-producer queue
+//========================================================================
+
+static int PushSPSC( _GLFWqueue *q, const unsigned char *data, int count )
+{
+    long tail, n, first, chunk;
+
+    tail = q->tail;
+    n = q->capacity - ( tail - q->headCache );
+    if( n < count )
+    {
+        // The atomic read also orders the read of the head before our
+        // writes to the cells it has freed
+        q->headCache = _glfwPlatformAtomicAdd( &q->head, 0 );
+        n = q->capacity - ( tail - q->headCache );
+    }
+    if( n > count )
+    {
+        n = count;
+    }
+    if( n == 0 )
+    {
+        return 0;
+    }
+
+    first = tail & ( q->capacity - 1 );
+    chunk = q->capacity - first;
+    if( chunk > n )
+    {
+        chunk = n;
+    }
+    memcpy( GetCell( q, tail ), data, chunk * q->elemSize );
+    memcpy( q->cells, data + chunk * q->elemSize,
+            ( n - chunk ) * q->elemSize );
+
+    // Publish the elements
+    _glfwPlatformAtomicAdd( &q->tail, n );
+
+    return (int) n;
+}
+
+
+//========================================================================
+// Pop up to count elements from a single-consumer queue
+//========================================================================
+
+static int PopSPSC( _GLFWqueue *q, unsigned char *data, int count )
+{
+    long head, n, first, chunk;
+
+    head = q->head;
+    n = q->tailCache - head;
+    if( n < count )
+    {
+        q->tailCache = _glfwPlatformAtomicAdd( &q->tail, 0 );
+        n = q->tailCache - head;
+    }
+    if( n > count )
+    {
+        n = count;
+    }
+    if( n == 0 )
+    {
+        return 0;
+    }
+
+    first = head & ( q->capacity - 1 );
+    chunk = q->capacity - first;
+    if( chunk > n )
+    {
+        chunk = n;
+    }
+    memcpy( data, GetCell( q, head ), chunk * q->elemSize );
+    memcpy( data + chunk * q->elemSize, q->cells,
+            ( n - chunk ) * q->elemSize );
+
+    // Hand the cells back to the producer
+    _glfwPlatformAtomicAdd( &q->head, n );
+
+    return (int) n;
+}
+
+
+//========================================================================
+// Push up to count elements to a multi-producer queue
+//========================================================================
+
+static int PushMPMC( _GLFWqueue *q, const unsigned char *data, int count )
+{
+    _GLFWqueuecell *cell;
+    long           pos, diff = 0;
+    int            n, i;
+
+    pos = q->tail;
+
+    for( ;; )
+    {
+        // Count the free cells in a row from our position
+        for( n = 0;  n < count;  n ++ )
+        {
+            cell = (_GLFWqueuecell *) GetCell( q, pos + n );
+            diff = cell->sequence - ( pos + n );
+            if( diff != 0 )
+            {
+                break;
+            }
+        }
+
+        if( n > 0 )
+        {
+            if( _glfwPlatformAtomicCompareSwap( &q->tail, pos,
+                                                pos + n ) == pos )
+            {
+                break;
+            }
+        }
+        else if( diff < 0 )
+        {
+            // The cell still holds an element from the last lap
+            return 0;
+        }
+
+        // Another producer got there first
+        pos = q->tail;
+    }
+
+    for( i = 0;  i < n;  i ++ )
+    {
+        cell = (_GLFWqueuecell *) GetCell( q, pos + i );
+        memcpy( cell + 1, data + i * q->elemSize, q->elemSize );
+
+        // Mark the cell as ready for consumers at this position
+        _glfwPlatformAtomicAdd( &cell->sequence, 1 );
+    }
+
+    return n;
+}
+
+
+//========================================================================
+// Pop up to count elements from a multi-consumer queue
+//========================================================================
+
+static int PopMPMC( _GLFWqueue *q, unsigned char *data, int count )
+{
+    _GLFWqueuecell *cell;
+    long           pos, diff = 0;
+    int            n, i;
+
+    pos = q->head;
+
+    for( ;; )
+    {
+        // Count the filled cells in a row from our position
+        for( n = 0;  n < count;  n ++ )
+        {
+            cell = (_GLFWqueuecell *) GetCell( q, pos + n );
+            diff = cell->sequence - ( pos + n + 1 );
+            if( diff != 0 )
+            {
+                break;
+            }
+        }
+
+        if( n > 0 )
+        {
+            if( _glfwPlatformAtomicCompareSwap( &q->head, pos,
+                                                pos + n ) == pos )
+            {
+                break;
+            }
+        }
+        else if( diff < 0 )
+        {
+            // The cell has not been filled yet
+            return 0;
+        }
+
+        // Another consumer got there first
+        pos = q->head;
+    }
+
+    for( i = 0;  i < n;  i ++ )
+    {
+        cell = (_GLFWqueuecell *) GetCell( q, pos + i );
+        memcpy( data + i * q->elemSize, cell + 1, q->elemSize );
+
+        // Mark the cell as ready for producers on the next lap
+        _glfwPlatformAtomicAdd( &cell->sequence, q->capacity - 1 );
+    }
+
+    return n;
+}
+
+
+//========================================================================
+// Check whether there is room to push, or something to pop
+//========================================================================
+
+static int CanPush( _GLFWqueue *q )
+{
+    _GLFWqueuecell *cell;
+    long           pos;
+
+    if( q->mode == GLFW_QUEUE_SPSC )
+    {
+        return q->tail - _glfwPlatformAtomicAdd( &q->head, 0 ) < q->capacity;
+    }
+
+    pos  = _glfwPlatformAtomicAdd( &q->tail, 0 );
+    cell = (_GLFWqueuecell *) GetCell( q, pos );
+    return cell->sequence - pos >= 0;
+}
+
+static int CanPop( _GLFWqueue *q )
+{
+    _GLFWqueuecell *cell;
+    long           pos;
+
+    if( q->mode == GLFW_QUEUE_SPSC )
+    {
+        return _glfwPlatformAtomicAdd( &q->tail, 0 ) != q->head;
+    }
+
+    pos  = _glfwPlatformAtomicAdd( &q->head, 0 );
+    cell = (_GLFWqueuecell *) GetCell( q, pos );
+    return cell->sequence - ( pos + 1 ) >= 0;
+}
+
+
+//========================================================================
+// Wake the threads parked on one end of a queue, if any are parked
+//========================================================================
+
+static void WakeParked( _GLFWqueue *q, volatile long *waiting, GLFWcond cond )
+{
+    if( *waiting > 0 )
+    {
+        _glfwPlatformLockMutex( q->mutex );
+        _glfwPlatformBroadcastCond( cond );
+        _glfwPlatformUnlockMutex( q->mutex );
+    }
+}
+
+
+//========================================================================
+// Park until there may be room to push or something to pop. Returns
+// GL_FALSE if the deadline passed
+//========================================================================
+
+static int Park( _GLFWqueue *q, int push, double deadline )
+{
+    volatile long *waiting;
+    GLFWcond      cond;
+    double        timeout = GLFW_INFINITY;
+    int           ready, result = GL_TRUE;
+
+    if( deadline < GLFW_INFINITY )
+    {
+        timeout = deadline - _glfwPlatformGetTime();
+        if( timeout <= 0.0 )
+        {
+            return GL_FALSE;
+        }
+    }
+
+    waiting = push ? &q->waitingPushers : &q->waitingPoppers;
+    cond    = push ? q->notFull : q->notEmpty;
+
+    // Announce that we are about to park before looking a last time, so
+    // that a thread changing the queue after that look will wake us up
+    _glfwPlatformLockMutex( q->mutex );
+    _glfwPlatformAtomicAdd( waiting, 1 );
+    ready = push ? CanPush( q ) : CanPop( q );
+    if( !ready )
+    {
+        result = _glfwPlatformWaitCond( cond, q->mutex, timeout );
+    }
+    _glfwPlatformAtomicAdd( waiting, -1 );
+    _glfwPlatformUnlockMutex( q->mutex );
+
+    return result;
+}
+
+
+//========================================================================
+// Free a queue and its synchronization objects
+//========================================================================
+
+static void FreeQueue( _GLFWqueue *q )
+{
+    if( q->mutex )
+    {
+        _glfwPlatformDestroyMutex( q->mutex );
+    }
+    if( q->notFull )
+    {
+        _glfwPlatformDestroyCond( q->notFull );
+    }
+    if( q->notEmpty )
+    {
+        _glfwPlatformDestroyCond( q->notEmpty );
+    }
+    _glfwFree( q->cells );
+    _glfwFree( q );
+}
+
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Create a queue holding at least capacity elements of elemsize bytes
+//========================================================================
+
+GLFWAPI GLFWqueue GLFWAPIENTRY glfwCreateQueue( int capacity, int elemsize,
+    int mode )
+{
+    _GLFWqueue     *q;
+    _GLFWqueuecell *cell;
+    long           size, i;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return NULL;
+    }
+
+    if( capacity < 1 || capacity > _GLFW_MAX_QUEUE_SIZE || elemsize < 1 ||
+        ( mode != GLFW_QUEUE_SPSC && mode != GLFW_QUEUE_MPMC ) )
+    {
+        return NULL;
+    }
+
+    q = (_GLFWqueue *) _glfwMallocAligned( sizeof( _GLFWqueue ),
+                                           _GLFW_CACHE_LINE,
+                                           GLFW_MEMORY_THREAD );
+    if( q == NULL )
+    {
+        return NULL;
+    }
+    memset( q, 0, sizeof( _GLFWqueue ) );
+
+    for( size = 1;  size < capacity;  size <<= 1 )
+    {
+    }
+
+    q->mode     = mode;
+    q->capacity = size;
+    q->elemSize = elemsize;
+    q->cellSize = elemsize;
+    if( mode == GLFW_QUEUE_MPMC )
+    {
+        // Keep the sequence numbers of all cells aligned
+        q->cellSize = sizeof( _GLFWqueuecell ) + elemsize;
+        q->cellSize = ( q->cellSize + sizeof( long ) - 1 ) &
+                      ~( (int) sizeof( long ) - 1 );
+    }
+
+    q->cells    = (unsigned char *) _glfwMallocAligned(
+                      (size_t) size * q->cellSize, _GLFW_CACHE_LINE,
+                      GLFW_MEMORY_THREAD );
+    q->mutex    = _glfwPlatformCreateMutex();
+    q->notFull  = _glfwPlatformCreateCond();
+    q->notEmpty = _glfwPlatformCreateCond();
+    if( !q->cells || !q->mutex || !q->notFull || !q->notEmpty )
+    {
+        FreeQueue( q );
+        return NULL;
+    }
+
+    if( mode == GLFW_QUEUE_MPMC )
+    {
+        for( i = 0;  i < size;  i ++ )
+        {
+            cell = (_GLFWqueuecell *) GetCell( q, i );
+            cell->sequence = i;
+        }
+    }
+
+    return (GLFWqueue) q;
+}
+
+
+//========================================================================
+// Destroy a queue
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwDestroyQueue( GLFWqueue queue )
+{
+    // Is GLFW initialized?
+    if( !_glfwInitialized || queue == NULL )
+    {
+        return;
+    }
+
+    FreeQueue( (_GLFWqueue *) queue );
+}
+
+
+//========================================================================
+// Push up to count elements to a queue, returning how many were pushed.
+// If timeout is positive, waits up to that long for room for all of them
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwPushQueue( GLFWqueue queue,
+    const void *elements, int count, double timeout )
+{
+    _GLFWqueue          *q = (_GLFWqueue *) queue;
+    const unsigned char *data = (const unsigned char *) elements;
+    double              deadline = GLFW_INFINITY;
+    int                 n, pushed = 0, fails = 0;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || q == NULL || data == NULL || count < 1 )
+    {
+        return 0;
+    }
+
+    if( timeout > 0.0 && timeout < GLFW_INFINITY )
+    {
+        deadline = _glfwPlatformGetTime() + timeout;
+    }
+
+    for( ;; )
+    {
+        if( q->mode == GLFW_QUEUE_SPSC )
+        {
+            n = PushSPSC( q, data + pushed * q->elemSize, count - pushed );
+        }
+        else
+        {
+            n = PushMPMC( q, data + pushed * q->elemSize, count - pushed );
+        }
+
+        if( n > 0 )
+        {
+            pushed += n;
+            fails = 0;
+            WakeParked( q, &q->waitingPoppers, q->notEmpty );
+        }
+
+        if( pushed == count || timeout <= 0.0 )
+        {
+            break;
+        }
+
+        if( ++ fails >= _GLFW_QUEUE_SPIN && !Park( q, GL_TRUE, deadline ) )
+        {
+            // Timed out, but have a last look
+            timeout = 0.0;
+        }
+    }
+
+    return pushed;
+}
+
+
+//========================================================================
+// Pop up to count elements from a queue, returning how many were popped.
+// If timeout is positive, waits up to that long for at least one
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwPopQueue( GLFWqueue queue, void *elements,
+    int count, double timeout )
+{
+    _GLFWqueue    *q = (_GLFWqueue *) queue;
+    unsigned char *data = (unsigned char *) elements;
+    double        deadline = GLFW_INFINITY;
+    int           popped, fails = 0;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || q == NULL || data == NULL || count < 1 )
+    {
+        return 0;
+    }
+
+    if( timeout > 0.0 && timeout < GLFW_INFINITY )
+    {
+        deadline = _glfwPlatformGetTime() + timeout;
+    }
+
+    for( ;; )
+    {
+        if( q->mode == GLFW_QUEUE_SPSC )
+        {
+            popped = PopSPSC( q, data, count );
+        }
+        else
+        {
+            popped = PopMPMC( q, data, count );
+        }
+
+        if( popped > 0 )
+        {
+            WakeParked( q, &q->waitingPushers, q->notFull );
+            break;
+        }
+
+        if( timeout <= 0.0 )
+        {
+            break;
+        }
+
+        if( ++ fails >= _GLFW_QUEUE_SPIN && !Park( q, GL_FALSE, deadline ) )
+        {
+            // Timed out, but have a last look
+            timeout = 0.0;
+        }
+    }
+
+    return popped;
+}
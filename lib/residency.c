@@ -0,0 +1,779 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+//========================================================================
+// Description:
+//
+// This module keeps the texture memory used by a set of textures within
+// a budget. Resident textures are created from a file name (reloaded
+// from the file, or from the disk cache if one is set) or from a decoded
+// image (which is kept in system memory).
+//
+// The application calls glfwUseResidentTexture whenever it draws with a
+// texture, and glfwUpdateResidency once per frame. When the budget is
+// exceeded, the least recently used textures are deleted. They are loaded
+// again when they are next used, or ahead of time by a background loader
+// thread when glfwPrefetchResidentTexture is called. There is no budget
+// until glfwSetTextureBudget is called.
+//
+//========================================================================
+
+
+#include "internal.h"
+
+
+// Texture parameters that may be missing from old OpenGL headers
+#ifndef GL_VERSION_1_3
+ #define GL_TEXTURE_COMPRESSED_IMAGE_SIZE 0x86A0
+ #define GL_TEXTURE_COMPRESSED            0x86A1
+#endif // GL_VERSION_1_3
+
+// Background loading states
+#define _GLFW_RESIDENT_IDLE      0
+#define _GLFW_RESIDENT_REQUESTED 1
+#define _GLFW_RESIDENT_LOADING   2
+#define _GLFW_RESIDENT_DECODED   3
+#define _GLFW_RESIDENT_DESTROYED 4
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+//========================================================================
+// Return the resident texture entry of a handle, or NULL
+//========================================================================
+
+static _GLFWresident *GetResident( int handle )
+{
+    if( handle < 1 || handle > _glfwResidency.count )
+    {
+        return NULL;
+    }
+
+    return _glfwResidency.entries[ handle - 1 ];
+}
+
+
+//========================================================================
+// Lock and unlock the state shared with the loader thread (if it exists)
+//========================================================================
+
+static void LockResidency( void )
+{
+    if( _glfwResidency.mutex )
+    {
+        glfwLockMutex( _glfwResidency.mutex );
+    }
+}
+
+static void UnlockResidency( void )
+{
+    if( _glfwResidency.mutex )
+    {
+        glfwUnlockMutex( _glfwResidency.mutex );
+    }
+}
+
+
+//========================================================================
+// Compute the memory used by all levels of the bound 2D texture
+//========================================================================
+
+static long GetTextureBytes( void )
+{
+    GLint  width, height, size, level, internalformat, compressed;
+    long   bytes;
+    int    bpp;
+
+    bytes = 0;
+    for( level = 0; ; level ++ )
+    {
+        glGetTexLevelParameteriv( GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH,
+                                  &width );
+        glGetTexLevelParameteriv( GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT,
+                                  &height );
+        if( width < 1 || height < 1 )
+        {
+            break;
+        }
+
+        compressed = GL_FALSE;
+        if( _glfwWin.has_GL_EXT_texture_compression_s3tc )
+        {
+            glGetTexLevelParameteriv( GL_TEXTURE_2D, level,
+                GL_TEXTURE_COMPRESSED, &compressed );
+        }
+
+        if( compressed )
+        {
+            glGetTexLevelParameteriv( GL_TEXTURE_2D, level,
+                GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size );
+            bytes += size;
+        }
+        else
+        {
+            glGetTexLevelParameteriv( GL_TEXTURE_2D, level,
+                GL_TEXTURE_INTERNAL_FORMAT, &internalformat );
+            switch( internalformat )
+            {
+                case 1:
+                case GL_LUMINANCE:
+                case GL_ALPHA:
+                    bpp = 1;
+                    break;
+                case 2:
+                case GL_LUMINANCE_ALPHA:
+                case GL_RGB5:
+                case GL_RGBA4:
+                case GL_RGB5_A1:
+                    bpp = 2;
+                    break;
+                default:
+                    bpp = 4;
+                    break;
+            }
+            bytes += (long) width * height * bpp;
+        }
+
+        if( width == 1 && height == 1 )
+        {
+            break;
+        }
+    }
+
+    return bytes;
+}
+
+
+//========================================================================
+// Delete the texture of a resident entry
+//========================================================================
+
+static void EvictResident( _GLFWresident *entry )
+{
+    if( entry->texture )
+    {
+        glDeleteTextures( 1, &entry->texture );
+        entry->texture = 0;
+        _glfwResidency.bytes -= entry->bytes;
+        entry->bytes = 0;
+    }
+}
+
+
+//========================================================================
+// Upload the texture of a resident entry, from the image decoded by the
+// loader thread if there is one, or else from its source
+//========================================================================
+
+static int LoadResident( _GLFWresident *entry )
+{
+    GLFWimage img;
+    int       success;
+
+    img.Data = NULL;
+    LockResidency();
+    if( entry->state == _GLFW_RESIDENT_DECODED )
+    {
+        img = entry->pending;
+        entry->pending.Data = NULL;
+    }
+    if( entry->state != _GLFW_RESIDENT_LOADING )
+    {
+        entry->state = _GLFW_RESIDENT_IDLE;
+    }
+    UnlockResidency();
+
+    glGenTextures( 1, &entry->texture );
+    glBindTexture( GL_TEXTURE_2D, entry->texture );
+
+    if( img.Data )
+    {
+        success = glfwLoadTextureImage2D( &img, entry->flags );
+        glfwFreeImage( &img );
+    }
+    else if( entry->name )
+    {
+        success = glfwLoadTexture2D( entry->name, entry->flags );
+    }
+    else
+    {
+        // Upload a copy, as the upload may convert the image in place
+        img = entry->source;
+        img.Data = (unsigned char *)
+            _glfwAllocPixels( img.Width * img.Height * img.BytesPerPixel );
+        success = img.Data != NULL;
+        if( success )
+        {
+            memcpy( img.Data, entry->source.Data,
+                    img.Width * img.Height * img.BytesPerPixel );
+            success = glfwLoadTextureImage2D( &img, entry->flags );
+            glfwFreeImage( &img );
+        }
+    }
+
+    if( !success )
+    {
+        glDeleteTextures( 1, &entry->texture );
+        entry->texture = 0;
+        return GL_FALSE;
+    }
+
+    entry->bytes = GetTextureBytes();
+    _glfwResidency.bytes += entry->bytes;
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Free a resident entry (the loader thread frees entries it is loading)
+//========================================================================
+
+static void FreeResident( _GLFWresident *entry )
+{
+    if( entry->name )
+    {
+        _glfwFree( entry->name );
+    }
+    if( entry->source.Data )
+    {
+        _glfwFreePixels( entry->source.Data );
+    }
+    if( entry->pending.Data )
+    {
+        _glfwFreePixels( entry->pending.Data );
+    }
+    _glfwFree( entry );
+}
+
+
+//========================================================================
+// Decode requested textures in the background (thread function)
+//========================================================================
+
+static void GLFWCALL LoaderThread( void *arg )
+{
+    _GLFWresident *entry;
+    GLFWimage     img;
+    int           n, success;
+
+    (void) arg;
+
+    glfwLockMutex( _glfwResidency.mutex );
+
+    while( !_glfwResidency.stop )
+    {
+        // Pick the oldest request
+        entry = NULL;
+        for( n = 0; n < _glfwResidency.count; n ++ )
+        {
+            if( _glfwResidency.entries[ n ] &&
+                _glfwResidency.entries[ n ]->state ==
+                    _GLFW_RESIDENT_REQUESTED &&
+                ( !entry ||
+                  _glfwResidency.entries[ n ]->order < entry->order ) )
+            {
+                entry = _glfwResidency.entries[ n ];
+            }
+        }
+
+        if( !entry )
+        {
+            glfwWaitCond( _glfwResidency.cond, _glfwResidency.mutex,
+                          GLFW_INFINITY );
+            continue;
+        }
+
+        entry->state = _GLFW_RESIDENT_LOADING;
+        glfwUnlockMutex( _glfwResidency.mutex );
+
+        success = glfwReadImage( entry->name, &img, entry->flags );
+
+        glfwLockMutex( _glfwResidency.mutex );
+
+        if( entry->state == _GLFW_RESIDENT_DESTROYED )
+        {
+            if( success )
+            {
+                _glfwFreePixels( img.Data );
+            }
+            FreeResident( entry );
+        }
+        else if( success )
+        {
+            entry->pending = img;
+            entry->state = _GLFW_RESIDENT_DECODED;
+        }
+        else
+        {
+            entry->state = _GLFW_RESIDENT_IDLE;
+        }
+    }
+
+    glfwUnlockMutex( _glfwResidency.mutex );
+}
+
+
+//========================================================================
+// Add a resident entry and return its handle
+//========================================================================
+
+static int AddResident( _GLFWresident *entry )
+{
+    _GLFWresident **entries;
+    int           n;
+
+    LockResidency();
+
+    // Find a free handle, or grow the entry array
+    for( n = 0; n < _glfwResidency.count; n ++ )
+    {
+        if( _glfwResidency.entries[ n ] == NULL )
+        {
+            break;
+        }
+    }
+
+    if( n == _glfwResidency.count )
+    {
+        entries = (_GLFWresident **) _glfwRealloc( _glfwResidency.entries,
+            ( _glfwResidency.count + 16 ) * sizeof( _GLFWresident * ) );
+        if( entries == NULL )
+        {
+            UnlockResidency();
+            return 0;
+        }
+
+        memset( entries + _glfwResidency.count, 0,
+                16 * sizeof( _GLFWresident * ) );
+        _glfwResidency.entries = entries;
+        _glfwResidency.count += 16;
+    }
+
+    _glfwResidency.entries[ n ] = entry;
+
+    UnlockResidency();
+
+    return n + 1;
+}
+
+
+//========================================================================
+// Delete the textures of all resident entries (called before the context
+// is destroyed)
+//========================================================================
+
+void _glfwEvictResidentTextures( void )
+{
+    int n;
+
+    for( n = 0; n < _glfwResidency.count; n ++ )
+    {
+        if( _glfwResidency.entries[ n ] )
+        {
+            EvictResident( _glfwResidency.entries[ n ] );
+        }
+    }
+}
+
+
+//========================================================================
+// Stop the loader thread and free all resident entries
+//========================================================================
+
+void _glfwTerminateResidency( void )
+{
+    int n;
+
+    if( _glfwResidency.loader > 0 )
+    {
+        glfwLockMutex( _glfwResidency.mutex );
+        _glfwResidency.stop = GL_TRUE;
+        glfwSignalCond( _glfwResidency.cond );
+        glfwUnlockMutex( _glfwResidency.mutex );
+
+        glfwWaitThread( _glfwResidency.loader, GLFW_WAIT );
+    }
+
+    if( _glfwResidency.mutex )
+    {
+        glfwDestroyMutex( _glfwResidency.mutex );
+    }
+    if( _glfwResidency.cond )
+    {
+        glfwDestroyCond( _glfwResidency.cond );
+    }
+
+    if( _glfwWin.opened )
+    {
+        _glfwEvictResidentTextures();
+    }
+
+    for( n = 0; n < _glfwResidency.count; n ++ )
+    {
+        if( _glfwResidency.entries[ n ] )
+        {
+            FreeResident( _glfwResidency.entries[ n ] );
+        }
+    }
+    _glfwFree( _glfwResidency.entries );
+
+    memset( &_glfwResidency, 0, sizeof( _glfwResidency ) );
+}
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Set the texture memory budget of the residency manager (zero means no
+// limit)
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwSetTextureBudget( long bytes )
+{
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return;
+    }
+
+    _glfwResidency.budget = bytes > 0 ? bytes : 0;
+}
+
+
+//========================================================================
+// Create a resident texture from an image file
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwCreateResidentTexture( const char *name,
+    int flags )
+{
+    _GLFWresident *entry;
+    int           handle;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return 0;
+    }
+
+    entry = (_GLFWresident *) _glfwCalloc( 1, sizeof( _GLFWresident ) );
+    if( entry == NULL )
+    {
+        return 0;
+    }
+
+    entry->name = (char *) _glfwMalloc( strlen( name ) + 1 );
+    if( entry->name == NULL )
+    {
+        _glfwFree( entry );
+        return 0;
+    }
+    strcpy( entry->name, name );
+
+    entry->flags     = flags;
+    entry->lastFrame = _glfwResidency.frame;
+
+    handle = AddResident( entry );
+    if( !handle )
+    {
+        FreeResident( entry );
+    }
+
+    return handle;
+}
+
+
+//========================================================================
+// Create a resident texture from a decoded image (the residency manager
+// takes over the image data)
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwCreateResidentTextureImage( GLFWimage *img,
+    int flags )
+{
+    _GLFWresident *entry;
+    int           handle;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return 0;
+    }
+
+    entry = (_GLFWresident *) _glfwCalloc( 1, sizeof( _GLFWresident ) );
+    if( entry == NULL )
+    {
+        return 0;
+    }
+
+    entry->source    = *img;
+    entry->flags     = flags;
+    entry->lastFrame = _glfwResidency.frame;
+
+    handle = AddResident( entry );
+    if( !handle )
+    {
+        _glfwFree( entry );
+        return 0;
+    }
+
+    img->Data = NULL;
+
+    return handle;
+}
+
+
+//========================================================================
+// Destroy a resident texture
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwDestroyResidentTexture( int handle )
+{
+    _GLFWresident *entry;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return;
+    }
+
+    entry = GetResident( handle );
+    if( entry == NULL )
+    {
+        return;
+    }
+
+    if( _glfwWin.opened )
+    {
+        EvictResident( entry );
+    }
+
+    LockResidency();
+
+    _glfwResidency.entries[ handle - 1 ] = NULL;
+
+    // An entry that is being decoded is freed by the loader thread
+    if( entry->state == _GLFW_RESIDENT_LOADING )
+    {
+        entry->state = _GLFW_RESIDENT_DESTROYED;
+        entry = NULL;
+    }
+
+    UnlockResidency();
+
+    if( entry )
+    {
+        FreeResident( entry );
+    }
+}
+
+
+//========================================================================
+// Make a resident texture resident (loading it if it was evicted), bind
+// it and mark it as used in the current frame
+//========================================================================
+
+GLFWAPI GLuint GLFWAPIENTRY glfwUseResidentTexture( int handle )
+{
+    _GLFWresident *entry;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwWin.opened )
+    {
+        return 0;
+    }
+
+    entry = GetResident( handle );
+    if( entry == NULL )
+    {
+        return 0;
+    }
+
+    entry->lastFrame = _glfwResidency.frame;
+
+    if( entry->texture )
+    {
+        glBindTexture( GL_TEXTURE_2D, entry->texture );
+        return entry->texture;
+    }
+
+    if( !LoadResident( entry ) )
+    {
+        return 0;
+    }
+
+    return entry->texture;
+}
+
+
+//========================================================================
+// Ask the loader thread to decode an evicted texture ahead of its use
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwPrefetchResidentTexture( int handle )
+{
+    _GLFWresident *entry;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return;
+    }
+
+    // Only textures loaded from files need decoding
+    entry = GetResident( handle );
+    if( entry == NULL || entry->texture || entry->name == NULL )
+    {
+        return;
+    }
+
+    // Start the loader thread the first time it is needed
+    if( !_glfwResidency.loader )
+    {
+        if( !_glfwResidency.mutex )
+        {
+            _glfwResidency.mutex = glfwCreateMutex();
+            _glfwResidency.cond  = glfwCreateCond();
+        }
+        if( !_glfwResidency.mutex || !_glfwResidency.cond )
+        {
+            return;
+        }
+
+        _glfwResidency.stop = GL_FALSE;
+        _glfwResidency.loader = glfwCreateThread( LoaderThread, NULL );
+        if( _glfwResidency.loader < 0 )
+        {
+            _glfwResidency.loader = 0;
+            return;
+        }
+    }
+
+    glfwLockMutex( _glfwResidency.mutex );
+    if( entry->state == _GLFW_RESIDENT_IDLE )
+    {
+        // Decode just like glfwLoadTexture2D would
+        if( _glfwWin.opened && !_glfwWin.has_GL_ARB_texture_non_power_of_two )
+        {
+            entry->flags &= (~GLFW_NO_RESCALE_BIT);
+        }
+
+        entry->state = _GLFW_RESIDENT_REQUESTED;
+        entry->order = _glfwResidency.order ++;
+        glfwSignalCond( _glfwResidency.cond );
+    }
+    glfwUnlockMutex( _glfwResidency.mutex );
+}
+
+
+//========================================================================
+// Finish the current frame: upload prefetched textures and evict the
+// least recently used textures until the budget is met
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwUpdateResidency( void )
+{
+    _GLFWresident *entry, *oldest;
+    int           n, decoded;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwWin.opened )
+    {
+        return;
+    }
+
+    // Upload textures that the loader thread has decoded
+    for( n = 0; n < _glfwResidency.count && _glfwResidency.mutex; n ++ )
+    {
+        entry = _glfwResidency.entries[ n ];
+        if( entry == NULL || entry->texture )
+        {
+            continue;
+        }
+
+        LockResidency();
+        decoded = entry->state == _GLFW_RESIDENT_DECODED;
+        UnlockResidency();
+
+        // Prefetched textures count as used in this frame
+        if( decoded )
+        {
+            entry->lastFrame = _glfwResidency.frame;
+            LoadResident( entry );
+        }
+    }
+
+    // Evict textures that were not used in this frame, oldest first
+    while( _glfwResidency.budget > 0 &&
+           _glfwResidency.bytes > _glfwResidency.budget )
+    {
+        oldest = NULL;
+        for( n = 0; n < _glfwResidency.count; n ++ )
+        {
+            entry = _glfwResidency.entries[ n ];
+            if( entry && entry->texture &&
+                entry->lastFrame != _glfwResidency.frame &&
+                ( !oldest || entry->lastFrame < oldest->lastFrame ) )
+            {
+                oldest = entry;
+            }
+        }
+
+        if( !oldest )
+        {
+            break;
+        }
+
+        EvictResident( oldest );
+    }
+
+    _glfwResidency.frame ++;
+}
+
+
+//========================================================================
+// Return the texture memory used by resident textures
+//========================================================================
+
+GLFWAPI long GLFWAPIENTRY glfwGetResidentBytes( void )
+{
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return 0;
+    }
+
+    return _glfwResidency.bytes;
+}
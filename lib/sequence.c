@@ -0,0 +1,643 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+//========================================================================
+// Description:
+//
+// This module plays back numbered image files (e.g. "shot%04d.tga") as
+// a texture.
+//
+// A worker thread reads ahead of the playback position into a ring of
+// decoded frames. The render thread never waits for it: each call to
+// glfwGetSequenceFrame uploads the frames that are ready (through
+// rotating pixel buffer objects, when available) into a small ring of
+// textures, and returns the newest texture that is not later than the
+// requested time.
+//
+//========================================================================
+
+
+#include "internal.h"
+
+
+// Pixel buffer object enums that may be missing from old OpenGL headers
+#ifndef GL_VERSION_1_5
+ #define GL_STREAM_DRAW         0x88E0
+ #define GL_WRITE_ONLY          0x88B9
+#endif // GL_VERSION_1_5
+
+#ifndef GL_VERSION_2_1
+ #define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif // GL_VERSION_2_1
+
+// Number of frames decoded ahead of the playback position
+#define _GLFW_SEQ_READAHEAD 6
+
+// Number of textures (and pixel buffer objects) frames are uploaded to
+#define _GLFW_SEQ_TEXTURES 3
+
+// Decoded frame states
+#define _GLFW_FRAME_FREE     0
+#define _GLFW_FRAME_DECODING 1
+#define _GLFW_FRAME_READY    2
+#define _GLFW_FRAME_FAILED   3
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+//========================================================================
+// Image sequence structures
+//========================================================================
+
+// Decoded frame
+typedef struct {
+    int           frame;
+    int           state;        // _GLFW_FRAME_* state
+    GLFWimage     image;
+} _GLFWseqframe;
+
+typedef struct {
+    char          *pattern;
+    int           first, length;
+    double        fps;
+    int           flags;
+
+    // Decoded frames, shared with the worker thread
+    _GLFWseqframe frames[ _GLFW_SEQ_READAHEAD ];
+    int           wanted;       // Playback position
+    int           stop;
+    GLFWmutex     mutex;
+    GLFWcond      cond;
+    GLFWthread    thread;
+
+    // Textures and pixel buffer objects, only used by the render thread
+    GLuint        textures[ _GLFW_SEQ_TEXTURES ];
+    int           textureFrame[ _GLFW_SEQ_TEXTURES ];
+    int           textureUse[ _GLFW_SEQ_TEXTURES ];
+    int           width, height, pixelformat;
+    GLuint        buffers[ _GLFW_SEQ_TEXTURES ];
+    int           nextBuffer;
+    int           current;      // Texture returned last, or -1
+    int           uses;
+} _GLFWsequence;
+
+
+//========================================================================
+// Build the file name of a frame
+//========================================================================
+
+static void GetFrameName( const _GLFWsequence *seq, int frame, char *name,
+    size_t size )
+{
+#if defined( _MSC_VER )
+    _snprintf( name, size, seq->pattern, seq->first + frame );
+    name[ size - 1 ] = '\0';
+#else
+    snprintf( name, size, seq->pattern, seq->first + frame );
+#endif
+}
+
+
+//========================================================================
+// Check whether a frame is within the read-ahead window
+//========================================================================
+
+static int InWindow( const _GLFWsequence *seq, int frame )
+{
+    int offset;
+
+    offset = frame - seq->wanted;
+    if( offset < 0 && ( seq->flags & GLFW_LOOP_SEQUENCE_BIT ) )
+    {
+        offset += seq->length;
+    }
+
+    return offset >= 0 && offset < _GLFW_SEQ_READAHEAD;
+}
+
+
+//========================================================================
+// Find the decoded frame slot that holds a frame
+//========================================================================
+
+static _GLFWseqframe *FindFrame( _GLFWsequence *seq, int frame )
+{
+    int n;
+
+    for( n = 0; n < _GLFW_SEQ_READAHEAD; n ++ )
+    {
+        if( seq->frames[ n ].state != _GLFW_FRAME_FREE &&
+            seq->frames[ n ].frame == frame )
+        {
+            return &seq->frames[ n ];
+        }
+    }
+
+    return NULL;
+}
+
+
+//========================================================================
+// Decode frames ahead of the playback position (thread function)
+//========================================================================
+
+static void GLFWCALL DecoderThread( void *arg )
+{
+    _GLFWsequence *seq = (_GLFWsequence *) arg;
+    _GLFWseqframe *slot;
+    GLFWimage     image;
+    char          name[ 1024 ];
+    int           n, frame, success;
+
+    glfwLockMutex( seq->mutex );
+
+    while( !seq->stop )
+    {
+        // Find the first frame of the window that is not decoded yet
+        frame = -1;
+        for( n = 0; n < _GLFW_SEQ_READAHEAD; n ++ )
+        {
+            frame = seq->wanted + n;
+            if( frame >= seq->length )
+            {
+                if( !( seq->flags & GLFW_LOOP_SEQUENCE_BIT ) )
+                {
+                    frame = -1;
+                    break;
+                }
+                frame %= seq->length;
+            }
+            if( FindFrame( seq, frame ) == NULL )
+            {
+                break;
+            }
+            frame = -1;
+        }
+
+        // Find a slot that is free, or holds a frame that was skipped or
+        // has already been played
+        slot = NULL;
+        for( n = 0; n < _GLFW_SEQ_READAHEAD && frame >= 0; n ++ )
+        {
+            if( seq->frames[ n ].state == _GLFW_FRAME_FREE ||
+                ( seq->frames[ n ].state != _GLFW_FRAME_DECODING &&
+                  !InWindow( seq, seq->frames[ n ].frame ) ) )
+            {
+                slot = &seq->frames[ n ];
+                break;
+            }
+        }
+
+        if( slot == NULL )
+        {
+            glfwWaitCond( seq->cond, seq->mutex, GLFW_INFINITY );
+            continue;
+        }
+
+        if( slot->image.Data )
+        {
+            glfwFreeImage( &slot->image );
+        }
+        slot->frame = frame;
+        slot->state = _GLFW_FRAME_DECODING;
+
+        glfwUnlockMutex( seq->mutex );
+        GetFrameName( seq, frame, name, sizeof( name ) );
+        success = glfwReadImage( name, &image, seq->flags );
+        glfwLockMutex( seq->mutex );
+
+        if( success )
+        {
+            slot->image = image;
+            slot->state = _GLFW_FRAME_READY;
+        }
+        else
+        {
+            // Remember the failure, so the frame is not read again
+            slot->state = _GLFW_FRAME_FAILED;
+        }
+    }
+
+    glfwUnlockMutex( seq->mutex );
+}
+
+
+//========================================================================
+// Upload a decoded frame into the least recently used texture that is
+// not the one currently shown
+//========================================================================
+
+static int UploadFrame( _GLFWsequence *seq, const GLFWimage *img,
+    int frame )
+{
+    GLint  internalformat;
+    GLenum format, type;
+    void   *data, *ptr;
+    int    n, best, pixelformat, size, glformat;
+
+    best = -1;
+    for( n = 0; n < _GLFW_SEQ_TEXTURES; n ++ )
+    {
+        if( n != seq->current &&
+            ( best < 0 || seq->textureUse[ n ] < seq->textureUse[ best ] ) )
+        {
+            best = n;
+        }
+    }
+
+    pixelformat = _glfwGetPixelFormat( img );
+    _glfwGetUploadFormat( pixelformat, &internalformat, &format, &type );
+    size = img->Width * img->Height *
+           _glfwGetPixelFormatSize( pixelformat, &glformat );
+
+    // All textures are respecified if the frame size or format changes
+    if( img->Width != seq->width || img->Height != seq->height ||
+        pixelformat != seq->pixelformat )
+    {
+        for( n = 0; n < _GLFW_SEQ_TEXTURES; n ++ )
+        {
+            glBindTexture( GL_TEXTURE_2D, seq->textures[ n ] );
+            glTexImage2D( GL_TEXTURE_2D, 0, internalformat, img->Width,
+                img->Height, 0, format, type, NULL );
+            if( n != best )
+            {
+                seq->textureFrame[ n ] = -1;
+            }
+        }
+        seq->width       = img->Width;
+        seq->height      = img->Height;
+        seq->pixelformat = pixelformat;
+        seq->current     = -1;
+    }
+
+    // Stream the pixels through the next pixel buffer object, so that the
+    // texture upload does not block the render thread. Respecifying the
+    // buffer store first lets the driver hand out fresh memory instead of
+    // waiting for a pending upload from it
+    data = (void*) img->Data;
+    if( _glfwWin.has_GL_ARB_pixel_buffer_object )
+    {
+        _glfwWin.BindBuffer( GL_PIXEL_UNPACK_BUFFER,
+                             seq->buffers[ seq->nextBuffer ] );
+        _glfwWin.BufferData( GL_PIXEL_UNPACK_BUFFER, size, NULL,
+                             GL_STREAM_DRAW );
+        ptr = _glfwWin.MapBuffer( GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY );
+        if( ptr )
+        {
+            memcpy( ptr, img->Data, size );
+            _glfwWin.UnmapBuffer( GL_PIXEL_UNPACK_BUFFER );
+            data = NULL;
+        }
+        else
+        {
+            _glfwWin.BindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+        }
+        seq->nextBuffer = ( seq->nextBuffer + 1 ) % _GLFW_SEQ_TEXTURES;
+    }
+
+    glBindTexture( GL_TEXTURE_2D, seq->textures[ best ] );
+    glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, img->Width, img->Height,
+                     format, type, data );
+
+    if( _glfwWin.has_GL_ARB_pixel_buffer_object )
+    {
+        _glfwWin.BindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+    }
+
+    seq->textureFrame[ best ] = frame;
+    seq->textureUse[ best ]   = ++ seq->uses;
+
+    return best;
+}
+
+
+//========================================================================
+// Find the texture holding a frame, or -1
+//========================================================================
+
+static int FindTexture( const _GLFWsequence *seq, int frame )
+{
+    int n;
+
+    for( n = 0; n < _GLFW_SEQ_TEXTURES; n ++ )
+    {
+        if( seq->textureFrame[ n ] == frame )
+        {
+            return n;
+        }
+    }
+
+    return -1;
+}
+
+
+//========================================================================
+// Stop the worker thread and free an image sequence
+//========================================================================
+
+static void FreeSequence( _GLFWsequence *seq )
+{
+    int n;
+
+    if( seq->thread >= 0 )
+    {
+        glfwLockMutex( seq->mutex );
+        seq->stop = GL_TRUE;
+        glfwSignalCond( seq->cond );
+        glfwUnlockMutex( seq->mutex );
+        glfwWaitThread( seq->thread, GLFW_WAIT );
+    }
+
+    if( seq->mutex )
+    {
+        glfwDestroyMutex( seq->mutex );
+    }
+    if( seq->cond )
+    {
+        glfwDestroyCond( seq->cond );
+    }
+
+    for( n = 0; n < _GLFW_SEQ_READAHEAD; n ++ )
+    {
+        if( seq->frames[ n ].image.Data )
+        {
+            glfwFreeImage( &seq->frames[ n ].image );
+        }
+    }
+
+    if( seq->textures[ 0 ] )
+    {
+        glDeleteTextures( _GLFW_SEQ_TEXTURES, seq->textures );
+    }
+    if( seq->buffers[ 0 ] )
+    {
+        _glfwWin.DeleteBuffers( _GLFW_SEQ_TEXTURES, seq->buffers );
+    }
+
+    _glfwFree( seq->pattern );
+    _glfwFree( seq );
+}
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Open a sequence of numbered image files for playback
+//========================================================================
+
+GLFWAPI GLFWsequence GLFWAPIENTRY glfwOpenImageSequence( const char *pattern,
+    double fps, int flags )
+{
+    _GLFWsequence *seq;
+    GLint         texture;
+    FILE          *file;
+    char          name[ 1024 ];
+    int           n;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwWin.opened )
+    {
+        return NULL;
+    }
+
+    if( pattern == NULL || fps <= 0.0 )
+    {
+        return NULL;
+    }
+
+    seq = (_GLFWsequence *) _glfwCalloc( 1, sizeof( _GLFWsequence ) );
+    if( seq == NULL )
+    {
+        return NULL;
+    }
+    seq->thread = -1;
+    seq->current = -1;
+    seq->fps = fps;
+
+    // Frames are streamed as they are, so never rescale them unless the
+    // hardware requires it
+    seq->flags = flags & ( GLFW_ORIGIN_UL_BIT | GLFW_ALPHA_MAP_BIT |
+                           GLFW_NO_RESCALE_BIT | GLFW_LOOP_SEQUENCE_BIT );
+    if( _glfwWin.has_GL_ARB_texture_non_power_of_two )
+    {
+        seq->flags |= GLFW_NO_RESCALE_BIT;
+    }
+
+    seq->pattern = (char *) _glfwMalloc( strlen( pattern ) + 1 );
+    if( seq->pattern == NULL )
+    {
+        _glfwFree( seq );
+        return NULL;
+    }
+    strcpy( seq->pattern, pattern );
+
+    // Numbering starts at zero or one, and ends at the first missing file
+    for( seq->first = 0; seq->first < 2; seq->first ++ )
+    {
+        for( seq->length = 0; ; seq->length ++ )
+        {
+            GetFrameName( seq, seq->length, name, sizeof( name ) );
+            file = fopen( name, "rb" );
+            if( file == NULL )
+            {
+                break;
+            }
+            fclose( file );
+        }
+
+        if( seq->length > 0 )
+        {
+            break;
+        }
+    }
+
+    if( seq->length == 0 )
+    {
+        FreeSequence( seq );
+        return NULL;
+    }
+
+    for( n = 0; n < _GLFW_SEQ_TEXTURES; n ++ )
+    {
+        seq->textureFrame[ n ] = -1;
+    }
+
+    glGetIntegerv( GL_TEXTURE_BINDING_2D, &texture );
+    glGenTextures( _GLFW_SEQ_TEXTURES, seq->textures );
+    for( n = 0; n < _GLFW_SEQ_TEXTURES; n ++ )
+    {
+        glBindTexture( GL_TEXTURE_2D, seq->textures[ n ] );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    }
+    glBindTexture( GL_TEXTURE_2D, (GLuint) texture );
+
+    if( _glfwWin.has_GL_ARB_pixel_buffer_object )
+    {
+        _glfwWin.GenBuffers( _GLFW_SEQ_TEXTURES, seq->buffers );
+    }
+
+    seq->mutex = glfwCreateMutex();
+    seq->cond  = glfwCreateCond();
+    if( seq->mutex && seq->cond )
+    {
+        seq->thread = glfwCreateThread( DecoderThread, seq );
+    }
+    if( seq->thread < 0 )
+    {
+        FreeSequence( seq );
+        return NULL;
+    }
+
+    return (GLFWsequence) seq;
+}
+
+
+//========================================================================
+// Close an image sequence
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwCloseImageSequence( GLFWsequence seq )
+{
+    // Is GLFW initialized?
+    if( !_glfwInitialized || seq == NULL )
+    {
+        return;
+    }
+
+    FreeSequence( (_GLFWsequence *) seq );
+}
+
+
+//========================================================================
+// Get the texture to show at a given time (in seconds since the first
+// frame). Returns zero if no frame has been decoded yet
+//========================================================================
+
+GLFWAPI GLuint GLFWAPIENTRY glfwGetSequenceFrame( GLFWsequence handle,
+    double time )
+{
+    _GLFWsequence *seq = (_GLFWsequence *) handle;
+    _GLFWseqframe *decoded[ 2 ];
+    GLint         texture, UnpackAlignment;
+    int           frame, next, n, index;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwWin.opened || seq == NULL )
+    {
+        return 0;
+    }
+
+    frame = time > 0.0 ? (int) ( time * seq->fps ) : 0;
+    if( seq->flags & GLFW_LOOP_SEQUENCE_BIT )
+    {
+        frame %= seq->length;
+        next = ( frame + 1 ) % seq->length;
+    }
+    else
+    {
+        frame = frame < seq->length ? frame : seq->length - 1;
+        next = frame + 1 < seq->length ? frame + 1 : frame;
+    }
+
+    // Move the read-ahead window, and pick up the requested frame and the
+    // one after it if they are ready. Neither can be recycled by the
+    // worker while they are in the window, which only moves here
+    glfwLockMutex( seq->mutex );
+    if( frame != seq->wanted )
+    {
+        seq->wanted = frame;
+        glfwSignalCond( seq->cond );
+    }
+    decoded[ 0 ] = FindFrame( seq, frame );
+    decoded[ 1 ] = next != frame ? FindFrame( seq, next ) : NULL;
+    for( n = 0; n < 2; n ++ )
+    {
+        if( decoded[ n ] && decoded[ n ]->state != _GLFW_FRAME_READY )
+        {
+            decoded[ n ] = NULL;
+        }
+    }
+    glfwUnlockMutex( seq->mutex );
+
+    glGetIntegerv( GL_TEXTURE_BINDING_2D, &texture );
+    glGetIntegerv( GL_UNPACK_ALIGNMENT, &UnpackAlignment );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+    // Show the requested frame if it has been decoded
+    index = FindTexture( seq, frame );
+    if( index < 0 && decoded[ 0 ] )
+    {
+        index = UploadFrame( seq, &decoded[ 0 ]->image, frame );
+    }
+    if( index >= 0 )
+    {
+        seq->current = index;
+        seq->textureUse[ index ] = ++ seq->uses;
+    }
+
+    // Upload the next frame early, into the third texture, so that it is
+    // ready by the time it is shown
+    if( decoded[ 1 ] && FindTexture( seq, next ) < 0 )
+    {
+        UploadFrame( seq, &decoded[ 1 ]->image, next );
+    }
+
+    glPixelStorei( GL_UNPACK_ALIGNMENT, UnpackAlignment );
+    glBindTexture( GL_TEXTURE_2D, (GLuint) texture );
+
+    // Keep showing the last frame until the requested one is available
+    if( seq->current < 0 )
+    {
+        return 0;
+    }
+
+    return seq->textures[ seq->current ];
+}
+
+
+//========================================================================
+// Get the number of frames in an image sequence
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwGetSequenceLength( GLFWsequence seq )
+{
+    // Is GLFW initialized?
+    if( !_glfwInitialized || seq == NULL )
+    {
+        return 0;
+    }
+
+    return ( (_GLFWsequence *) seq )->length;
+}
@@ -0,0 +1,346 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+//========================================================================
+// Description:
+//
+// This module runs graphs of tasks with dependencies on a thread pool.
+// Every task counts the predecessors it is still waiting for; when a task
+// finishes, it decrements the count of each of its successors and submits
+// those that reach zero, so a task starts as soon as its own inputs are
+// ready rather than at a barrier.
+//
+// A graph is built once and may then be run any number of times. All
+// memory is allocated while building, so running a graph allocates
+// nothing.
+//
+//========================================================================
+
+
+#include "internal.h"
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+struct _GLFWtaskgraph_struct;
+
+//========================================================================
+// Task in a task graph
+//========================================================================
+
+typedef struct {
+    GLFWjobfun    fun;
+    void          *arg;
+    struct _GLFWtaskgraph_struct *graph;
+    int           *successors;  // Tasks depending on this one
+    int           successorCount, successorCapacity;
+    int           predecessorCount;
+    volatile long remaining;    // Predecessors not yet finished this run
+} _GLFWtask;
+
+
+//========================================================================
+// Task graph
+//========================================================================
+
+typedef struct _GLFWtaskgraph_struct {
+    _GLFWtask     *tasks;
+    int           count, capacity;
+    GLFWthreadpool pool;        // Pool of the current run
+    volatile long pending;      // Submitted tasks not yet finished
+    int           running;
+} _GLFWtaskgraph;
+
+
+//========================================================================
+// Run a task, then submit those of its successors that became ready
+// (job function)
+//========================================================================
+
+static void GLFWCALL RunTask( void *arg )
+{
+    _GLFWtask      *task = (_GLFWtask *) arg;
+    _GLFWtaskgraph *graph = task->graph;
+    _GLFWtask      *next;
+    int            i;
+
+    task->fun( task->arg );
+
+    // The pending count of the graph can not reach zero before this job
+    // has finished, so successors submitted here are always waited for
+    for( i = 0; i < task->successorCount; i ++ )
+    {
+        next = &graph->tasks[ task->successors[ i ] ];
+        if( _glfwPlatformAtomicAdd( &next->remaining, -1 ) == 0 )
+        {
+            _glfwSubmitPoolJob( graph->pool, RunTask, next,
+                                &graph->pending );
+        }
+    }
+}
+
+
+//========================================================================
+// Check whether a task can be reached from another through successors
+//========================================================================
+
+static int IsReachable( _GLFWtaskgraph *graph, int from, int to )
+{
+    unsigned char *visited;
+    int           *stack;
+    int           top, task, next, i, found;
+
+    visited = (unsigned char *) _glfwCalloc( graph->count, 1 );
+    stack   = (int *) _glfwMalloc( graph->count * sizeof( int ) );
+    if( visited == NULL || stack == NULL )
+    {
+        _glfwFree( visited );
+        _glfwFree( stack );
+
+        // Assume the worst
+        return GL_TRUE;
+    }
+
+    found = GL_FALSE;
+    top = 0;
+    stack[ top ++ ] = from;
+    visited[ from ] = 1;
+    while( top > 0 && !found )
+    {
+        task = stack[ -- top ];
+        if( task == to )
+        {
+            found = GL_TRUE;
+            break;
+        }
+
+        for( i = 0; i < graph->tasks[ task ].successorCount; i ++ )
+        {
+            next = graph->tasks[ task ].successors[ i ];
+            if( !visited[ next ] )
+            {
+                visited[ next ] = 1;
+                stack[ top ++ ] = next;
+            }
+        }
+    }
+
+    _glfwFree( visited );
+    _glfwFree( stack );
+
+    return found;
+}
+
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Create an empty task graph
+//========================================================================
+
+GLFWAPI GLFWtaskgraph GLFWAPIENTRY glfwCreateTaskGraph( void )
+{
+    _GLFWtaskgraph *graph;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return NULL;
+    }
+
+    graph = (_GLFWtaskgraph *) _glfwCallocAs( 1, sizeof( _GLFWtaskgraph ),
+                                              GLFW_MEMORY_THREAD );
+
+    return (GLFWtaskgraph) graph;
+}
+
+
+//========================================================================
+// Destroy a task graph
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwDestroyTaskGraph( GLFWtaskgraph graph )
+{
+    _GLFWtaskgraph *g = (_GLFWtaskgraph *) graph;
+    int            i;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || g == NULL )
+    {
+        return;
+    }
+
+    for( i = 0; i < g->count; i ++ )
+    {
+        _glfwFree( g->tasks[ i ].successors );
+    }
+    _glfwFree( g->tasks );
+    _glfwFree( g );
+}
+
+
+//========================================================================
+// Add a task to a task graph. Returns the index of the task, or -1 if it
+// could not be added
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwAddTask( GLFWtaskgraph graph, GLFWjobfun fun,
+    void *arg )
+{
+    _GLFWtaskgraph *g = (_GLFWtaskgraph *) graph;
+    _GLFWtask      *tasks, *task;
+    int            capacity;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || g == NULL || fun == NULL || g->running )
+    {
+        return -1;
+    }
+
+    if( g->count == g->capacity )
+    {
+        capacity = g->capacity ? g->capacity * 2 : 16;
+        tasks = (_GLFWtask *) _glfwRealloc( g->tasks,
+                                            capacity * sizeof( _GLFWtask ) );
+        if( tasks == NULL )
+        {
+            return -1;
+        }
+        g->tasks    = tasks;
+        g->capacity = capacity;
+    }
+
+    task = &g->tasks[ g->count ];
+    memset( task, 0, sizeof( _GLFWtask ) );
+    task->fun   = fun;
+    task->arg   = arg;
+    task->graph = g;
+
+    return g->count ++;
+}
+
+
+//========================================================================
+// Make a task wait for another to finish before it starts. Fails if the
+// dependency would make a cycle
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwAddDependency( GLFWtaskgraph graph, int task,
+    int dependency )
+{
+    _GLFWtaskgraph *g = (_GLFWtaskgraph *) graph;
+    _GLFWtask      *before;
+    int            *successors, capacity;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || g == NULL || g->running )
+    {
+        return GL_FALSE;
+    }
+
+    if( task < 0 || task >= g->count || dependency < 0 ||
+        dependency >= g->count || task == dependency )
+    {
+        return GL_FALSE;
+    }
+
+    if( IsReachable( g, task, dependency ) )
+    {
+        return GL_FALSE;
+    }
+
+    before = &g->tasks[ dependency ];
+    if( before->successorCount == before->successorCapacity )
+    {
+        capacity = before->successorCapacity ?
+                   before->successorCapacity * 2 : 4;
+        successors = (int *) _glfwRealloc( before->successors,
+                                           capacity * sizeof( int ) );
+        if( successors == NULL )
+        {
+            return GL_FALSE;
+        }
+        before->successors        = successors;
+        before->successorCapacity = capacity;
+    }
+
+    before->successors[ before->successorCount ++ ] = task;
+    g->tasks[ task ].predecessorCount ++;
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Run all tasks of a task graph on a thread pool, each as soon as all of
+// its dependencies have finished, and wait for them. The calling thread
+// helps running tasks. This may be called from within jobs
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwRunTaskGraph( GLFWtaskgraph graph,
+    GLFWthreadpool pool )
+{
+    _GLFWtaskgraph *g = (_GLFWtaskgraph *) graph;
+    int            i;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || g == NULL || pool == NULL || g->running )
+    {
+        return;
+    }
+
+    g->running = GL_TRUE;
+    g->pool    = pool;
+    g->pending = 0;
+
+    // All counts must be reset before any task can finish
+    for( i = 0; i < g->count; i ++ )
+    {
+        g->tasks[ i ].remaining = g->tasks[ i ].predecessorCount;
+    }
+
+    for( i = 0; i < g->count; i ++ )
+    {
+        if( g->tasks[ i ].predecessorCount == 0 )
+        {
+            _glfwSubmitPoolJob( pool, RunTask, &g->tasks[ i ],
+                                &g->pending );
+        }
+    }
+
+    _glfwWaitPoolJobs( pool, &g->pending );
+
+    g->running = GL_FALSE;
+}
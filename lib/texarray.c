@@ -0,0 +1,428 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+//========================================================================
+// Description:
+//
+// This module loads several image files into one texture object, either
+// as the layers of a 2D array texture or as the six faces of a cube map.
+//
+// The files are decoded in parallel by a few worker threads, converted
+// to a common pixel format and then uploaded one layer (or face) at a
+// time. Mipmaps are always built in software here, since automatic
+// mipmap generation would run again after every layer.
+//
+//========================================================================
+
+
+#include "internal.h"
+
+
+// Texture targets that may be missing from old OpenGL headers
+#ifndef GL_VERSION_1_3
+ #define GL_TEXTURE_CUBE_MAP_POSITIVE_X 0x8515
+#endif // GL_VERSION_1_3
+
+#ifndef GL_VERSION_3_0
+ #define GL_TEXTURE_2D_ARRAY            0x8C1A
+#endif // GL_VERSION_3_0
+
+// Maximum number of threads used to decode image files
+#define _GLFW_MAX_DECODE_THREADS 8
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+//========================================================================
+// Work shared by the image decoding threads
+//========================================================================
+
+typedef struct {
+    const char **names;
+    GLFWimage  *images;
+    int        count;
+    int        next;
+    int        flags;
+    int        failed;
+    GLFWmutex  mutex;
+} _GLFWdecode;
+
+
+//========================================================================
+// Decode image files until there are none left (thread function)
+//========================================================================
+
+static void GLFWCALL DecodeImages( void *arg )
+{
+    _GLFWdecode *work = (_GLFWdecode *) arg;
+    int n;
+
+    for( ;; )
+    {
+        // Claim the next image
+        if( work->mutex )
+        {
+            glfwLockMutex( work->mutex );
+        }
+        n = work->next ++;
+        if( work->mutex )
+        {
+            glfwUnlockMutex( work->mutex );
+        }
+
+        if( n >= work->count )
+        {
+            break;
+        }
+
+        // No locking is needed, as only this thread writes this slot and
+        // every thread writes the same value to the failure flag
+        if( !glfwReadImage( work->names[ n ], &work->images[ n ],
+                            work->flags ) )
+        {
+            work->failed = GL_TRUE;
+        }
+    }
+}
+
+
+//========================================================================
+// Read a set of image files of the same size and pixel format
+//========================================================================
+
+static int ReadImages( const char **names, int count, GLFWimage *images,
+    int flags )
+{
+    _GLFWdecode work;
+    GLFWthread  threads[ _GLFW_MAX_DECODE_THREADS ];
+    int         n, threadcount, pixelformat;
+
+    // Force rescaling if necessary
+    if( !_glfwWin.has_GL_ARB_texture_non_power_of_two )
+    {
+        flags &= (~GLFW_NO_RESCALE_BIT);
+    }
+
+    work.names  = names;
+    work.images = images;
+    work.count  = count;
+    work.next   = 0;
+    work.flags  = flags;
+    work.failed = GL_FALSE;
+
+    for( n = 0; n < count; n ++ )
+    {
+        images[ n ].Data = NULL;
+    }
+
+    // The calling thread decodes too, so one helper thread fewer is used
+    threadcount = glfwGetNumberOfProcessors();
+    if( threadcount > count )
+    {
+        threadcount = count;
+    }
+    if( threadcount > _GLFW_MAX_DECODE_THREADS )
+    {
+        threadcount = _GLFW_MAX_DECODE_THREADS;
+    }
+    threadcount --;
+
+    work.mutex = threadcount > 0 ? glfwCreateMutex() : NULL;
+    if( !work.mutex )
+    {
+        threadcount = 0;
+    }
+
+    for( n = 0; n < threadcount; n ++ )
+    {
+        threads[ n ] = glfwCreateThread( DecodeImages, &work );
+        if( threads[ n ] < 0 )
+        {
+            break;
+        }
+    }
+    threadcount = n;
+
+    DecodeImages( &work );
+
+    for( n = 0; n < threadcount; n ++ )
+    {
+        glfwWaitThread( threads[ n ], GLFW_WAIT );
+    }
+
+    if( work.mutex )
+    {
+        glfwDestroyMutex( work.mutex );
+    }
+
+    // All images must have the same size
+    for( n = 1; n < count && !work.failed; n ++ )
+    {
+        if( images[ n ].Width != images[ 0 ].Width ||
+            images[ n ].Height != images[ 0 ].Height )
+        {
+            work.failed = GL_TRUE;
+        }
+    }
+
+    // Convert all images to a common pixel format
+    if( !work.failed )
+    {
+        pixelformat = _glfwGetCommonPixelFormat( images, count );
+        for( n = 0; n < count && !work.failed; n ++ )
+        {
+            if( _glfwGetPixelFormat( &images[ n ] ) != pixelformat &&
+                !glfwConvertImage( &images[ n ], &images[ n ],
+                                   pixelformat, 0 ) )
+            {
+                work.failed = GL_TRUE;
+            }
+        }
+    }
+
+    if( work.failed )
+    {
+        for( n = 0; n < count; n ++ )
+        {
+            if( images[ n ].Data )
+            {
+                glfwFreeImage( &images[ n ] );
+            }
+        }
+        return GL_FALSE;
+    }
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Upload a set of images as array texture layers or cube map faces
+//========================================================================
+
+static int UploadImages( GLenum target, GLFWimage *images, int count,
+    int flags )
+{
+    GLint   UnpackAlignment, internalformat;
+    GLenum  format, type;
+    int     n, level, width, height, pixelformat, packformat;
+    unsigned char *data, *packed;
+
+    pixelformat = _glfwGetPixelFormat( &images[ 0 ] );
+
+    // Premultiply alpha before any mipmap levels are built
+    if( flags & GLFW_PREMULTIPLY_ALPHA_BIT )
+    {
+        for( n = 0; n < count; n ++ )
+        {
+            _glfwConvertPixels( &images[ n ], images[ n ].Data, pixelformat,
+                                GLFW_PREMULTIPLY_ALPHA_BIT );
+        }
+    }
+
+    // Should we pack the texture into 16-bit pixels?
+    packformat = _glfwGetPackFormat( pixelformat, flags );
+    packed = NULL;
+    if( packformat )
+    {
+        packed = (unsigned char *)
+            _glfwAllocPixels( images[ 0 ].Width * images[ 0 ].Height * 2 );
+        if( packed == NULL )
+        {
+            return GL_FALSE;
+        }
+    }
+
+    _glfwGetUploadFormat( packformat ? packformat : pixelformat,
+                          &internalformat, &format, &type );
+
+    // Set unpack alignment to one byte
+    glGetIntegerv( GL_UNPACK_ALIGNMENT, &UnpackAlignment );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+    level = 0;
+    do
+    {
+        width  = images[ 0 ].Width;
+        height = images[ 0 ].Height;
+
+        // Allocate storage for all layers of this mipmap level
+        if( target == GL_TEXTURE_2D_ARRAY )
+        {
+            _glfwWin.TexImage3D( target, level, internalformat,
+                width, height, count, 0, format, type, NULL );
+        }
+
+        for( n = 0; n < count; n ++ )
+        {
+            data = images[ n ].Data;
+
+            // Pack this mipmap level, if required
+            if( packformat )
+            {
+                _glfwConvertPixels( &images[ n ], packed, packformat,
+                                    flags & GLFW_DITHER_BIT );
+                data = packed;
+            }
+
+            if( target == GL_TEXTURE_2D_ARRAY )
+            {
+                _glfwWin.TexSubImage3D( target, level, 0, 0, n,
+                    width, height, 1, format, type, (void*) data );
+            }
+            else
+            {
+                glTexImage2D( target + n, level, internalformat,
+                    width, height, 0, format, type, (void*) data );
+            }
+        }
+
+        // Build next mipmap level of every layer, if required
+        if( flags & GLFW_BUILD_MIPMAPS_BIT )
+        {
+            for( n = 0; n < count; n ++ )
+            {
+                if( !_glfwHalveImage( images[ n ].Data, &images[ n ].Width,
+                                      &images[ n ].Height,
+                                      images[ n ].BytesPerPixel ) )
+                {
+                    break;
+                }
+            }
+            level = n == count ? level + 1 : 0;
+        }
+    }
+    while( level != 0 );
+
+    // Restore old unpack alignment
+    glPixelStorei( GL_UNPACK_ALIGNMENT, UnpackAlignment );
+
+    if( packed )
+    {
+        _glfwFreePixels( packed );
+    }
+
+    return GL_TRUE;
+}
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Read a set of images from files, and upload them as the layers of a
+// 2D array texture
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwLoadTextureArray( const char **names,
+    int count, int flags )
+{
+    GLFWimage *images;
+    int       n, success;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwWin.opened )
+    {
+        return GL_FALSE;
+    }
+
+    if( count < 1 || !_glfwWin.has_GL_EXT_texture_array )
+    {
+        return GL_FALSE;
+    }
+
+    images = (GLFWimage *) _glfwMalloc( count * sizeof( GLFWimage ) );
+    if( images == NULL )
+    {
+        return GL_FALSE;
+    }
+
+    if( !ReadImages( names, count, images, flags ) )
+    {
+        _glfwFree( images );
+        return GL_FALSE;
+    }
+
+    success = UploadImages( GL_TEXTURE_2D_ARRAY, images, count, flags );
+
+    // Data buffers are not needed anymore
+    for( n = 0; n < count; n ++ )
+    {
+        glfwFreeImage( &images[ n ] );
+    }
+    _glfwFree( images );
+
+    return success;
+}
+
+
+//========================================================================
+// Read six images from files, and upload them as the faces of a cube map
+// (in the order +X, -X, +Y, -Y, +Z, -Z)
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwLoadTextureCube( const char **names,
+    int flags )
+{
+    GLFWimage images[ 6 ];
+    int       n, success;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwWin.opened )
+    {
+        return GL_FALSE;
+    }
+
+    if( !_glfwWin.has_GL_ARB_texture_cube_map )
+    {
+        return GL_FALSE;
+    }
+
+    if( !ReadImages( names, 6, images, flags ) )
+    {
+        return GL_FALSE;
+    }
+
+    // Cube map faces must be square
+    success = images[ 0 ].Width == images[ 0 ].Height &&
+              UploadImages( GL_TEXTURE_CUBE_MAP_POSITIVE_X, images, 6,
+                            flags );
+
+    // Data buffers are not needed anymore
+    for( n = 0; n < 6; n ++ )
+    {
+        glfwFreeImage( &images[ n ] );
+    }
+
+    return success;
+}
@@ -0,0 +1,522 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+//========================================================================
+// Description:
+//
+// This module updates parts of a texture that was uploaded earlier with
+// glfwLoadTextureImage2D, so that dynamic textures only pay for the
+// pixels that actually changed.
+//
+// Level zero is uploaded straight from the image with GL_UNPACK_ROW_LENGTH
+// and the skip parameters. If mipmaps are requested, the affected texels
+// of every smaller level are box filtered from those just computed for
+// the level above it, so each level only costs its share of the region.
+// Lists of dirty rectangles are clipped and merged before they are
+// uploaded.
+//
+//========================================================================
+
+
+#include "internal.h"
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+//========================================================================
+// Convert a span of one image row into a work pixel format
+//========================================================================
+
+static const unsigned char *GetRowPixels( const GLFWimage *img,
+    int x, int y, int width, int workformat, int flags,
+    unsigned char *buffer )
+{
+    GLFWimage row;
+    int       pixelformat, glformat, bpp;
+
+    pixelformat = _glfwGetPixelFormat( img );
+    bpp = _glfwGetPixelFormatSize( pixelformat, &glformat );
+
+    row.Width         = width;
+    row.Height        = 1;
+    row.Format        = img->Format;
+    row.BytesPerPixel = img->BytesPerPixel;
+    row.Data          = img->Data + ( y * img->Width + x ) * bpp;
+
+    if( workformat == pixelformat &&
+        !( flags & GLFW_PREMULTIPLY_ALPHA_BIT ) )
+    {
+        return row.Data;
+    }
+
+    _glfwConvertPixels( &row, buffer, workformat,
+                        flags & GLFW_PREMULTIPLY_ALPHA_BIT );
+    return buffer;
+}
+
+
+//========================================================================
+// Find the texels of a mipmap level that cover a span of level zero
+//========================================================================
+
+static void GetLevelSpan( int x, int width, int level, int levelsize,
+    int *x0, int *x1 )
+{
+    *x0 = x >> level;
+    *x1 = ( (x + width - 1) >> level ) + 1;
+    if( *x1 > levelsize ) *x1 = levelsize;
+
+    // Rounding down may put the first texel past the last one of an
+    // NPOT level, which would leave an empty span
+    if( *x0 > levelsize - 1 ) *x0 = levelsize - 1;
+}
+
+
+//========================================================================
+// Find the texels of a mipmap level that are computed while updating a
+// span: the dirty texels plus those that the next level is filtered from
+//========================================================================
+
+static void GetWorkSpan( int x, int width, int level, int levelsize,
+    int *x0, int *x1 )
+{
+    int n0, n1, nextsize;
+
+    GetLevelSpan( x, width, level, levelsize, x0, x1 );
+    if( levelsize == 1 )
+    {
+        return;
+    }
+
+    nextsize = levelsize >> 1;
+    GetLevelSpan( x, width, level + 1, nextsize, &n0, &n1 );
+    if( 2 * n0 < *x0 ) *x0 = 2 * n0;
+    if( 2 * n1 > *x1 ) *x1 = 2 * n1;
+}
+
+
+//========================================================================
+// Box filter one texel of a mipmap level directly from the image, over
+// the same block of the image that halving it level by level would cover
+//========================================================================
+
+static void FilterTexel( const GLFWimage *img, int level, int i, int j,
+    int workformat, int flags, int bpp, unsigned char *rowbuffer,
+    unsigned char *dst )
+{
+    unsigned int sums[ 4 ];
+    const unsigned char *src;
+    int xshift, yshift, bx0, bx1, by0, by1, sx, sy, k, count;
+
+    // A side stops shrinking once it is one texel wide
+    for( xshift = level; img->Width >> xshift == 0; xshift -- );
+    for( yshift = level; img->Height >> yshift == 0; yshift -- );
+
+    bx0 = i << xshift;
+    bx1 = (i + 1) << xshift;
+    by0 = j << yshift;
+    by1 = (j + 1) << yshift;
+
+    memset( sums, 0, sizeof( sums ) );
+    for( sy = by0; sy < by1; sy ++ )
+    {
+        src = GetRowPixels( img, bx0, sy, bx1 - bx0, workformat, flags,
+                            rowbuffer );
+        for( sx = 0; sx < bx1 - bx0; sx ++ )
+        {
+            for( k = 0; k < bpp; k ++ )
+            {
+                sums[ k ] += src[ sx * bpp + k ];
+            }
+        }
+    }
+
+    count = ( bx1 - bx0 ) * ( by1 - by0 );
+    for( k = 0; k < bpp; k ++ )
+    {
+        dst[ k ] = (unsigned char) ( ( sums[ k ] + count / 2 ) / count );
+    }
+}
+
+
+//========================================================================
+// Upload part of a work buffer to a level of the bound 2D texture
+//========================================================================
+
+static void UploadSpan( int level, int x0, int y0, int x1, int y1,
+    int ux0, int uy0, int ux1, GLenum format, GLenum type,
+    const unsigned char *buffer )
+{
+    glPixelStorei( GL_UNPACK_ROW_LENGTH, ux1 - ux0 );
+    glPixelStorei( GL_UNPACK_SKIP_PIXELS, x0 - ux0 );
+    glPixelStorei( GL_UNPACK_SKIP_ROWS, y0 - uy0 );
+    glTexSubImage2D( GL_TEXTURE_2D, level, x0, y0, x1 - x0, y1 - y0,
+        format, type, (void*) buffer );
+    glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+    glPixelStorei( GL_UNPACK_SKIP_PIXELS, 0 );
+    glPixelStorei( GL_UNPACK_SKIP_ROWS, 0 );
+}
+
+
+//========================================================================
+// Upload one clipped region of an image to the bound 2D texture
+//========================================================================
+
+static int UpdateRegion( const GLFWimage *img, int x, int y, int width,
+    int height, int flags )
+{
+    GLint   internalformat;
+    GLenum  format, type;
+    int     pixelformat, workformat, glformat, bpp, level, mipmaps,
+            levelwidth, levelheight, prevwidth, prevheight, x0, y0, x1, y1,
+            ux0, uy0, ux1, uy1, px0, py0, px1, py1, sx0, sx1, sy0, sy1,
+            i, j, k, n, size;
+    unsigned char *buffer, *prevbuffer, *rowbuffer, *dst, *tmp;
+    const unsigned char *src, *s00, *s01, *s10, *s11;
+
+    pixelformat = _glfwGetPixelFormat( img );
+    workformat  = pixelformat;
+    mipmaps     = flags & GLFW_BUILD_MIPMAPS_BIT;
+
+    // Packed pixels can not be box filtered, so expand them when
+    // mipmaps are updated
+    if( mipmaps &&
+        ( pixelformat == GLFW_PIXEL_RGB565 ||
+          pixelformat == GLFW_PIXEL_RGBA4444 ||
+          pixelformat == GLFW_PIXEL_RGBA5551 ) )
+    {
+        workformat = GLFW_PIXEL_RGBA;
+    }
+
+    // Premultiplication only makes sense if there is an alpha channel
+    if( pixelformat == GLFW_PIXEL_L || pixelformat == GLFW_PIXEL_RGB ||
+        pixelformat == GLFW_PIXEL_RGB565 )
+    {
+        flags &= ~GLFW_PREMULTIPLY_ALPHA_BIT;
+    }
+
+    bpp = _glfwGetPixelFormatSize( workformat, &glformat );
+
+    // Level zero: upload straight from the image rows when possible
+    if( workformat == pixelformat &&
+        !( flags & GLFW_PREMULTIPLY_ALPHA_BIT ) )
+    {
+        _glfwGetUploadFormat( pixelformat, &internalformat, &format, &type );
+        UploadSpan( 0, x, y, x + width, y + height, 0, 0, img->Width,
+                    format, type, img->Data );
+
+        if( !mipmaps )
+        {
+            return GL_TRUE;
+        }
+    }
+
+    // Every level is computed in a work buffer that also holds the
+    // texels the next level is filtered from, which adds at most one
+    // texel on each side of the updated region
+    size = ( width + 4 ) * ( height + 4 ) * bpp;
+    buffer     = (unsigned char *) _glfwMallocAs( size, GLFW_MEMORY_IMAGE );
+    prevbuffer = (unsigned char *) _glfwMallocAs( size, GLFW_MEMORY_IMAGE );
+    rowbuffer  = (unsigned char *) _glfwMallocAs( img->Width * bpp,
+                                                  GLFW_MEMORY_IMAGE );
+    if( buffer == NULL || prevbuffer == NULL || rowbuffer == NULL )
+    {
+        _glfwFree( buffer );
+        _glfwFree( prevbuffer );
+        _glfwFree( rowbuffer );
+        return GL_FALSE;
+    }
+
+    _glfwGetUploadFormat( workformat, &internalformat, &format, &type );
+
+    levelwidth  = img->Width;
+    levelheight = img->Height;
+    if( mipmaps )
+    {
+        GetWorkSpan( x, width, 0, levelwidth, &ux0, &ux1 );
+        GetWorkSpan( y, height, 0, levelheight, &uy0, &uy1 );
+    }
+    else
+    {
+        ux0 = x;
+        ux1 = x + width;
+        uy0 = y;
+        uy1 = y + height;
+    }
+
+    for( j = uy0; j < uy1; j ++ )
+    {
+        src = GetRowPixels( img, ux0, j, ux1 - ux0, workformat, flags,
+                            rowbuffer );
+        memcpy( buffer + ( j - uy0 ) * ( ux1 - ux0 ) * bpp, src,
+                ( ux1 - ux0 ) * bpp );
+    }
+
+    if( workformat != pixelformat || ( flags & GLFW_PREMULTIPLY_ALPHA_BIT ) )
+    {
+        UploadSpan( 0, x, y, x + width, y + height, ux0, uy0, ux1,
+                    format, type, buffer );
+    }
+
+    // Smaller levels: box filter each level from the texels computed for
+    // the level above it
+    level = 0;
+    while( mipmaps && ( levelwidth > 1 || levelheight > 1 ) )
+    {
+        tmp = prevbuffer;
+        prevbuffer = buffer;
+        buffer = tmp;
+        px0 = ux0;
+        py0 = uy0;
+        px1 = ux1;
+        py1 = uy1;
+        prevwidth  = levelwidth;
+        prevheight = levelheight;
+
+        level ++;
+        levelwidth  = levelwidth > 1 ? levelwidth >> 1 : 1;
+        levelheight = levelheight > 1 ? levelheight >> 1 : 1;
+
+        GetLevelSpan( x, width, level, levelwidth, &x0, &x1 );
+        GetLevelSpan( y, height, level, levelheight, &y0, &y1 );
+        GetWorkSpan( x, width, level, levelwidth, &ux0, &ux1 );
+        GetWorkSpan( y, height, level, levelheight, &uy0, &uy1 );
+
+        dst = buffer;
+        for( j = uy0; j < uy1; j ++ )
+        {
+            sy0 = prevheight == 1 ? 0 : 2 * j;
+            sy1 = prevheight == 1 ? 0 : 2 * j + 1;
+
+            for( i = ux0; i < ux1; i ++, dst += bpp )
+            {
+                sx0 = prevwidth == 1 ? 0 : 2 * i;
+                sx1 = prevwidth == 1 ? 0 : 2 * i + 1;
+
+                // Texels next to the region may need texels of the level
+                // above that were not computed, so take them from the image
+                if( sx0 < px0 || sx1 >= px1 || sy0 < py0 || sy1 >= py1 )
+                {
+                    FilterTexel( img, level, i, j, workformat, flags, bpp,
+                                 rowbuffer, dst );
+                    continue;
+                }
+
+                s00 = prevbuffer + ( (sy0 - py0) * (px1 - px0) +
+                                     (sx0 - px0) ) * bpp;
+                s01 = prevbuffer + ( (sy0 - py0) * (px1 - px0) +
+                                     (sx1 - px0) ) * bpp;
+                s10 = prevbuffer + ( (sy1 - py0) * (px1 - px0) +
+                                     (sx0 - px0) ) * bpp;
+                s11 = prevbuffer + ( (sy1 - py0) * (px1 - px0) +
+                                     (sx1 - px0) ) * bpp;
+                n = ( sx1 - sx0 + 1 ) * ( sy1 - sy0 + 1 );
+
+                for( k = 0; k < bpp; k ++ )
+                {
+                    if( n == 4 )
+                    {
+                        dst[ k ] = (unsigned char)
+                            ( ( (int) s00[ k ] + (int) s01[ k ] +
+                                (int) s10[ k ] + (int) s11[ k ] + 2 ) >> 2 );
+                    }
+                    else if( n == 2 )
+                    {
+                        dst[ k ] = (unsigned char)
+                            ( ( (int) s00[ k ] + (int) s11[ k ] + 1 ) >> 1 );
+                    }
+                    else
+                    {
+                        dst[ k ] = s00[ k ];
+                    }
+                }
+            }
+        }
+
+        UploadSpan( level, x0, y0, x1, y1, ux0, uy0, ux1, format, type,
+                    buffer );
+    }
+
+    _glfwFree( buffer );
+    _glfwFree( prevbuffer );
+    _glfwFree( rowbuffer );
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Clip a list of rectangles to an image and merge those that are cheaper
+// to upload together, returning the new number of rectangles
+//========================================================================
+
+static int MergeRects( GLFWrect *rects, int count, int width, int height )
+{
+    int i, j, x0, y0, x1, y1, merged;
+    long area;
+
+    // Clip to the image and drop empty rectangles
+    for( i = 0; i < count; i ++ )
+    {
+        x0 = rects[ i ].X > 0 ? rects[ i ].X : 0;
+        y0 = rects[ i ].Y > 0 ? rects[ i ].Y : 0;
+        x1 = rects[ i ].X + rects[ i ].Width < width ?
+             rects[ i ].X + rects[ i ].Width : width;
+        y1 = rects[ i ].Y + rects[ i ].Height < height ?
+             rects[ i ].Y + rects[ i ].Height : height;
+
+        if( x1 <= x0 || y1 <= y0 )
+        {
+            rects[ i -- ] = rects[ -- count ];
+            continue;
+        }
+
+        rects[ i ].X      = x0;
+        rects[ i ].Y      = y0;
+        rects[ i ].Width  = x1 - x0;
+        rects[ i ].Height = y1 - y0;
+    }
+
+    // Merge pairs whose bounding box wastes little upload bandwidth
+    do
+    {
+        merged = GL_FALSE;
+        for( i = 0; i < count; i ++ )
+        {
+            for( j = i + 1; j < count; j ++ )
+            {
+                x0 = rects[ i ].X < rects[ j ].X ? rects[ i ].X : rects[ j ].X;
+                y0 = rects[ i ].Y < rects[ j ].Y ? rects[ i ].Y : rects[ j ].Y;
+                x1 = rects[ i ].X + rects[ i ].Width;
+                if( rects[ j ].X + rects[ j ].Width > x1 )
+                {
+                    x1 = rects[ j ].X + rects[ j ].Width;
+                }
+                y1 = rects[ i ].Y + rects[ i ].Height;
+                if( rects[ j ].Y + rects[ j ].Height > y1 )
+                {
+                    y1 = rects[ j ].Y + rects[ j ].Height;
+                }
+
+                area = (long) rects[ i ].Width * rects[ i ].Height +
+                       (long) rects[ j ].Width * rects[ j ].Height;
+                if( (long) (x1 - x0) * (y1 - y0) * 4 > area * 5 )
+                {
+                    continue;
+                }
+
+                rects[ i ].X      = x0;
+                rects[ i ].Y      = y0;
+                rects[ i ].Width  = x1 - x0;
+                rects[ i ].Height = y1 - y0;
+                rects[ j -- ] = rects[ -- count ];
+                merged = GL_TRUE;
+            }
+        }
+    }
+    while( merged );
+
+    return count;
+}
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Upload a rectangular region of an image to the bound 2D texture
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwUpdateTextureRegion( const GLFWimage *img,
+    int x, int y, int width, int height, int flags )
+{
+    GLFWrect rect;
+
+    rect.X      = x;
+    rect.Y      = y;
+    rect.Width  = width;
+    rect.Height = height;
+
+    return glfwUpdateTextureRegions( img, &rect, 1, flags );
+}
+
+
+//========================================================================
+// Upload a list of dirty regions of an image to the bound 2D texture
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwUpdateTextureRegions( const GLFWimage *img,
+    const GLFWrect *rects, int count, int flags )
+{
+    GLint    UnpackAlignment;
+    GLFWrect *merged;
+    int      n, success;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwWin.opened )
+    {
+        return GL_FALSE;
+    }
+
+    if( count < 1 )
+    {
+        return GL_TRUE;
+    }
+
+    merged = (GLFWrect *) _glfwMalloc( count * sizeof( GLFWrect ) );
+    if( merged == NULL )
+    {
+        return GL_FALSE;
+    }
+    memcpy( merged, rects, count * sizeof( GLFWrect ) );
+    count = MergeRects( merged, count, img->Width, img->Height );
+
+    // Set unpack alignment to one byte
+    glGetIntegerv( GL_UNPACK_ALIGNMENT, &UnpackAlignment );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+    success = GL_TRUE;
+    for( n = 0; n < count && success; n ++ )
+    {
+        success = UpdateRegion( img, merged[ n ].X, merged[ n ].Y,
+                                merged[ n ].Width, merged[ n ].Height,
+                                flags );
+    }
+
+    // Restore old unpack alignment
+    glPixelStorei( GL_UNPACK_ALIGNMENT, UnpackAlignment );
+
+    _glfwFree( merged );
+
+    return success;
+}
@@ -31,17 +31,27 @@
 //========================================================================
 // Description:
 //
-// TGA format image file loader. This module supports version 1 Targa
-// images, with these restrictions:
+// TGA format image file loader and writer. This module supports version
+// 1 Targa images, with these restrictions:
 //  - Pixel format may only be 8, 24 or 32 bits
 //  - Colormaps must be no longer than 256 entries
 //
+// Written images are always true color or grayscale, optionally run-length
+// encoded.
+//
 //========================================================================
 
 
 #include "internal.h"
 
 
+// Pixel formats that may be missing from old OpenGL headers
+#ifndef GL_VERSION_1_2
+ #define GL_BGR  0x80E0
+ #define GL_BGRA 0x80E1
+#endif // GL_VERSION_1_2
+
+
 //************************************************************************
 //****            GLFW internal functions & declarations              ****
 //************************************************************************
@@ -227,7 +237,7 @@ int _glfwReadTGA( _GLFWstream *s, GLFWimage *img, int flags )
         }
 
         // Allocate memory for colormap
-        cmap = (unsigned char *) malloc( cmapsize );
+        cmap = (unsigned char *) _glfwAllocPixels( cmapsize );
         if( cmap == NULL )
         {
             return 0;
@@ -262,12 +272,12 @@ int _glfwReadTGA( _GLFWstream *s, GLFWimage *img, int flags )
     pixsize2 = h.width * h.height * bpp2;
 
     // Allocate memory for pixel data
-    pix = (unsigned char *) malloc( pixsize2 );
+    pix = (unsigned char *) _glfwAllocPixels( pixsize2 );
     if( pix == NULL )
     {
         if( cmap )
         {
-            free( cmap );
+            _glfwFreePixels( cmap );
         }
         return 0;
     }
@@ -372,7 +382,7 @@ int _glfwReadTGA( _GLFWstream *s, GLFWimage *img, int flags )
         }
 
         // Free memory for colormap (it's not needed anymore)
-        free( cmap );
+        _glfwFreePixels( cmap );
     }
     else
     {
@@ -401,3 +411,144 @@ int _glfwReadTGA( _GLFWstream *s, GLFWimage *img, int flags )
 
     return 1;
 }
+
+
+//========================================================================
+// Run-Length Encode one row of pixels (packets never cross rows).
+// Returns the number of encoded bytes
+//========================================================================
+
+static int WriteTGA_RLE( unsigned char *dst, const unsigned char *src,
+                         int width, int bpp )
+{
+    unsigned char *start = dst;
+    int run, raw, x;
+
+    x = 0;
+    while( x < width )
+    {
+        // Count identical pixels, starting at this one
+        for( run = 1; x + run < width && run < 128; run ++ )
+        {
+            if( memcmp( src + x*bpp, src + (x+run)*bpp, bpp ) )
+            {
+                break;
+            }
+        }
+
+        // Run-Length packet?
+        if( run > 1 )
+        {
+            *dst ++ = (unsigned char) (128 | (run - 1));
+            memcpy( dst, src + x*bpp, bpp );
+            dst += bpp;
+            x += run;
+            continue;
+        }
+
+        // It's a Raw packet, which ends where the next run starts
+        for( raw = 1; x + raw < width && raw < 128; raw ++ )
+        {
+            if( x + raw + 1 < width &&
+                !memcmp( src + (x+raw)*bpp, src + (x+raw+1)*bpp, bpp ) )
+            {
+                break;
+            }
+        }
+        *dst ++ = (unsigned char) (raw - 1);
+        memcpy( dst, src + x*bpp, raw*bpp );
+        dst += raw*bpp;
+        x += raw;
+    }
+
+    return (int) (dst - start);
+}
+
+
+//========================================================================
+// Write a TGA image to a file. The pixels may be RGB(A), BGR(A) or a
+// single channel, with the bottom row first unless GLFW_ORIGIN_UL_BIT is
+// set. GLFW_COMPRESS_BIT selects Run-Length Encoding
+//========================================================================
+
+int _glfwWriteTGA( FILE *file, const GLFWimage *img, int flags )
+{
+    unsigned char buf[ 18 ], *row, *packets, tmp;
+    const unsigned char *src;
+    int bpp, rowsize, size, m, n, swap, success;
+
+    bpp = img->BytesPerPixel;
+    if( (bpp != 1 && bpp != 3 && bpp != 4) ||
+        img->Width < 1 || img->Width > 65535 ||
+        img->Height < 1 || img->Height > 65535 )
+    {
+        return GL_FALSE;
+    }
+
+    // Build TGA header (endian independent)
+    memset( buf, 0, sizeof(buf) );
+    buf[2]  = (unsigned char) (bpp == 1 ? _TGA_IMAGETYPE_GRAY :
+                                          _TGA_IMAGETYPE_TC);
+    if( flags & GLFW_COMPRESS_BIT )
+    {
+        buf[2] += _TGA_IMAGETYPE_TC_RLE - _TGA_IMAGETYPE_TC;
+    }
+    buf[12] = (unsigned char) (img->Width & 255);
+    buf[13] = (unsigned char) (img->Width >> 8);
+    buf[14] = (unsigned char) (img->Height & 255);
+    buf[15] = (unsigned char) (img->Height >> 8);
+    buf[16] = (unsigned char) (bpp * 8);
+    buf[17] = (unsigned char) ((bpp == 4 ? 8 : 0) |
+              (((flags & GLFW_ORIGIN_UL_BIT) ? _TGA_ORIGIN_UL :
+                _TGA_ORIGIN_BL) << _TGA_IMAGEINFO_ORIGIN_SHIFT));
+
+    if( fwrite( buf, 1, 18, file ) != 18 )
+    {
+        return GL_FALSE;
+    }
+
+    // Allocate memory for one row, and for its worst case RLE packets
+    rowsize = img->Width * bpp;
+    row = (unsigned char *) _glfwMallocAs( rowsize + rowsize + img->Width,
+                                           GLFW_MEMORY_IMAGE );
+    if( row == NULL )
+    {
+        return GL_FALSE;
+    }
+    packets = row + rowsize;
+
+    // TGA stores BGR/BGRA pixels
+    swap = bpp > 1 && img->Format != GL_BGR && img->Format != GL_BGRA;
+
+    success = GL_TRUE;
+    src = img->Data;
+    for( n = 0; n < img->Height && success; n ++ )
+    {
+        memcpy( row, src, rowsize );
+        src += rowsize;
+
+        if( swap )
+        {
+            for( m = 0; m < rowsize; m += bpp )
+            {
+                tmp        = row[ m ];
+                row[ m ]   = row[ m+2 ];
+                row[ m+2 ] = tmp;
+            }
+        }
+
+        if( flags & GLFW_COMPRESS_BIT )
+        {
+            size = WriteTGA_RLE( packets, row, img->Width, bpp );
+            success = fwrite( packets, 1, size, file ) == (size_t) size;
+        }
+        else
+        {
+            success = fwrite( row, 1, rowsize, file ) == (size_t) rowsize;
+        }
+    }
+
+    _glfwFree( row );
+
+    return success;
+}
@@ -31,6 +31,61 @@
 #include "internal.h"
 
 
+// Reader-writer lock state bits. The low bits count the readers
+#define _GLFW_RWLOCK_WRITER   0x40000000L  // A writer holds the lock
+#define _GLFW_RWLOCK_PENDING  0x20000000L  // Writers wait, so readers must too
+#define _GLFW_RWLOCK_WAITING  0x10000000L  // Readers wait for the writer
+#define _GLFW_RWLOCK_READERS  0x0fffffffL
+
+// Attempts to take a semaphore or pass a barrier before sleeping
+#define _GLFW_SYNC_SPIN 100
+
+//========================================================================
+// Semaphore. Count is the number of available units, or minus the
+// number of waiting threads when none are available. Each post that
+// finds a waiter hands it exactly one wakeup
+//========================================================================
+
+typedef struct {
+    volatile long Count;
+    GLFWmutex     Mutex;
+    GLFWcond      Cond;
+    int           Wakeups;         // Protected by mutex
+} _GLFWsemaphore;
+
+
+//========================================================================
+// Barrier. The last thread to arrive starts a new generation, which
+// releases the others
+//========================================================================
+
+typedef struct {
+    long          Count;
+    volatile long Arrived;
+    volatile long Generation;
+    volatile long Sleepers;
+    GLFWmutex     Mutex;
+    GLFWcond      Cond;
+} _GLFWbarrier;
+
+
+//========================================================================
+// Reader-writer lock. The state word is only changed atomically, and is
+// all that uncontended locking touches. Threads that have to wait do so
+// on the mutex and condition variables
+//========================================================================
+
+typedef struct {
+    volatile long State;
+    GLFWmutex     Mutex;
+    GLFWcond      ReadCond;
+    GLFWcond      WriteCond;
+    int           WaitingReaders;  // Protected by mutex
+    int           WaitingWriters;  // Protected by mutex
+    int           ReadPhase;       // Protected by mutex
+} _GLFWrwlock;
+
+
 
 //************************************************************************
 //****                  GLFW internal functions                       ****
@@ -44,7 +99,15 @@ _GLFWthread * _glfwGetThreadPointer( int ID )
 {
     _GLFWthread *t;
 
-    for( t = &_glfwThrd.First; t != NULL; t = t->Next )
+    if( ID == _glfwThrd.First.ID )
+    {
+        return &_glfwThrd.First;
+    }
+
+    // Thread IDs are handed out in sequence, so the low bits make a
+    // perfect hash for as many threads as there are buckets
+    for( t = _glfwThrd.Buckets[ ID & ( _GLFW_THREAD_BUCKETS - 1 ) ];
+         t != NULL; t = t->HashNext )
     {
         if( t->ID == ID )
         {
@@ -62,16 +125,20 @@ _GLFWthread * _glfwGetThreadPointer( int ID )
 
 void _glfwAppendThread( _GLFWthread * t )
 {
-    _GLFWthread *t_tmp;
+    _GLFWthread **bucket;
 
-    t_tmp = &_glfwThrd.First;
-    while( t_tmp->Next != NULL )
+    // The list is unordered, so insert right after the main thread
+    t->Previous = &_glfwThrd.First;
+    t->Next     = _glfwThrd.First.Next;
+    if( t->Next != NULL )
     {
-        t_tmp = t_tmp->Next;
+        t->Next->Previous = t;
     }
-    t_tmp->Next = t;
-    t->Previous = t_tmp;
-    t->Next     = NULL;
+    _glfwThrd.First.Next = t;
+
+    bucket = &_glfwThrd.Buckets[ t->ID & ( _GLFW_THREAD_BUCKETS - 1 ) ];
+    t->HashNext = *bucket;
+    *bucket = t;
 }
 
 
@@ -81,6 +148,8 @@ void _glfwAppendThread( _GLFWthread * t )
 
 void _glfwRemoveThread( _GLFWthread * t )
 {
+    _GLFWthread **link;
+
     if( t->Previous != NULL )
     {
         t->Previous->Next = t->Next;
@@ -89,10 +158,62 @@ void _glfwRemoveThread( _GLFWthread * t )
     {
         t->Next->Previous = t->Previous;
     }
-    free( (void *) t );
+
+    link = &_glfwThrd.Buckets[ t->ID & ( _GLFW_THREAD_BUCKETS - 1 ) ];
+    while( *link != NULL )
+    {
+        if( *link == t )
+        {
+            *link = t->HashNext;
+            break;
+        }
+        link = &(*link)->HashNext;
+    }
+
+    _glfwFree( (void *) t );
 }
 
 
+#if !defined( _GLFW_HAS_STATIC_SYNC )
+
+//========================================================================
+// Return the object behind a static mutex or condition variable, creating
+// it on first use (for platforms where they can not be used as they are)
+//========================================================================
+
+static void * GetStaticHandle( volatile long *once, void **handle,
+                               int cond )
+{
+    // Once is 0 before creation, 1 during creation and 2 after it
+    if( _glfwPlatformAtomicAdd( once, 0 ) != 2 )
+    {
+        if( _glfwPlatformAtomicCompareSwap( once, 0, 1 ) == 0 )
+        {
+            if( cond )
+            {
+                *handle = (void *) _glfwPlatformCreateCond();
+            }
+            else
+            {
+                *handle = (void *) _glfwPlatformCreateMutex();
+            }
+            _glfwPlatformAtomicAdd( once, 1 );
+        }
+        else
+        {
+            while( _glfwPlatformAtomicAdd( once, 0 ) != 2 )
+            {
+                _glfwPlatformSleep( 0.0 );
+            }
+        }
+    }
+
+    return *handle;
+}
+
+#endif // _GLFW_HAS_STATIC_SYNC
+
+
 
 //************************************************************************
 //****                     GLFW user functions                        ****
@@ -112,7 +233,33 @@ GLFWAPI GLFWthread GLFWAPIENTRY glfwCreateThread( GLFWthreadfun fun,
     }
 
     // Return the GLFW thread ID
-    return _glfwPlatformCreateThread( fun, arg );
+    return _glfwPlatformCreateThread( fun, arg, NULL );
+}
+
+
+//========================================================================
+// Create a new thread with the given attributes
+//========================================================================
+
+GLFWAPI GLFWthread GLFWAPIENTRY glfwCreateThreadEx( GLFWthreadfun fun,
+    void *arg, const GLFWthreadattr *attr )
+{
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return -1;
+    }
+
+    if( attr != NULL && ( attr->StackSize < 0 ||
+        attr->Policy < GLFW_SCHED_NORMAL || attr->Policy > GLFW_SCHED_RR ||
+        attr->Priority < GLFW_PRIORITY_LOWEST ||
+        attr->Priority > GLFW_PRIORITY_HIGHEST ) )
+    {
+        return -1;
+    }
+
+    // Return the GLFW thread ID
+    return _glfwPlatformCreateThread( fun, arg, attr );
 }
 
 
@@ -139,6 +286,24 @@ GLFWAPI void GLFWAPIENTRY glfwDestroyThread( GLFWthread ID )
 }
 
 
+//========================================================================
+// Restrict a thread to a set of processors. An empty set allows all of
+// them again
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwSetThreadAffinity( GLFWthread ID,
+    const GLFWcpumask *mask )
+{
+    // Is GLFW initialized?
+    if( !_glfwInitialized || ID < 0 || mask == NULL )
+    {
+        return GL_FALSE;
+    }
+
+    return _glfwPlatformSetThreadAffinity( ID, mask );
+}
+
+
 //========================================================================
 // Wait for a thread to die
 //========================================================================
@@ -277,16 +442,16 @@ GLFWAPI void GLFWAPIENTRY glfwDestroyCond( GLFWcond cond )
 // Wait for a condition to be raised
 //========================================================================
 
-GLFWAPI void GLFWAPIENTRY glfwWaitCond( GLFWcond cond, GLFWmutex mutex,
-                                        double timeout )
+GLFWAPI int GLFWAPIENTRY glfwWaitCond( GLFWcond cond, GLFWmutex mutex,
+                                       double timeout )
 {
     // Initialized & valid condition variable and mutex?
     if( !_glfwInitialized || !cond || !mutex )
     {
-        return;
+        return GL_FALSE;
     }
 
-    _glfwPlatformWaitCond( cond, mutex, timeout );
+    return _glfwPlatformWaitCond( cond, mutex, timeout );
 }
 
 
@@ -322,6 +487,681 @@ GLFWAPI void GLFWAPIENTRY glfwBroadcastCond( GLFWcond cond )
 }
 
 
+//========================================================================
+// Request access to a static mutex
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwLockStaticMutex( GLFWstaticmutex *mutex )
+{
+#if !defined( _GLFW_HAS_STATIC_SYNC )
+    void *handle;
+#endif
+
+    // Initialized & valid mutex?
+    if( !_glfwInitialized || !mutex )
+    {
+        return;
+    }
+
+#if defined( _GLFW_HAS_STATIC_SYNC )
+    _glfwPlatformLockStaticMutex( mutex );
+#else
+    handle = GetStaticHandle( &mutex->Once, &mutex->Handle, GL_FALSE );
+    if( handle )
+    {
+        _glfwPlatformLockMutex( (GLFWmutex) handle );
+    }
+#endif
+}
+
+
+//========================================================================
+// Release a static mutex
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwUnlockStaticMutex( GLFWstaticmutex *mutex )
+{
+    // Initialized & valid mutex?
+    if( !_glfwInitialized || !mutex )
+    {
+        return;
+    }
+
+#if defined( _GLFW_HAS_STATIC_SYNC )
+    _glfwPlatformUnlockStaticMutex( mutex );
+#else
+    // The mutex must have been locked, so it has been created
+    if( mutex->Handle )
+    {
+        _glfwPlatformUnlockMutex( (GLFWmutex) mutex->Handle );
+    }
+#endif
+}
+
+
+//========================================================================
+// Wait for a static condition to be raised. Returns GL_FALSE if the wait
+// timed out
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwWaitStaticCond( GLFWstaticcond *cond,
+    GLFWstaticmutex *mutex, double timeout )
+{
+#if !defined( _GLFW_HAS_STATIC_SYNC )
+    void *handle;
+#endif
+
+    // Initialized & valid condition variable and mutex?
+    if( !_glfwInitialized || !cond || !mutex )
+    {
+        return GL_FALSE;
+    }
+
+#if defined( _GLFW_HAS_STATIC_SYNC )
+    return _glfwPlatformWaitStaticCond( cond, mutex, timeout );
+#else
+    handle = GetStaticHandle( &cond->Once, &cond->Handle, GL_TRUE );
+    if( !handle || !mutex->Handle )
+    {
+        return GL_FALSE;
+    }
+
+    return _glfwPlatformWaitCond( (GLFWcond) handle,
+                                  (GLFWmutex) mutex->Handle, timeout );
+#endif
+}
+
+
+//========================================================================
+// Signal a static condition to one waiting thread
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwSignalStaticCond( GLFWstaticcond *cond )
+{
+#if !defined( _GLFW_HAS_STATIC_SYNC )
+    void *handle;
+#endif
+
+    // Initialized & valid condition variable?
+    if( !_glfwInitialized || !cond )
+    {
+        return;
+    }
+
+#if defined( _GLFW_HAS_STATIC_SYNC )
+    _glfwPlatformSignalStaticCond( cond );
+#else
+    handle = GetStaticHandle( &cond->Once, &cond->Handle, GL_TRUE );
+    if( handle )
+    {
+        _glfwPlatformSignalCond( (GLFWcond) handle );
+    }
+#endif
+}
+
+
+//========================================================================
+// Broadcast a static condition to all waiting threads
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwBroadcastStaticCond( GLFWstaticcond *cond )
+{
+#if !defined( _GLFW_HAS_STATIC_SYNC )
+    void *handle;
+#endif
+
+    // Initialized & valid condition variable?
+    if( !_glfwInitialized || !cond )
+    {
+        return;
+    }
+
+#if defined( _GLFW_HAS_STATIC_SYNC )
+    _glfwPlatformBroadcastStaticCond( cond );
+#else
+    handle = GetStaticHandle( &cond->Once, &cond->Handle, GL_TRUE );
+    if( handle )
+    {
+        _glfwPlatformBroadcastCond( (GLFWcond) handle );
+    }
+#endif
+}
+
+
+//========================================================================
+// Create a reader-writer lock
+//========================================================================
+
+GLFWAPI GLFWrwlock GLFWAPIENTRY glfwCreateRWLock( void )
+{
+    _GLFWrwlock *lock;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return (GLFWrwlock) 0;
+    }
+
+    lock = (_GLFWrwlock *) _glfwCallocAs( 1, sizeof( _GLFWrwlock ),
+                                          GLFW_MEMORY_SYNC );
+    if( !lock )
+    {
+        return (GLFWrwlock) 0;
+    }
+
+    lock->Mutex     = _glfwPlatformCreateMutex();
+    lock->ReadCond  = _glfwPlatformCreateCond();
+    lock->WriteCond = _glfwPlatformCreateCond();
+    if( !lock->Mutex || !lock->ReadCond || !lock->WriteCond )
+    {
+        glfwDestroyRWLock( (GLFWrwlock) lock );
+        return (GLFWrwlock) 0;
+    }
+
+    return (GLFWrwlock) lock;
+}
+
+
+//========================================================================
+// Destroy a reader-writer lock
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwDestroyRWLock( GLFWrwlock rwlock )
+{
+    _GLFWrwlock *lock = (_GLFWrwlock *) rwlock;
+
+    // Initialized & valid lock?
+    if( !_glfwInitialized || !lock )
+    {
+        return;
+    }
+
+    if( lock->Mutex )
+    {
+        _glfwPlatformDestroyMutex( lock->Mutex );
+    }
+    if( lock->ReadCond )
+    {
+        _glfwPlatformDestroyCond( lock->ReadCond );
+    }
+    if( lock->WriteCond )
+    {
+        _glfwPlatformDestroyCond( lock->WriteCond );
+    }
+    _glfwFree( lock );
+}
+
+
+//========================================================================
+// Request shared access to a reader-writer lock. Readers wait while a
+// writer holds the lock or is waiting for it, except for those that were
+// already waiting when the last writer released it
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwReadLock( GLFWrwlock rwlock )
+{
+    _GLFWrwlock *lock = (_GLFWrwlock *) rwlock;
+    long        state;
+    int         phase, admitted = GL_FALSE;
+
+    // Initialized & valid lock?
+    if( !_glfwInitialized || !lock )
+    {
+        return;
+    }
+
+    // Only other readers can be in the way here
+    state = lock->State;
+    while( !( state & ( _GLFW_RWLOCK_WRITER | _GLFW_RWLOCK_PENDING |
+                        _GLFW_RWLOCK_WAITING ) ) )
+    {
+        if( _glfwPlatformAtomicCompareSwap( &lock->State, state,
+                                            state + 1 ) == state )
+        {
+            return;
+        }
+        state = lock->State;
+    }
+
+    _glfwPlatformLockMutex( lock->Mutex );
+
+    for( ;; )
+    {
+        state = lock->State;
+        if( !( state & _GLFW_RWLOCK_WRITER ) &&
+            ( admitted || !( state & _GLFW_RWLOCK_PENDING ) ) )
+        {
+            if( _glfwPlatformAtomicCompareSwap( &lock->State, state,
+                                                state + 1 ) == state )
+            {
+                break;
+            }
+            continue;
+        }
+
+        // Let the holder know there are readers to wake. If the state
+        // changed meanwhile, look at it again instead
+        if( _glfwPlatformAtomicCompareSwap( &lock->State, state,
+                state | _GLFW_RWLOCK_WAITING ) != state )
+        {
+            continue;
+        }
+
+        phase = lock->ReadPhase;
+        lock->WaitingReaders ++;
+        _glfwPlatformWaitCond( lock->ReadCond, lock->Mutex, GLFW_INFINITY );
+        lock->WaitingReaders --;
+        admitted = ( lock->ReadPhase != phase );
+    }
+
+    _glfwPlatformUnlockMutex( lock->Mutex );
+}
+
+
+//========================================================================
+// Release shared access to a reader-writer lock
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwReadUnlock( GLFWrwlock rwlock )
+{
+    _GLFWrwlock *lock = (_GLFWrwlock *) rwlock;
+    long        state;
+
+    // Initialized & valid lock?
+    if( !_glfwInitialized || !lock )
+    {
+        return;
+    }
+
+    state = _glfwPlatformAtomicAdd( &lock->State, -1 );
+
+    // The last reader out hands the lock to a waiting writer
+    if( !( state & _GLFW_RWLOCK_READERS ) &&
+        ( state & _GLFW_RWLOCK_PENDING ) )
+    {
+        _glfwPlatformLockMutex( lock->Mutex );
+        _glfwPlatformSignalCond( lock->WriteCond );
+        _glfwPlatformUnlockMutex( lock->Mutex );
+    }
+}
+
+
+//========================================================================
+// Request exclusive access to a reader-writer lock
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwWriteLock( GLFWrwlock rwlock )
+{
+    _GLFWrwlock *lock = (_GLFWrwlock *) rwlock;
+    long        state, desired;
+
+    // Initialized & valid lock?
+    if( !_glfwInitialized || !lock )
+    {
+        return;
+    }
+
+    if( _glfwPlatformAtomicCompareSwap( &lock->State, 0,
+                                        _GLFW_RWLOCK_WRITER ) == 0 )
+    {
+        return;
+    }
+
+    _glfwPlatformLockMutex( lock->Mutex );
+
+    lock->WaitingWriters ++;
+
+    for( ;; )
+    {
+        state = lock->State;
+        if( !( state & ( _GLFW_RWLOCK_WRITER | _GLFW_RWLOCK_READERS ) ) )
+        {
+            // Keep new readers out for as long as other writers wait
+            desired = ( state & _GLFW_RWLOCK_WAITING ) | _GLFW_RWLOCK_WRITER;
+            if( lock->WaitingWriters > 1 )
+            {
+                desired |= _GLFW_RWLOCK_PENDING;
+            }
+
+            if( _glfwPlatformAtomicCompareSwap( &lock->State, state,
+                                                desired ) == state )
+            {
+                break;
+            }
+            continue;
+        }
+
+        // Keep new readers out, so that we will get the lock eventually
+        if( !( state & _GLFW_RWLOCK_PENDING ) &&
+            _glfwPlatformAtomicCompareSwap( &lock->State, state,
+                state | _GLFW_RWLOCK_PENDING ) != state )
+        {
+            continue;
+        }
+
+        _glfwPlatformWaitCond( lock->WriteCond, lock->Mutex, GLFW_INFINITY );
+    }
+
+    lock->WaitingWriters --;
+
+    _glfwPlatformUnlockMutex( lock->Mutex );
+}
+
+
+//========================================================================
+// Release exclusive access to a reader-writer lock. Readers that were
+// waiting go first, then the next writer
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwWriteUnlock( GLFWrwlock rwlock )
+{
+    _GLFWrwlock *lock = (_GLFWrwlock *) rwlock;
+    long        state;
+
+    // Initialized & valid lock?
+    if( !_glfwInitialized || !lock )
+    {
+        return;
+    }
+
+    do
+    {
+        state = lock->State;
+    }
+    while( _glfwPlatformAtomicCompareSwap( &lock->State, state,
+               state & ~( _GLFW_RWLOCK_WRITER | _GLFW_RWLOCK_WAITING ) )
+           != state );
+
+    if( state & ( _GLFW_RWLOCK_PENDING | _GLFW_RWLOCK_WAITING ) )
+    {
+        _glfwPlatformLockMutex( lock->Mutex );
+        if( lock->WaitingReaders > 0 )
+        {
+            lock->ReadPhase ++;
+            _glfwPlatformBroadcastCond( lock->ReadCond );
+        }
+        else
+        {
+            _glfwPlatformSignalCond( lock->WriteCond );
+        }
+        _glfwPlatformUnlockMutex( lock->Mutex );
+    }
+}
+
+
+//========================================================================
+// Create a semaphore with count available units
+//========================================================================
+
+GLFWAPI GLFWsemaphore GLFWAPIENTRY glfwCreateSemaphore( int count )
+{
+    _GLFWsemaphore *sem;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || count < 0 )
+    {
+        return (GLFWsemaphore) 0;
+    }
+
+    sem = (_GLFWsemaphore *) _glfwCallocAs( 1, sizeof( _GLFWsemaphore ),
+                                            GLFW_MEMORY_SYNC );
+    if( !sem )
+    {
+        return (GLFWsemaphore) 0;
+    }
+
+    sem->Count = count;
+    sem->Mutex = _glfwPlatformCreateMutex();
+    sem->Cond  = _glfwPlatformCreateCond();
+    if( !sem->Mutex || !sem->Cond )
+    {
+        glfwDestroySemaphore( (GLFWsemaphore) sem );
+        return (GLFWsemaphore) 0;
+    }
+
+    return (GLFWsemaphore) sem;
+}
+
+
+//========================================================================
+// Destroy a semaphore
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwDestroySemaphore( GLFWsemaphore semaphore )
+{
+    _GLFWsemaphore *sem = (_GLFWsemaphore *) semaphore;
+
+    // Initialized & valid semaphore?
+    if( !_glfwInitialized || !sem )
+    {
+        return;
+    }
+
+    if( sem->Mutex )
+    {
+        _glfwPlatformDestroyMutex( sem->Mutex );
+    }
+    if( sem->Cond )
+    {
+        _glfwPlatformDestroyCond( sem->Cond );
+    }
+    _glfwFree( sem );
+}
+
+
+//========================================================================
+// Release one unit of a semaphore, waking one waiting thread if any
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwPostSemaphore( GLFWsemaphore semaphore )
+{
+    _GLFWsemaphore *sem = (_GLFWsemaphore *) semaphore;
+
+    // Initialized & valid semaphore?
+    if( !_glfwInitialized || !sem )
+    {
+        return;
+    }
+
+    if( _glfwPlatformAtomicAdd( &sem->Count, 1 ) <= 0 )
+    {
+        _glfwPlatformLockMutex( sem->Mutex );
+        sem->Wakeups ++;
+        _glfwPlatformSignalCond( sem->Cond );
+        _glfwPlatformUnlockMutex( sem->Mutex );
+    }
+}
+
+
+//========================================================================
+// Take one unit of a semaphore if one is available without waiting
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwTryWaitSemaphore( GLFWsemaphore semaphore )
+{
+    _GLFWsemaphore *sem = (_GLFWsemaphore *) semaphore;
+    long           count;
+
+    // Initialized & valid semaphore?
+    if( !_glfwInitialized || !sem )
+    {
+        return GL_FALSE;
+    }
+
+    for( count = sem->Count;  count > 0;  count = sem->Count )
+    {
+        if( _glfwPlatformAtomicCompareSwap( &sem->Count, count,
+                                            count - 1 ) == count )
+        {
+            return GL_TRUE;
+        }
+    }
+
+    return GL_FALSE;
+}
+
+
+//========================================================================
+// Take one unit of a semaphore, waiting until one is available
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwWaitSemaphore( GLFWsemaphore semaphore )
+{
+    _GLFWsemaphore *sem = (_GLFWsemaphore *) semaphore;
+    int            spin;
+
+    // Initialized & valid semaphore?
+    if( !_glfwInitialized || !sem )
+    {
+        return;
+    }
+
+    // A unit is often posted shortly, so look for one for a while
+    for( spin = 0;  spin < _GLFW_SYNC_SPIN;  spin ++ )
+    {
+        if( glfwTryWaitSemaphore( semaphore ) )
+        {
+            return;
+        }
+    }
+
+    // Take a unit, or register as a waiter if there are none
+    if( _glfwPlatformAtomicAdd( &sem->Count, -1 ) >= 0 )
+    {
+        return;
+    }
+
+    _glfwPlatformLockMutex( sem->Mutex );
+    while( sem->Wakeups == 0 )
+    {
+        _glfwPlatformWaitCond( sem->Cond, sem->Mutex, GLFW_INFINITY );
+    }
+    sem->Wakeups --;
+    _glfwPlatformUnlockMutex( sem->Mutex );
+}
+
+
+//========================================================================
+// Create a barrier for count threads
+//========================================================================
+
+GLFWAPI GLFWbarrier GLFWAPIENTRY glfwCreateBarrier( int count )
+{
+    _GLFWbarrier *barrier;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || count < 1 )
+    {
+        return (GLFWbarrier) 0;
+    }
+
+    barrier = (_GLFWbarrier *) _glfwCallocAs( 1, sizeof( _GLFWbarrier ),
+                                              GLFW_MEMORY_SYNC );
+    if( !barrier )
+    {
+        return (GLFWbarrier) 0;
+    }
+
+    barrier->Count = count;
+    barrier->Mutex = _glfwPlatformCreateMutex();
+    barrier->Cond  = _glfwPlatformCreateCond();
+    if( !barrier->Mutex || !barrier->Cond )
+    {
+        glfwDestroyBarrier( (GLFWbarrier) barrier );
+        return (GLFWbarrier) 0;
+    }
+
+    return (GLFWbarrier) barrier;
+}
+
+
+//========================================================================
+// Destroy a barrier
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwDestroyBarrier( GLFWbarrier barrier )
+{
+    _GLFWbarrier *b = (_GLFWbarrier *) barrier;
+
+    // Initialized & valid barrier?
+    if( !_glfwInitialized || !b )
+    {
+        return;
+    }
+
+    if( b->Mutex )
+    {
+        _glfwPlatformDestroyMutex( b->Mutex );
+    }
+    if( b->Cond )
+    {
+        _glfwPlatformDestroyCond( b->Cond );
+    }
+    _glfwFree( b );
+}
+
+
+//========================================================================
+// Wait until all threads of a barrier have arrived at it. Returns GL_TRUE
+// to exactly one of them, and GL_FALSE to the others. The barrier may be
+// used again at once
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwBarrierWait( GLFWbarrier barrier )
+{
+    _GLFWbarrier *b = (_GLFWbarrier *) barrier;
+    long         generation;
+    int          spin;
+
+    // Initialized & valid barrier?
+    if( !_glfwInitialized || !b )
+    {
+        return GL_FALSE;
+    }
+
+    // The generation can not change before we have arrived
+    generation = _glfwPlatformAtomicAdd( &b->Generation, 0 );
+
+    if( _glfwPlatformAtomicAdd( &b->Arrived, 1 ) == b->Count )
+    {
+        // Everyone else is waiting for the generation to change, so the
+        // count can be reset first
+        _glfwPlatformAtomicAdd( &b->Arrived, -b->Count );
+        _glfwPlatformAtomicAdd( &b->Generation, 1 );
+
+        if( b->Sleepers > 0 )
+        {
+            _glfwPlatformLockMutex( b->Mutex );
+            _glfwPlatformBroadcastCond( b->Cond );
+            _glfwPlatformUnlockMutex( b->Mutex );
+        }
+
+        return GL_TRUE;
+    }
+
+    for( spin = 0;  spin < _GLFW_SYNC_SPIN;  spin ++ )
+    {
+        if( b->Generation != generation )
+        {
+            return GL_FALSE;
+        }
+    }
+
+    // Announce that we are about to sleep before looking a last time, so
+    // that the last thread to arrive after that look will wake us up
+    _glfwPlatformLockMutex( b->Mutex );
+    _glfwPlatformAtomicAdd( &b->Sleepers, 1 );
+    while( _glfwPlatformAtomicAdd( &b->Generation, 0 ) == generation )
+    {
+        _glfwPlatformWaitCond( b->Cond, b->Mutex, GLFW_INFINITY );
+    }
+    _glfwPlatformAtomicAdd( &b->Sleepers, -1 );
+    _glfwPlatformUnlockMutex( b->Mutex );
+
+    return GL_FALSE;
+}
+
+
 //========================================================================
 // Return the number of processors in the system. This information can be
 // useful for determining the optimal number of threads to use for
@@ -0,0 +1,777 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+//========================================================================
+// Description:
+//
+// This module implements a work-stealing thread pool. Every worker owns a
+// Chase-Lev deque that only it pushes to and pops from, at the bottom,
+// while idle threads steal from the top with a single compare-and-swap,
+// so running jobs never takes a lock. Jobs submitted from threads outside
+// the pool go to a shared deque, which only takes a lock for pushing.
+//
+// Parallel loops are split lazily: a thread running a range pushes the
+// upper half of it for others to steal until the range is no larger than
+// the grain size, so ranges are only split as far as there are idle
+// threads to take them.
+//
+// Idle workers park on a condition variable. Threads that push jobs only
+// touch the lock when the count of parked workers shows that someone is
+// asleep, so a busy pool never takes it at all.
+//
+//========================================================================
+
+
+#include "internal.h"
+
+
+// Maximum number of worker threads in a pool
+#define _GLFW_MAX_POOL_THREADS 64
+
+// Capacity of each deque (must be a power of two). A thread whose deque
+// is full runs the job at once instead
+#define _GLFW_DEQUE_SIZE 1024
+
+// Rounds of stealing attempts before an idle worker parks
+#define _GLFW_STEAL_ROUNDS 4
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+//========================================================================
+// A parallel loop, shared by all of its range jobs
+//========================================================================
+
+typedef struct {
+    GLFWrangefun  fun;
+    void          *arg;
+    int           grain;
+    volatile long pending;      // Range jobs not yet finished
+} _GLFWloop;
+
+
+//========================================================================
+// A job, either a function call or a range of a parallel loop
+//========================================================================
+
+typedef struct {
+    GLFWjobfun    fun;          // Job function, or NULL for a range
+    void          *arg;         // Job argument, or the loop of a range
+    int           first, last;  // Range of loop indices
+    volatile long *pending;     // Counter to decrement when done
+} _GLFWjob;
+
+
+//========================================================================
+// Chase-Lev work-stealing deque. Top and bottom are kept on separate
+// cache lines, as one is written by thieves and the other by the owner
+//========================================================================
+
+typedef struct {
+    volatile long top;
+    char          pad1[ 64 - sizeof( long ) ];
+    volatile long bottom;
+    char          pad2[ 64 - sizeof( long ) ];
+    _GLFWjob      jobs[ _GLFW_DEQUE_SIZE ];
+} _GLFWdeque;
+
+
+//========================================================================
+// Worker thread
+//========================================================================
+
+struct _GLFWthreadpool_struct;
+
+typedef struct {
+    _GLFWdeque    deque;
+    struct _GLFWthreadpool_struct *pool;
+    GLFWthread    thread;
+    unsigned int  seed;         // Random state for choosing victims
+} _GLFWworker;
+
+
+//========================================================================
+// Thread pool
+//========================================================================
+
+typedef struct _GLFWthreadpool_struct {
+    _GLFWworker   *workers;
+    int           count;
+
+    _GLFWdeque    external;     // Jobs submitted from other threads
+    GLFWmutex     externalLock; // Serializes pushes to the external deque
+
+    volatile long pending;      // Submitted jobs not yet finished
+    volatile long sleepers;     // Workers parked or about to park
+    volatile int  quit;         // Tells workers to exit
+
+    GLFWmutex     mutex;        // Protects parking and waiting
+    GLFWcond      work;         // Signalled when jobs are pushed
+    GLFWcond      done;         // Broadcast when a job counter hits zero
+} _GLFWthreadpool;
+
+
+//========================================================================
+// Push a job at the bottom of a deque (owner only). Returns GL_FALSE if
+// the deque is full
+//========================================================================
+
+static int PushJob( _GLFWdeque *d, const _GLFWjob *job )
+{
+    long b, t;
+
+    b = d->bottom;
+    t = d->top;
+    if( b - t >= _GLFW_DEQUE_SIZE - 1 )
+    {
+        return GL_FALSE;
+    }
+
+    d->jobs[ b & ( _GLFW_DEQUE_SIZE - 1 ) ] = *job;
+
+    // The atomic increment also makes the job visible before the new
+    // bottom, and orders the push before any later read of the sleepers
+    _glfwPlatformAtomicAdd( &d->bottom, 1 );
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Pop a job from the bottom of a deque (owner only)
+//========================================================================
+
+static int PopJob( _GLFWdeque *d, _GLFWjob *job )
+{
+    long b, t;
+    int  found;
+
+    // Claim the bottom job before looking at the top, so that a thief
+    // and the owner can not both take the last job
+    b = _glfwPlatformAtomicAdd( &d->bottom, -1 );
+    t = d->top;
+
+    if( t > b )
+    {
+        // The deque was empty
+        d->bottom = t;
+        return GL_FALSE;
+    }
+
+    *job = d->jobs[ b & ( _GLFW_DEQUE_SIZE - 1 ) ];
+    if( t < b )
+    {
+        return GL_TRUE;
+    }
+
+    // This was the last job, so race thieves for it
+    found = _glfwPlatformAtomicCompareSwap( &d->top, t, t + 1 ) == t;
+    d->bottom = t + 1;
+
+    return found;
+}
+
+
+//========================================================================
+// Steal a job from the top of a deque (any thread)
+//========================================================================
+
+static int StealJob( _GLFWdeque *d, _GLFWjob *job )
+{
+    long b, t;
+
+    // Read the top with a full barrier, so that the bottom is read after
+    t = _glfwPlatformAtomicAdd( &d->top, 0 );
+    b = d->bottom;
+    if( t >= b )
+    {
+        return GL_FALSE;
+    }
+
+    // Make the bottom an acquire load, so that the slot of a job that was
+    // just pushed is not read before the bottom that published it
+    glfwThreadFence( GLFW_ATOMIC_ACQUIRE );
+
+    // The slot may be overwritten while it is copied, but only once the
+    // top has moved on, in which case the job is not used
+    *job = d->jobs[ t & ( _GLFW_DEQUE_SIZE - 1 ) ];
+
+    return _glfwPlatformAtomicCompareSwap( &d->top, t, t + 1 ) == t;
+}
+
+
+//========================================================================
+// Check whether any deque of a pool has jobs in it
+//========================================================================
+
+static int HasJobs( _GLFWthreadpool *pool )
+{
+    int i;
+
+    if( pool->external.top < pool->external.bottom )
+    {
+        return GL_TRUE;
+    }
+
+    for( i = 0; i < pool->count; i ++ )
+    {
+        if( pool->workers[ i ].deque.top < pool->workers[ i ].deque.bottom )
+        {
+            return GL_TRUE;
+        }
+    }
+
+    return GL_FALSE;
+}
+
+
+//========================================================================
+// Find the worker of a pool that is the calling thread, if any
+//========================================================================
+
+static _GLFWworker * FindWorker( _GLFWthreadpool *pool )
+{
+    GLFWthread ID;
+    int        i;
+
+    ID = glfwGetThreadID();
+    for( i = 0; i < pool->count; i ++ )
+    {
+        if( pool->workers[ i ].thread == ID )
+        {
+            return &pool->workers[ i ];
+        }
+    }
+
+    return NULL;
+}
+
+
+//========================================================================
+// Wake one parked worker, if any are parked
+//========================================================================
+
+static void WakeWorker( _GLFWthreadpool *pool )
+{
+    if( pool->sleepers > 0 )
+    {
+        glfwLockMutex( pool->mutex );
+        glfwSignalCond( pool->work );
+        glfwUnlockMutex( pool->mutex );
+    }
+}
+
+
+//========================================================================
+// Finish a job, waking waiters if it was the last one of its counter
+//========================================================================
+
+static void FinishJob( _GLFWthreadpool *pool, volatile long *pending )
+{
+    if( _glfwPlatformAtomicAdd( pending, -1 ) == 0 )
+    {
+        glfwLockMutex( pool->mutex );
+        glfwBroadcastCond( pool->done );
+        glfwUnlockMutex( pool->mutex );
+    }
+}
+
+
+//========================================================================
+// Make a job available to other threads, running it at once if that is
+// not possible. Self is the calling worker, or NULL for other threads
+//========================================================================
+
+static void RunJob( _GLFWthreadpool *pool, _GLFWworker *self,
+    _GLFWjob *job );
+
+static void PushOrRunJob( _GLFWthreadpool *pool, _GLFWworker *self,
+    _GLFWjob *job )
+{
+    int pushed;
+
+    if( self )
+    {
+        pushed = PushJob( &self->deque, job );
+    }
+    else
+    {
+        glfwLockMutex( pool->externalLock );
+        pushed = PushJob( &pool->external, job );
+        glfwUnlockMutex( pool->externalLock );
+    }
+
+    if( pushed )
+    {
+        WakeWorker( pool );
+    }
+    else
+    {
+        RunJob( pool, self, job );
+    }
+}
+
+
+//========================================================================
+// Run a job. Ranges larger than the grain size are split in halves, with
+// the upper half pushed for other threads to steal
+//========================================================================
+
+static void RunJob( _GLFWthreadpool *pool, _GLFWworker *self,
+    _GLFWjob *job )
+{
+    _GLFWloop *loop;
+    _GLFWjob  half;
+    int       mid;
+
+    if( job->fun )
+    {
+        job->fun( job->arg );
+        FinishJob( pool, job->pending );
+        return;
+    }
+
+    loop = (_GLFWloop *) job->arg;
+    while( job->last - job->first > loop->grain )
+    {
+        mid = job->first + ( job->last - job->first ) / 2;
+
+        half.fun     = NULL;
+        half.arg     = loop;
+        half.first   = mid;
+        half.last    = job->last;
+        half.pending = &loop->pending;
+
+        _glfwPlatformAtomicAdd( &loop->pending, 1 );
+        PushOrRunJob( pool, self, &half );
+
+        job->last = mid;
+    }
+
+    loop->fun( job->first, job->last, loop->arg );
+    FinishJob( pool, job->pending );
+}
+
+
+//========================================================================
+// Find a job to run: from the calling worker's own deque first, then
+// from the external deque and other workers
+//========================================================================
+
+static int FindJob( _GLFWthreadpool *pool, _GLFWworker *self,
+    _GLFWjob *job )
+{
+    int i, start;
+
+    if( self && PopJob( &self->deque, job ) )
+    {
+        return GL_TRUE;
+    }
+
+    if( StealJob( &pool->external, job ) )
+    {
+        return GL_TRUE;
+    }
+
+    // Start at a random victim, so that thieves spread out
+    if( self )
+    {
+        self->seed = self->seed * 1103515245u + 12345u;
+        start = (int) ( ( self->seed >> 16 ) % (unsigned int) pool->count );
+    }
+    else
+    {
+        start = 0;
+    }
+
+    for( i = 0; i < pool->count; i ++ )
+    {
+        if( StealJob( &pool->workers[ ( start + i ) % pool->count ].deque,
+                      job ) )
+        {
+            return GL_TRUE;
+        }
+    }
+
+    return GL_FALSE;
+}
+
+
+//========================================================================
+// Run jobs until a counter reaches zero, then return. Threads with
+// nothing to run sleep until some counter reaches zero
+//========================================================================
+
+static void WaitPending( _GLFWthreadpool *pool, _GLFWworker *self,
+    volatile long *pending )
+{
+    _GLFWjob job;
+
+    while( *pending > 0 )
+    {
+        if( FindJob( pool, self, &job ) )
+        {
+            RunJob( pool, self, &job );
+            continue;
+        }
+
+        glfwLockMutex( pool->mutex );
+        if( *pending > 0 && !HasJobs( pool ) )
+        {
+            glfwWaitCond( pool->done, pool->mutex, GLFW_INFINITY );
+        }
+        glfwUnlockMutex( pool->mutex );
+    }
+}
+
+
+//========================================================================
+// Worker thread function
+//========================================================================
+
+static void GLFWCALL WorkerThread( void *arg )
+{
+    _GLFWworker     *self = (_GLFWworker *) arg;
+    _GLFWthreadpool *pool = self->pool;
+    _GLFWjob        job;
+    int             round;
+
+    while( !pool->quit )
+    {
+        for( round = 0; round < _GLFW_STEAL_ROUNDS; round ++ )
+        {
+            if( FindJob( pool, self, &job ) )
+            {
+                break;
+            }
+        }
+
+        if( round < _GLFW_STEAL_ROUNDS )
+        {
+            RunJob( pool, self, &job );
+            continue;
+        }
+
+        // Announce that we are about to park before looking for jobs a
+        // last time, so that a thread pushing a job after that look will
+        // see us and wake us up
+        glfwLockMutex( pool->mutex );
+        _glfwPlatformAtomicAdd( &pool->sleepers, 1 );
+        if( !pool->quit && !HasJobs( pool ) )
+        {
+            glfwWaitCond( pool->work, pool->mutex, GLFW_INFINITY );
+        }
+        _glfwPlatformAtomicAdd( &pool->sleepers, -1 );
+        glfwUnlockMutex( pool->mutex );
+    }
+}
+
+
+//========================================================================
+// Free a thread pool and its synchronization objects (its threads must
+// have stopped)
+//========================================================================
+
+static void FreeThreadPool( _GLFWthreadpool *pool )
+{
+    if( pool->externalLock )
+    {
+        glfwDestroyMutex( pool->externalLock );
+    }
+    if( pool->mutex )
+    {
+        glfwDestroyMutex( pool->mutex );
+    }
+    if( pool->work )
+    {
+        glfwDestroyCond( pool->work );
+    }
+    if( pool->done )
+    {
+        glfwDestroyCond( pool->done );
+    }
+
+    _glfwFree( pool->workers );
+    _glfwFree( pool );
+}
+
+
+//========================================================================
+// Stop and wait for the worker threads of a pool
+//========================================================================
+
+static void StopWorkers( _GLFWthreadpool *pool, int count )
+{
+    int i;
+
+    glfwLockMutex( pool->mutex );
+    pool->quit = GL_TRUE;
+    glfwBroadcastCond( pool->work );
+    glfwUnlockMutex( pool->mutex );
+
+    for( i = 0; i < count; i ++ )
+    {
+        glfwWaitThread( pool->workers[ i ].thread, GLFW_WAIT );
+    }
+}
+
+
+
+//========================================================================
+// Submit a job counted by a counter of the caller's own, so that it can
+// be waited for apart from other jobs
+//========================================================================
+
+void _glfwSubmitPoolJob( GLFWthreadpool pool, GLFWjobfun fun, void *arg,
+    volatile long *pending )
+{
+    _GLFWthreadpool *p = (_GLFWthreadpool *) pool;
+    _GLFWjob        job;
+
+    job.fun     = fun;
+    job.arg     = arg;
+    job.first   = 0;
+    job.last    = 0;
+    job.pending = pending;
+
+    _glfwPlatformAtomicAdd( pending, 1 );
+    PushOrRunJob( p, FindWorker( p ), &job );
+}
+
+
+//========================================================================
+// Wait until a counter of jobs reaches zero, running jobs meanwhile
+//========================================================================
+
+void _glfwWaitPoolJobs( GLFWthreadpool pool, volatile long *pending )
+{
+    _GLFWthreadpool *p = (_GLFWthreadpool *) pool;
+
+    WaitPending( p, FindWorker( p ), pending );
+}
+
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Create a thread pool with the given number of worker threads, or one
+// per physical core if the number is zero or less
+//========================================================================
+
+GLFWAPI GLFWthreadpool GLFWAPIENTRY glfwCreateThreadPool( int threads )
+{
+    _GLFWthreadpool *pool;
+    GLFWthreadattr  attr;
+    int             i;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized )
+    {
+        return NULL;
+    }
+
+    // SMT siblings share the execution units of a core, so a worker for
+    // each of them would mostly compete with the others
+    if( threads <= 0 )
+    {
+        threads = _glfwGetCoreCount();
+    }
+    if( threads < 1 )
+    {
+        threads = 1;
+    }
+    if( threads > _GLFW_MAX_POOL_THREADS )
+    {
+        threads = _GLFW_MAX_POOL_THREADS;
+    }
+
+    pool = (_GLFWthreadpool *) _glfwCallocAs( 1, sizeof( _GLFWthreadpool ),
+                                              GLFW_MEMORY_THREAD );
+    if( pool == NULL )
+    {
+        return NULL;
+    }
+
+    pool->workers = (_GLFWworker *) _glfwCallocAs( threads,
+                                                   sizeof( _GLFWworker ),
+                                                   GLFW_MEMORY_THREAD );
+    pool->externalLock = glfwCreateMutex();
+    pool->mutex        = glfwCreateMutex();
+    pool->work         = glfwCreateCond();
+    pool->done         = glfwCreateCond();
+    if( !pool->workers || !pool->externalLock || !pool->mutex ||
+        !pool->work || !pool->done )
+    {
+        FreeThreadPool( pool );
+        return NULL;
+    }
+
+    pool->count = threads;
+    for( i = 0; i < threads; i ++ )
+    {
+        pool->workers[ i ].pool = pool;
+        pool->workers[ i ].seed = (unsigned int) i * 2654435761u + 1;
+    }
+
+    // Name the workers so that they can be told apart in profilers
+    memset( &attr, 0, sizeof( attr ) );
+    attr.Name = "glfw pool";
+
+    for( i = 0; i < threads; i ++ )
+    {
+        pool->workers[ i ].thread = glfwCreateThreadEx( WorkerThread,
+                                                        &pool->workers[ i ],
+                                                        &attr );
+        if( pool->workers[ i ].thread < 0 )
+        {
+            StopWorkers( pool, i );
+            FreeThreadPool( pool );
+            return NULL;
+        }
+    }
+
+    return (GLFWthreadpool) pool;
+}
+
+
+//========================================================================
+// Wait for all jobs of a thread pool, then stop its threads and free it
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwDestroyThreadPool( GLFWthreadpool pool )
+{
+    _GLFWthreadpool *p = (_GLFWthreadpool *) pool;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || p == NULL )
+    {
+        return;
+    }
+
+    WaitPending( p, NULL, &p->pending );
+    StopWorkers( p, p->count );
+    FreeThreadPool( p );
+}
+
+
+//========================================================================
+// Submit a job to a thread pool. Jobs submitted from a worker thread go
+// to its own deque, where they are likely to run while its data is still
+// in the cache
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwSubmitJob( GLFWthreadpool pool,
+    GLFWjobfun fun, void *arg )
+{
+    _GLFWthreadpool *p = (_GLFWthreadpool *) pool;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || p == NULL || fun == NULL )
+    {
+        return GL_FALSE;
+    }
+
+    _glfwSubmitPoolJob( pool, fun, arg, &p->pending );
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Wait until all jobs submitted to a thread pool have finished, running
+// jobs on the calling thread meanwhile. Must not be called from a job
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwWaitJobs( GLFWthreadpool pool )
+{
+    _GLFWthreadpool *p = (_GLFWthreadpool *) pool;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || p == NULL )
+    {
+        return;
+    }
+
+    _glfwWaitPoolJobs( pool, &p->pending );
+}
+
+
+//========================================================================
+// Call a function for ranges covering [0, count), in parallel, and wait
+// for all of them. Ranges are at most grain indices long (a grain of zero
+// or less picks one). This may be called from within jobs
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwParallelFor( GLFWthreadpool pool, int count,
+    int grain, GLFWrangefun fun, void *arg )
+{
+    _GLFWthreadpool *p = (_GLFWthreadpool *) pool;
+    _GLFWworker     *self;
+    _GLFWloop       loop;
+    _GLFWjob        job;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || p == NULL || fun == NULL || count <= 0 )
+    {
+        return;
+    }
+
+    // By default, give every thread a few ranges to balance the load
+    if( grain <= 0 )
+    {
+        grain = count / ( ( p->count + 1 ) * 8 );
+        if( grain < 1 )
+        {
+            grain = 1;
+        }
+    }
+
+    loop.fun     = fun;
+    loop.arg     = arg;
+    loop.grain   = grain;
+    loop.pending = 1;
+
+    job.fun     = NULL;
+    job.arg     = &loop;
+    job.first   = 0;
+    job.last    = count;
+    job.pending = &loop.pending;
+
+    // The calling thread takes the first range itself, and then helps
+    // with the rest
+    self = FindWorker( p );
+    RunJob( p, self, &job );
+    WaitPending( p, self, &loop.pending );
+}
@@ -0,0 +1,270 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+
+//========================================================================
+// Description:
+//
+// This module describes how the logical processors of the system are
+// grouped into physical cores, packages and NUMA nodes, and which caches
+// they share. The platform code reports what the system calls each of
+// these; this module numbers them from zero and derives the counts and
+// sets. Where the platform can not tell, every logical processor is
+// assumed to be a core of its own.
+//
+//========================================================================
+
+
+#include "internal.h"
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+//========================================================================
+// Mark all processors as offline
+//========================================================================
+
+static void ClearTopology( GLFWtopology *topology )
+{
+    int i, j;
+
+    memset( topology, 0, sizeof( GLFWtopology ) );
+
+    for( i = 0; i < GLFW_MAX_PROCESSORS; i ++ )
+    {
+        topology->Processors[ i ].Package = -1;
+        topology->Processors[ i ].Core    = -1;
+        topology->Processors[ i ].Node    = -1;
+        for( j = 0; j < GLFW_MAX_CACHES; j ++ )
+        {
+            topology->Processors[ i ].Cache[ j ] = -1;
+        }
+    }
+}
+
+
+//========================================================================
+// Make up a topology of single-threaded cores in one package
+//========================================================================
+
+static void GuessTopology( GLFWtopology *topology )
+{
+    int i, count;
+
+    count = _glfwPlatformGetNumberOfProcessors();
+    if( count < 1 )
+    {
+        count = 1;
+    }
+    if( count > GLFW_MAX_PROCESSORS )
+    {
+        count = GLFW_MAX_PROCESSORS;
+    }
+
+    for( i = 0; i < count; i ++ )
+    {
+        topology->Processors[ i ].Package = 0;
+        topology->Processors[ i ].Core    = i;
+        topology->Processors[ i ].Node    = 0;
+    }
+}
+
+
+//========================================================================
+// Return the index of a system ID among those seen so far, adding it if
+// it is new
+//========================================================================
+
+static int Renumber( int *ids, int *count, int id )
+{
+    int i;
+
+    for( i = 0; i < *count; i ++ )
+    {
+        if( ids[ i ] == id )
+        {
+            return i;
+        }
+    }
+
+    ids[ *count ] = id;
+    return ( *count ) ++;
+}
+
+
+//========================================================================
+// Number packages, cores and cache instances from zero in processor
+// order, and fill in the counts and processor sets
+//========================================================================
+
+static void FinishTopology( GLFWtopology *topology )
+{
+    GLFWprocessorinfo *p;
+    GLFWcacheinfo     *cache;
+    int               packages[ GLFW_MAX_PROCESSORS ];
+    int               cores[ GLFW_MAX_PROCESSORS ];
+    int               instances[ GLFW_MAX_PROCESSORS ];
+    int               users[ GLFW_MAX_PROCESSORS ];
+    unsigned int      bit;
+    int               i, c, count, first;
+
+    for( i = 0; i < GLFW_MAX_PROCESSORS; i ++ )
+    {
+        p = &topology->Processors[ i ];
+        if( p->Package < 0 )
+        {
+            continue;
+        }
+
+        // Processors the platform knows no node for are on the first one
+        if( p->Node < 0 || p->Node >= GLFW_MAX_NODES )
+        {
+            p->Node = 0;
+        }
+
+        p->Package = Renumber( packages, &topology->PackageCount,
+                               p->Package );
+        p->Core = Renumber( cores, &topology->CoreCount, p->Core );
+
+        bit = 1U << ( i % 32 );
+        topology->Cores[ p->Core ].Bits[ i / 32 ] |= bit;
+        topology->Nodes[ p->Node ].Bits[ i / 32 ] |= bit;
+
+        topology->ProcessorCount ++;
+        if( p->Node >= topology->NodeCount )
+        {
+            topology->NodeCount = p->Node + 1;
+        }
+    }
+
+    for( c = 0; c < topology->CacheCount; c ++ )
+    {
+        cache = &topology->Caches[ c ];
+
+        count = 0;
+        for( i = 0; i < GLFW_MAX_PROCESSORS; i ++ )
+        {
+            p = &topology->Processors[ i ];
+            if( p->Package < 0 || p->Cache[ c ] < 0 )
+            {
+                continue;
+            }
+
+            first = count;
+            p->Cache[ c ] = Renumber( instances, &count, p->Cache[ c ] );
+            if( count > first )
+            {
+                users[ p->Cache[ c ] ] = 0;
+            }
+            users[ p->Cache[ c ] ] ++;
+        }
+
+        cache->Count    = count;
+        cache->SharedBy = 0;
+        for( i = 0; i < count; i ++ )
+        {
+            if( users[ i ] > cache->SharedBy )
+            {
+                cache->SharedBy = users[ i ];
+            }
+        }
+    }
+}
+
+
+//========================================================================
+// Fill in the topology of the system. Returns GL_FALSE if it was guessed
+//========================================================================
+
+static int ReadTopology( GLFWtopology *topology )
+{
+    int result;
+
+    ClearTopology( topology );
+    result = _glfwPlatformGetProcessorTopology( topology );
+    if( !result )
+    {
+        ClearTopology( topology );
+        GuessTopology( topology );
+    }
+    FinishTopology( topology );
+
+    return result;
+}
+
+
+//========================================================================
+// Return the number of physical cores in the system
+//========================================================================
+
+int _glfwGetCoreCount( void )
+{
+    GLFWtopology *topology;
+    int          count;
+
+    topology = (GLFWtopology *) _glfwMalloc( sizeof( GLFWtopology ) );
+    if( topology == NULL )
+    {
+        return _glfwPlatformGetNumberOfProcessors();
+    }
+
+    (void) ReadTopology( topology );
+    count = topology->CoreCount;
+
+    _glfwFree( topology );
+
+    return count > 0 ? count : 1;
+}
+
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Describe the processors of the system. Returns GL_FALSE if the system
+// could not tell, in which case every processor is reported as a core of
+// its own
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwGetProcessorTopology( GLFWtopology *topology )
+{
+    // Is GLFW initialized?
+    if( !_glfwInitialized || topology == NULL )
+    {
+        return GL_FALSE;
+    }
+
+    return ReadTopology( topology );
+}
+
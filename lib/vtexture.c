@@ -0,0 +1,889 @@
+//========================================================================
+// GLFW - An OpenGL framework
+// Platform:    Any
+// API version: 2.7
+// WWW:         http://www.glfw.org/
+//------------------------------------------------------------------------
+// Copyright (c) 2002-2006 Marcus Geelnard
+// Copyright (c) 2006-2010 Camilla Berglund <elmindreda@elmindreda.org>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+//========================================================================
+// Description:
+//
+// This module streams images that are too large for a single texture.
+// The source image is split into square tiles, with a mipmap pyramid
+// whose coarsest level fits in one tile.
+//
+// Only the tiles that the application asks for are kept in a cache
+// texture, which holds a grid of tiles (each with a one pixel border for
+// filtering). An indirection texture, with one texel per tile and one
+// mipmap level per pyramid level, tells a shader where each tile lives.
+// Its texels hold the cache column and row of the tile in red and green,
+// and the pyramid level of the cached data in blue. Tiles that are not in
+// the cache point to their closest cached ancestor, and the coarsest tile
+// is always cached.
+//
+// Requested tiles are cut from the pyramid by worker threads in the order
+// they were requested, and uploaded by glfwUpdateVirtualTexture.
+//
+//========================================================================
+
+
+#include "internal.h"
+
+
+// Maximum number of pyramid levels
+#define _GLFW_MAX_VT_LEVELS 16
+
+// Maximum number of tile cutting threads
+#define _GLFW_MAX_VT_THREADS 4
+
+// Width of the tile borders, in pixels
+#define _GLFW_VT_BORDER 1
+
+// Tile states
+#define _GLFW_TILE_NONE     0
+#define _GLFW_TILE_QUEUED   1
+#define _GLFW_TILE_LOADING  2
+#define _GLFW_TILE_READY    3
+#define _GLFW_TILE_RESIDENT 4
+
+
+//************************************************************************
+//****                  GLFW internal functions                       ****
+//************************************************************************
+
+//========================================================================
+// Virtual texture structures
+//========================================================================
+
+// Tile of the pyramid
+typedef struct {
+    int           slot;         // Cache slot, or -1
+    int           state;        // _GLFW_TILE_* state
+} _GLFWvtile;
+
+// Tile request, or cut tile waiting for upload
+typedef struct {
+    int           level, x, y;
+    int           order;        // Request order
+    unsigned char *pixels;      // Cut tile pixels (ready list only)
+} _GLFWvrequest;
+
+// Slot of the tile cache
+typedef struct {
+    int           level, x, y;  // Tile in the slot (level is -1 if free)
+    int           lastUse;      // Last frame the tile was requested in
+} _GLFWvslot;
+
+typedef struct {
+    // Pyramid and tiles
+    GLFWimage     levels[ _GLFW_MAX_VT_LEVELS ];
+    int           levelCount;
+    int           tileSize;
+    int           pixelformat, bpp;
+    int           tilesX[ _GLFW_MAX_VT_LEVELS ];
+    int           tilesY[ _GLFW_MAX_VT_LEVELS ];
+    _GLFWvtile    *tiles[ _GLFW_MAX_VT_LEVELS ];
+    unsigned char *mapping[ _GLFW_MAX_VT_LEVELS ];
+
+    // Tile cache
+    _GLFWvslot    *slots;
+    int           slotsX, slotsY;
+    GLuint        cacheTexture;
+    GLuint        indirectionTexture;
+    int           frame;
+    int           dirty;
+
+    // Work shared with the tile cutting threads
+    _GLFWvrequest *requests;
+    int           requestCount, requestSize;
+    _GLFWvrequest *ready;
+    int           readyCount, readySize;
+    int           order;
+    int           stop;
+    GLFWmutex     mutex;
+    GLFWcond      cond;
+    GLFWthread    threads[ _GLFW_MAX_VT_THREADS ];
+    int           threadCount;
+} _GLFWvtexture;
+
+
+//========================================================================
+// Append a request to a request list
+//========================================================================
+
+static int PushRequest( _GLFWvrequest **list, int *count, int *size,
+    const _GLFWvrequest *request )
+{
+    _GLFWvrequest *grown;
+
+    if( *count == *size )
+    {
+        grown = (_GLFWvrequest *) _glfwRealloc( *list,
+            ( *size * 2 + 16 ) * sizeof( _GLFWvrequest ) );
+        if( grown == NULL )
+        {
+            return GL_FALSE;
+        }
+        *list = grown;
+        *size = *size * 2 + 16;
+    }
+
+    (*list)[ (*count) ++ ] = *request;
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Cut a tile, with its border, out of a pyramid level
+//========================================================================
+
+static unsigned char *CutTile( const _GLFWvtexture *vt, int level, int x,
+    int y )
+{
+    const GLFWimage *img = &vt->levels[ level ];
+    unsigned char   *pixels, *dst;
+    int             size, row, col, sx, sy, x0, y0;
+
+    size = vt->tileSize + 2 * _GLFW_VT_BORDER;
+    pixels = (unsigned char *) _glfwAllocPixels( size * size * vt->bpp );
+    if( pixels == NULL )
+    {
+        return NULL;
+    }
+
+    x0 = x * vt->tileSize - _GLFW_VT_BORDER;
+    y0 = y * vt->tileSize - _GLFW_VT_BORDER;
+
+    // Pixels outside the image repeat its edge
+    dst = pixels;
+    for( row = 0; row < size; row ++ )
+    {
+        sy = y0 + row;
+        sy = sy < 0 ? 0 : sy >= img->Height ? img->Height - 1 : sy;
+
+        for( col = 0; col < size; col ++ )
+        {
+            sx = x0 + col;
+            sx = sx < 0 ? 0 : sx >= img->Width ? img->Width - 1 : sx;
+
+            memcpy( dst, img->Data + ( sy * img->Width + sx ) * vt->bpp,
+                    vt->bpp );
+            dst += vt->bpp;
+        }
+    }
+
+    return pixels;
+}
+
+
+//========================================================================
+// Cut requested tiles, oldest request first (thread function)
+//========================================================================
+
+static void GLFWCALL CutterThread( void *arg )
+{
+    _GLFWvtexture *vt = (_GLFWvtexture *) arg;
+    _GLFWvrequest request;
+    int           n, best;
+
+    glfwLockMutex( vt->mutex );
+
+    while( !vt->stop )
+    {
+        if( vt->requestCount == 0 )
+        {
+            glfwWaitCond( vt->cond, vt->mutex, GLFW_INFINITY );
+            continue;
+        }
+
+        best = 0;
+        for( n = 1; n < vt->requestCount; n ++ )
+        {
+            if( vt->requests[ n ].order < vt->requests[ best ].order )
+            {
+                best = n;
+            }
+        }
+
+        request = vt->requests[ best ];
+        vt->requests[ best ] = vt->requests[ -- vt->requestCount ];
+        vt->tiles[ request.level ][ request.y * vt->tilesX[ request.level ] +
+                                    request.x ].state = _GLFW_TILE_LOADING;
+
+        // The pyramid is never modified, so tiles are cut without locking
+        glfwUnlockMutex( vt->mutex );
+        request.pixels = CutTile( vt, request.level, request.x, request.y );
+        glfwLockMutex( vt->mutex );
+
+        if( request.pixels &&
+            PushRequest( &vt->ready, &vt->readyCount, &vt->readySize,
+                         &request ) )
+        {
+            vt->tiles[ request.level ][ request.y * vt->tilesX[ request.level ] +
+                                        request.x ].state = _GLFW_TILE_READY;
+        }
+        else
+        {
+            _glfwFreePixels( request.pixels );
+            vt->tiles[ request.level ][ request.y * vt->tilesX[ request.level ] +
+                                        request.x ].state = _GLFW_TILE_NONE;
+        }
+    }
+
+    glfwUnlockMutex( vt->mutex );
+}
+
+
+//========================================================================
+// Find the cache slot to put a new tile in, evicting the least recently
+// used tile if the cache is full (the coarsest tile in slot zero is never
+// evicted)
+//========================================================================
+
+static int FindSlot( _GLFWvtexture *vt )
+{
+    _GLFWvslot *slot;
+    _GLFWvtile *tile;
+    int        n, best;
+
+    best = -1;
+    for( n = 1; n < vt->slotsX * vt->slotsY; n ++ )
+    {
+        if( vt->slots[ n ].level < 0 )
+        {
+            return n;
+        }
+        if( best < 0 || vt->slots[ n ].lastUse < vt->slots[ best ].lastUse )
+        {
+            best = n;
+        }
+    }
+
+    // Don't evict tiles that are in use this frame
+    if( best < 0 || vt->slots[ best ].lastUse >= vt->frame )
+    {
+        return -1;
+    }
+
+    slot = &vt->slots[ best ];
+    tile = &vt->tiles[ slot->level ][ slot->y * vt->tilesX[ slot->level ] +
+                                      slot->x ];
+    tile->slot  = -1;
+    tile->state = _GLFW_TILE_NONE;
+    slot->level = -1;
+
+    return best;
+}
+
+
+//========================================================================
+// Upload a cut tile into a cache slot
+//========================================================================
+
+static void UploadTile( _GLFWvtexture *vt, const _GLFWvrequest *request,
+    int slot )
+{
+    GLint  internalformat;
+    GLenum format, type;
+    int    size;
+
+    size = vt->tileSize + 2 * _GLFW_VT_BORDER;
+    _glfwGetUploadFormat( vt->pixelformat, &internalformat, &format, &type );
+
+    glBindTexture( GL_TEXTURE_2D, vt->cacheTexture );
+    glTexSubImage2D( GL_TEXTURE_2D, 0,
+        ( slot % vt->slotsX ) * size, ( slot / vt->slotsX ) * size,
+        size, size, format, type, (void*) request->pixels );
+
+    vt->slots[ slot ].level   = request->level;
+    vt->slots[ slot ].x       = request->x;
+    vt->slots[ slot ].y       = request->y;
+    vt->slots[ slot ].lastUse = vt->frame;
+}
+
+
+//========================================================================
+// Rebuild and upload the indirection texture
+//========================================================================
+
+static void UpdateIndirection( _GLFWvtexture *vt )
+{
+    _GLFWvtile    *tile;
+    unsigned char *dst, *parent;
+    int           level, x, y;
+
+    // Walk from the coarsest level down, so that tiles without data can
+    // copy the entry of their parent
+    for( level = vt->levelCount - 1; level >= 0; level -- )
+    {
+        dst = vt->mapping[ level ];
+        for( y = 0; y < vt->tilesY[ level ]; y ++ )
+        {
+            for( x = 0; x < vt->tilesX[ level ]; x ++ )
+            {
+                tile = &vt->tiles[ level ][ y * vt->tilesX[ level ] + x ];
+                if( tile->slot >= 0 )
+                {
+                    dst[ 0 ] = (unsigned char) ( tile->slot % vt->slotsX );
+                    dst[ 1 ] = (unsigned char) ( tile->slot / vt->slotsX );
+                    dst[ 2 ] = (unsigned char) level;
+                    dst[ 3 ] = 255;
+                }
+                else if( level < vt->levelCount - 1 )
+                {
+                    parent = vt->mapping[ level + 1 ] +
+                             ( ( y >> 1 ) * vt->tilesX[ level + 1 ] +
+                               ( x >> 1 ) ) * 4;
+                    memcpy( dst, parent, 4 );
+                }
+                dst += 4;
+            }
+        }
+    }
+
+    glBindTexture( GL_TEXTURE_2D, vt->indirectionTexture );
+    for( level = 0; level < vt->levelCount; level ++ )
+    {
+        glTexSubImage2D( GL_TEXTURE_2D, level, 0, 0,
+            vt->tilesX[ level ], vt->tilesY[ level ], GL_RGBA,
+            GL_UNSIGNED_BYTE, (void*) vt->mapping[ level ] );
+    }
+
+    vt->dirty = GL_FALSE;
+}
+
+
+//========================================================================
+// Stop the worker threads and free a virtual texture
+//========================================================================
+
+static void FreeVirtualTexture( _GLFWvtexture *vt )
+{
+    int n;
+
+    if( vt->mutex )
+    {
+        glfwLockMutex( vt->mutex );
+        vt->stop = GL_TRUE;
+        glfwBroadcastCond( vt->cond );
+        glfwUnlockMutex( vt->mutex );
+    }
+
+    for( n = 0; n < vt->threadCount; n ++ )
+    {
+        glfwWaitThread( vt->threads[ n ], GLFW_WAIT );
+    }
+
+    if( vt->mutex )
+    {
+        glfwDestroyMutex( vt->mutex );
+    }
+    if( vt->cond )
+    {
+        glfwDestroyCond( vt->cond );
+    }
+
+    if( vt->cacheTexture )
+    {
+        glDeleteTextures( 1, &vt->cacheTexture );
+    }
+    if( vt->indirectionTexture )
+    {
+        glDeleteTextures( 1, &vt->indirectionTexture );
+    }
+
+    for( n = 0; n < vt->readyCount; n ++ )
+    {
+        _glfwFreePixels( vt->ready[ n ].pixels );
+    }
+    _glfwFree( vt->ready );
+    _glfwFree( vt->requests );
+    _glfwFree( vt->slots );
+
+    for( n = 0; n < _GLFW_MAX_VT_LEVELS; n ++ )
+    {
+        _glfwFreePixels( vt->levels[ n ].Data );
+        _glfwFree( vt->tiles[ n ] );
+        _glfwFree( vt->mapping[ n ] );
+    }
+
+    _glfwFree( vt );
+}
+
+
+//========================================================================
+// Build the next level of the pyramid with a box filter (unlike
+// _glfwHalveImage, this rounds odd sizes up, so that each pixel always
+// covers the same two by two block of the level above)
+//========================================================================
+
+static int HalveLevel( const GLFWimage *src, GLFWimage *dst, int bpp )
+{
+    const unsigned char *row0, *row1;
+    unsigned char       *out;
+    int                 x, y, k, x0, x1;
+
+    dst->Width         = ( src->Width + 1 ) / 2;
+    dst->Height        = ( src->Height + 1 ) / 2;
+    dst->Format        = src->Format;
+    dst->BytesPerPixel = src->BytesPerPixel;
+    dst->Data = (unsigned char *)
+        _glfwAllocPixels( dst->Width * dst->Height * bpp );
+    if( dst->Data == NULL )
+    {
+        return GL_FALSE;
+    }
+
+    out = dst->Data;
+    for( y = 0; y < dst->Height; y ++ )
+    {
+        row0 = src->Data + 2 * y * src->Width * bpp;
+        row1 = 2 * y + 1 < src->Height ? row0 + src->Width * bpp : row0;
+
+        for( x = 0; x < dst->Width; x ++ )
+        {
+            x0 = 2 * x * bpp;
+            x1 = 2 * x + 1 < src->Width ? x0 + bpp : x0;
+
+            for( k = 0; k < bpp; k ++ )
+            {
+                *out ++ = (unsigned char) ( ( (int) row0[ x0 + k ] +
+                                              (int) row0[ x1 + k ] +
+                                              (int) row1[ x0 + k ] +
+                                              (int) row1[ x1 + k ] + 2 ) >> 2 );
+            }
+        }
+    }
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Build the mipmap pyramid and the tile tables of a virtual texture
+//========================================================================
+
+static int BuildPyramid( _GLFWvtexture *vt )
+{
+    int level, tilesX, tilesY, n;
+
+    // Round the tile grid up to a power of two, so that every level of
+    // the indirection texture is exactly half the size of the one above
+    for( tilesX = 1; tilesX * vt->tileSize < vt->levels[ 0 ].Width;
+         tilesX <<= 1 )
+      ;
+    for( tilesY = 1; tilesY * vt->tileSize < vt->levels[ 0 ].Height;
+         tilesY <<= 1 )
+      ;
+
+    for( level = 0; level < _GLFW_MAX_VT_LEVELS; level ++ )
+    {
+        vt->tilesX[ level ] = tilesX >> level ? tilesX >> level : 1;
+        vt->tilesY[ level ] = tilesY >> level ? tilesY >> level : 1;
+
+        n = vt->tilesX[ level ] * vt->tilesY[ level ];
+        vt->tiles[ level ] = (_GLFWvtile *)
+            _glfwMalloc( n * sizeof( _GLFWvtile ) );
+        vt->mapping[ level ] = (unsigned char *) _glfwCalloc( n, 4 );
+        if( vt->tiles[ level ] == NULL || vt->mapping[ level ] == NULL )
+        {
+            return GL_FALSE;
+        }
+        while( n -- )
+        {
+            vt->tiles[ level ][ n ].slot  = -1;
+            vt->tiles[ level ][ n ].state = _GLFW_TILE_NONE;
+        }
+
+        // Build the next smaller level of the pyramid
+        if( level > 0 &&
+            !HalveLevel( &vt->levels[ level - 1 ], &vt->levels[ level ],
+                         vt->bpp ) )
+        {
+            return GL_FALSE;
+        }
+
+        vt->levelCount = level + 1;
+        if( vt->tilesX[ level ] == 1 && vt->tilesY[ level ] == 1 )
+        {
+            break;
+        }
+    }
+
+    return vt->tilesX[ vt->levelCount - 1 ] == 1 &&
+           vt->tilesY[ vt->levelCount - 1 ] == 1;
+}
+
+
+//========================================================================
+// Create the cache and indirection textures of a virtual texture
+//========================================================================
+
+static int CreateTextures( _GLFWvtexture *vt, int cachetiles )
+{
+    GLint  internalformat, maxsize;
+    GLenum format, type;
+    int    size, level, n;
+
+    // The cache texture must fit within the texture size limit, and slot
+    // coordinates must fit in a byte
+    size = vt->tileSize + 2 * _GLFW_VT_BORDER;
+    glGetIntegerv( GL_MAX_TEXTURE_SIZE, &maxsize );
+    if( cachetiles * size > maxsize )
+    {
+        cachetiles = maxsize / size;
+    }
+    if( cachetiles > 256 )
+    {
+        cachetiles = 256;
+    }
+    if( cachetiles < 2 )
+    {
+        return GL_FALSE;
+    }
+
+    vt->slotsX = vt->slotsY = cachetiles;
+    vt->slots = (_GLFWvslot *) _glfwMalloc( cachetiles * cachetiles *
+                                            sizeof( _GLFWvslot ) );
+    if( vt->slots == NULL )
+    {
+        return GL_FALSE;
+    }
+    for( n = 0; n < cachetiles * cachetiles; n ++ )
+    {
+        vt->slots[ n ].level   = -1;
+        vt->slots[ n ].lastUse = 0;
+    }
+
+    _glfwGetUploadFormat( vt->pixelformat, &internalformat, &format, &type );
+
+    glGenTextures( 1, &vt->cacheTexture );
+    glBindTexture( GL_TEXTURE_2D, vt->cacheTexture );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexImage2D( GL_TEXTURE_2D, 0, internalformat, cachetiles * size,
+        cachetiles * size, 0, format, type, NULL );
+
+    glGenTextures( 1, &vt->indirectionTexture );
+    glBindTexture( GL_TEXTURE_2D, vt->indirectionTexture );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                     GL_NEAREST_MIPMAP_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    for( level = 0; level < vt->levelCount; level ++ )
+    {
+        glTexImage2D( GL_TEXTURE_2D, level, GL_RGBA, vt->tilesX[ level ],
+            vt->tilesY[ level ], 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+    }
+
+    return GL_TRUE;
+}
+
+
+//************************************************************************
+//****                    GLFW user functions                         ****
+//************************************************************************
+
+//========================================================================
+// Create a virtual texture from an image file
+//========================================================================
+
+GLFWAPI GLFWvtexture GLFWAPIENTRY glfwCreateVirtualTexture(
+    const char *name, int tilesize, int cachetiles, int flags )
+{
+    _GLFWvtexture *vt;
+    _GLFWvrequest request;
+    GLint         texture, UnpackAlignment;
+    int           n, glformat, success;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwWin.opened )
+    {
+        return NULL;
+    }
+
+    if( tilesize < 1 )
+    {
+        return NULL;
+    }
+
+    vt = (_GLFWvtexture *) _glfwCalloc( 1, sizeof( _GLFWvtexture ) );
+    if( vt == NULL )
+    {
+        return NULL;
+    }
+    vt->tileSize = tilesize;
+
+    // The source is never rescaled, its tiles are
+    if( !glfwReadImage( name, &vt->levels[ 0 ], flags | GLFW_NO_RESCALE_BIT ) )
+    {
+        _glfwFree( vt );
+        return NULL;
+    }
+    vt->pixelformat = _glfwGetPixelFormat( &vt->levels[ 0 ] );
+    vt->bpp = _glfwGetPixelFormatSize( vt->pixelformat, &glformat );
+
+    glGetIntegerv( GL_TEXTURE_BINDING_2D, &texture );
+
+    success = BuildPyramid( vt ) && CreateTextures( vt, cachetiles );
+
+    // The coarsest tile is always in slot zero
+    if( success )
+    {
+        request.level  = vt->levelCount - 1;
+        request.x      = 0;
+        request.y      = 0;
+        request.pixels = CutTile( vt, request.level, 0, 0 );
+        success = request.pixels != NULL;
+        if( success )
+        {
+            glGetIntegerv( GL_UNPACK_ALIGNMENT, &UnpackAlignment );
+            glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+            UploadTile( vt, &request, 0 );
+            _glfwFreePixels( request.pixels );
+            vt->tiles[ request.level ][ 0 ].slot  = 0;
+            vt->tiles[ request.level ][ 0 ].state = _GLFW_TILE_RESIDENT;
+            UpdateIndirection( vt );
+            glPixelStorei( GL_UNPACK_ALIGNMENT, UnpackAlignment );
+        }
+    }
+
+    // Start the tile cutting threads
+    if( success )
+    {
+        vt->mutex = glfwCreateMutex();
+        vt->cond  = glfwCreateCond();
+        success = vt->mutex && vt->cond;
+    }
+    if( success )
+    {
+        n = glfwGetNumberOfProcessors();
+        n = n < 1 ? 1 : n > _GLFW_MAX_VT_THREADS ? _GLFW_MAX_VT_THREADS : n;
+        for( vt->threadCount = 0; vt->threadCount < n; vt->threadCount ++ )
+        {
+            vt->threads[ vt->threadCount ] =
+                glfwCreateThread( CutterThread, vt );
+            if( vt->threads[ vt->threadCount ] < 0 )
+            {
+                break;
+            }
+        }
+        success = vt->threadCount > 0;
+    }
+
+    glBindTexture( GL_TEXTURE_2D, (GLuint) texture );
+
+    if( !success )
+    {
+        FreeVirtualTexture( vt );
+        return NULL;
+    }
+
+    return (GLFWvtexture) vt;
+}
+
+
+//========================================================================
+// Destroy a virtual texture
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwDestroyVirtualTexture( GLFWvtexture vt )
+{
+    // Is GLFW initialized?
+    if( !_glfwInitialized || vt == NULL )
+    {
+        return;
+    }
+
+    FreeVirtualTexture( (_GLFWvtexture *) vt );
+}
+
+
+//========================================================================
+// Request tiles of a virtual texture (as level, x, y triplets, most
+// important first)
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwRequestVirtualTiles( GLFWvtexture handle,
+    const int *tiles, int count )
+{
+    _GLFWvtexture *vt = (_GLFWvtexture *) handle;
+    _GLFWvrequest request;
+    _GLFWvtile    *tile;
+    int           n;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || vt == NULL )
+    {
+        return;
+    }
+
+    glfwLockMutex( vt->mutex );
+
+    for( n = 0; n < count; n ++ )
+    {
+        request.level  = tiles[ n * 3 ];
+        request.x      = tiles[ n * 3 + 1 ];
+        request.y      = tiles[ n * 3 + 2 ];
+        request.pixels = NULL;
+
+        if( request.level < 0 || request.level >= vt->levelCount ||
+            request.x < 0 || request.x >= vt->tilesX[ request.level ] ||
+            request.y < 0 || request.y >= vt->tilesY[ request.level ] )
+        {
+            continue;
+        }
+
+        tile = &vt->tiles[ request.level ][ request.y *
+                                            vt->tilesX[ request.level ] +
+                                            request.x ];
+        if( tile->slot >= 0 )
+        {
+            // Keep cached tiles from being evicted
+            vt->slots[ tile->slot ].lastUse = vt->frame;
+        }
+        else if( tile->state == _GLFW_TILE_NONE )
+        {
+            request.order = vt->order ++;
+            if( PushRequest( &vt->requests, &vt->requestCount,
+                             &vt->requestSize, &request ) )
+            {
+                tile->state = _GLFW_TILE_QUEUED;
+            }
+        }
+    }
+
+    glfwBroadcastCond( vt->cond );
+    glfwUnlockMutex( vt->mutex );
+}
+
+
+//========================================================================
+// Upload tiles that have been cut, and update the indirection texture
+// (returns the number of uploaded tiles)
+//========================================================================
+
+GLFWAPI int GLFWAPIENTRY glfwUpdateVirtualTexture( GLFWvtexture handle,
+    int maxuploads )
+{
+    _GLFWvtexture *vt = (_GLFWvtexture *) handle;
+    _GLFWvrequest request;
+    _GLFWvtile    *tile;
+    GLint         texture, UnpackAlignment;
+    int           uploaded, slot;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || !_glfwWin.opened || vt == NULL )
+    {
+        return 0;
+    }
+
+    glGetIntegerv( GL_TEXTURE_BINDING_2D, &texture );
+    glGetIntegerv( GL_UNPACK_ALIGNMENT, &UnpackAlignment );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+    uploaded = 0;
+    while( uploaded < maxuploads )
+    {
+        // Take the oldest tile that is ready
+        glfwLockMutex( vt->mutex );
+        if( vt->readyCount == 0 )
+        {
+            glfwUnlockMutex( vt->mutex );
+            break;
+        }
+        request = vt->ready[ 0 ];
+        memmove( vt->ready, vt->ready + 1,
+                 ( -- vt->readyCount ) * sizeof( _GLFWvrequest ) );
+
+        tile = &vt->tiles[ request.level ][ request.y *
+                                            vt->tilesX[ request.level ] +
+                                            request.x ];
+        slot = FindSlot( vt );
+        if( slot >= 0 )
+        {
+            tile->slot  = slot;
+            tile->state = _GLFW_TILE_RESIDENT;
+        }
+        else
+        {
+            tile->state = _GLFW_TILE_NONE;
+        }
+        glfwUnlockMutex( vt->mutex );
+
+        if( slot >= 0 )
+        {
+            UploadTile( vt, &request, slot );
+            vt->dirty = GL_TRUE;
+            uploaded ++;
+        }
+        _glfwFreePixels( request.pixels );
+    }
+
+    if( vt->dirty )
+    {
+        UpdateIndirection( vt );
+    }
+
+    // Start the next frame only now, so that the tiles requested for this
+    // one were protected from eviction by the uploads above
+    glfwLockMutex( vt->mutex );
+    vt->frame ++;
+    glfwUnlockMutex( vt->mutex );
+
+    glPixelStorei( GL_UNPACK_ALIGNMENT, UnpackAlignment );
+    glBindTexture( GL_TEXTURE_2D, (GLuint) texture );
+
+    return uploaded;
+}
+
+
+//========================================================================
+// Get the layout and texture names of a virtual texture
+//========================================================================
+
+GLFWAPI void GLFWAPIENTRY glfwGetVirtualTextureInfo( GLFWvtexture handle,
+    GLFWvtexinfo *info )
+{
+    _GLFWvtexture *vt = (_GLFWvtexture *) handle;
+
+    // Is GLFW initialized?
+    if( !_glfwInitialized || vt == NULL )
+    {
+        return;
+    }
+
+    info->Width              = vt->levels[ 0 ].Width;
+    info->Height             = vt->levels[ 0 ].Height;
+    info->TileSize           = vt->tileSize;
+    info->Border             = _GLFW_VT_BORDER;
+    info->Levels             = vt->levelCount;
+    info->TilesX             = vt->tilesX[ 0 ];
+    info->TilesY             = vt->tilesY[ 0 ];
+    info->CacheTilesX        = vt->slotsX;
+    info->CacheTilesY        = vt->slotsY;
+    info->CacheTexture       = vt->cacheTexture;
+    info->IndirectionTexture = vt->indirectionTexture;
+}
@@ -153,10 +153,16 @@ static void _glfwInitThreads( void )
     // Fill out information about the main thread (this thread)
     _glfwThrd.First.ID       = _glfwThrd.NextID ++;
     _glfwThrd.First.Function = NULL;
-    _glfwThrd.First.Handle   = GetCurrentThread();
+    _glfwThrd.First.Handle   = NULL;
     _glfwThrd.First.WinID    = GetCurrentThreadId();
     _glfwThrd.First.Previous = NULL;
     _glfwThrd.First.Next     = NULL;
+
+    // GetCurrentThread() only returns a pseudo handle, which would refer
+    // to whatever thread uses it
+    DuplicateHandle( GetCurrentProcess(), GetCurrentThread(),
+                     GetCurrentProcess(), &_glfwThrd.First.Handle,
+                     0, FALSE, DUPLICATE_SAME_ACCESS );
 }
 
 
@@ -186,7 +192,7 @@ static void _glfwTerminateThreads( void )
             CloseHandle( t->Handle );
 
             // Free memory allocated for this thread
-            free( (void *) t );
+            _glfwFree( (void *) t );
         }
 
         // Select next thread in list
@@ -196,6 +202,11 @@ static void _glfwTerminateThreads( void )
     // Leave critical section
     LEAVE_THREAD_CRITICAL_SECTION
 
+    if( _glfwThrd.First.Handle != NULL )
+    {
+        CloseHandle( _glfwThrd.First.Handle );
+    }
+
     // Delete critical section handle
     DeleteCriticalSection( &_glfwThrd.CriticalSection );
 }
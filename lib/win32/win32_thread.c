@@ -55,10 +55,222 @@ typedef struct {
 
 
 
+#ifndef STACK_SIZE_PARAM_IS_A_RESERVATION
+ #define STACK_SIZE_PARAM_IS_A_RESERVATION 0x00010000
+#endif
+
+// SetThreadDescription is only available on Windows 10 and later
+typedef HRESULT (WINAPI * SETTHREADDESCRIPTION_T)(HANDLE,PCWSTR);
+
+// GetLogicalProcessorInformation is only available on Windows XP SP3 and
+// later, and missing from older headers, so its types are declared here
+enum {
+    _GLFW_RELATION_CORE    = 0,
+    _GLFW_RELATION_NUMA    = 1,
+    _GLFW_RELATION_CACHE   = 2,
+    _GLFW_RELATION_PACKAGE = 3
+};
+
+enum {
+    _GLFW_CACHE_UNIFIED     = 0,
+    _GLFW_CACHE_INSTRUCTION = 1,
+    _GLFW_CACHE_DATA        = 2
+};
+
+typedef struct {
+    ULONG_PTR ProcessorMask;
+    int       Relationship;
+    union {
+        BYTE  Flags;
+        DWORD NodeNumber;
+        struct {
+            BYTE  Level;
+            BYTE  Associativity;
+            WORD  LineSize;
+            DWORD Size;
+            int   Type;
+        } Cache;
+        ULONGLONG Reserved[ 2 ];
+    } Info;
+} _GLFWprocinfo;
+
+typedef BOOL (WINAPI * GETLOGICALPROCESSORINFORMATION_T)(_GLFWprocinfo*,PDWORD);
+
+
+
 //************************************************************************
 //****                  GLFW internal functions                       ****
 //************************************************************************
 
+//========================================================================
+// Restrict a thread to a set of processors. Only as many processors as
+// fit in a pointer can be used
+//========================================================================
+
+static int SetAffinity( HANDLE hThread, const GLFWcpumask *mask )
+{
+    DWORD_PTR threadmask, processmask, systemmask;
+    int       i;
+
+    threadmask = 0;
+    for( i = 0; i < (int) ( 8 * sizeof( DWORD_PTR ) ); i ++ )
+    {
+        if( mask->Bits[ i / 32 ] & ( 1U << ( i % 32 ) ) )
+        {
+            threadmask |= (DWORD_PTR) 1 << i;
+        }
+    }
+
+    // An empty set means any processor the process may use
+    if( threadmask == 0 )
+    {
+        if( !GetProcessAffinityMask( GetCurrentProcess(), &processmask,
+                                     &systemmask ) )
+        {
+            return GL_FALSE;
+        }
+        threadmask = processmask;
+    }
+
+    return SetThreadAffinityMask( hThread, threadmask ) != 0;
+}
+
+
+//========================================================================
+// Name a thread, if the system supports it
+//========================================================================
+
+static void SetName( HANDLE hThread, const char *name )
+{
+    SETTHREADDESCRIPTION_T SetThreadDescription_ptr;
+    WCHAR                  wideName[ 64 ];
+
+    SetThreadDescription_ptr = (SETTHREADDESCRIPTION_T)
+        GetProcAddress( GetModuleHandleA( "kernel32.dll" ),
+                        "SetThreadDescription" );
+    if( SetThreadDescription_ptr == NULL )
+    {
+        return;
+    }
+
+    if( MultiByteToWideChar( CP_UTF8, 0, name, -1, wideName, 64 ) == 0 )
+    {
+        return;
+    }
+
+    (void) SetThreadDescription_ptr( hThread, wideName );
+}
+
+
+//========================================================================
+// Return the lowest processor in a processor mask
+//========================================================================
+
+static int LowestProcessor( ULONG_PTR mask )
+{
+    int i;
+
+    for( i = 0; i < (int) ( 8 * sizeof( ULONG_PTR ) ); i ++ )
+    {
+        if( mask & ( (ULONG_PTR) 1 << i ) )
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
+//========================================================================
+// Apply one logical processor relation to the processors it covers
+//========================================================================
+
+static void ApplyRelation( GLFWtopology *topology, const _GLFWprocinfo *info,
+                           int package )
+{
+    GLFWprocessorinfo *p;
+    GLFWcacheinfo     *cache;
+    int               i, c, kind, lowest;
+
+    c = 0;
+    if( info->Relationship == _GLFW_RELATION_CACHE )
+    {
+        switch( info->Info.Cache.Type )
+        {
+            case _GLFW_CACHE_UNIFIED:
+                kind = GLFW_CACHE_UNIFIED;
+                break;
+            case _GLFW_CACHE_INSTRUCTION:
+                kind = GLFW_CACHE_INSTRUCTION;
+                break;
+            case _GLFW_CACHE_DATA:
+                kind = GLFW_CACHE_DATA;
+                break;
+            default:
+                return;
+        }
+
+        // Caches of the same kind but different sizes are reported
+        // separately
+        for( c = 0; c < topology->CacheCount; c ++ )
+        {
+            cache = &topology->Caches[ c ];
+            if( cache->Level == info->Info.Cache.Level &&
+                cache->Type == kind &&
+                cache->Size == (int) info->Info.Cache.Size &&
+                cache->LineSize == info->Info.Cache.LineSize )
+            {
+                break;
+            }
+        }
+        if( c == topology->CacheCount )
+        {
+            if( c == GLFW_MAX_CACHES )
+            {
+                return;
+            }
+            cache = &topology->Caches[ c ];
+            cache->Level    = info->Info.Cache.Level;
+            cache->Type     = kind;
+            cache->Size     = (int) info->Info.Cache.Size;
+            cache->LineSize = info->Info.Cache.LineSize;
+            topology->CacheCount ++;
+        }
+    }
+
+    lowest = LowestProcessor( info->ProcessorMask );
+    for( i = 0; i < (int) ( 8 * sizeof( ULONG_PTR ) ); i ++ )
+    {
+        if( !( info->ProcessorMask & ( (ULONG_PTR) 1 << i ) ) )
+        {
+            continue;
+        }
+        p = &topology->Processors[ i ];
+
+        switch( info->Relationship )
+        {
+            case _GLFW_RELATION_CORE:
+                p->Core = lowest;
+                if( p->Package < 0 )
+                {
+                    p->Package = 0;
+                }
+                break;
+            case _GLFW_RELATION_PACKAGE:
+                p->Package = package;
+                break;
+            case _GLFW_RELATION_NUMA:
+                p->Node = (int) info->Info.NodeNumber;
+                break;
+            case _GLFW_RELATION_CACHE:
+                p->Cache[ c ] = lowest;
+                break;
+        }
+    }
+}
+
+
 //========================================================================
 // This is simply a "wrapper" for calling the user thread function.
 //========================================================================
@@ -100,18 +312,20 @@ DWORD WINAPI _glfwNewThread( LPVOID lpParam )
 // Create a new thread
 //========================================================================
 
-GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg )
+GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg,
+                                      const GLFWthreadattr *attr )
 {
     GLFWthread  ID;
-    _GLFWthread *t, *t_tmp;
+    _GLFWthread *t;
     HANDLE      hThread;
-    DWORD       dwThreadId;
+    DWORD       dwThreadId, dwStackSize;
 
     // Enter critical section
     ENTER_THREAD_CRITICAL_SECTION
 
     // Create a new thread information memory area
-    t = (_GLFWthread *) malloc( sizeof(_GLFWthread) );
+    t = (_GLFWthread *) _glfwMallocAs( sizeof(_GLFWthread),
+                                       GLFW_MEMORY_THREAD );
     if( t == NULL )
     {
         // Leave critical section
@@ -126,20 +340,23 @@ GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg )
     t->Function = fun;
     t->ID       = ID;
 
-    // Create thread
+    // Zero means the default stack size (1 MB)
+    dwStackSize = attr != NULL ? (DWORD) attr->StackSize : 0;
+
+    // Create thread. It is started once its attributes are set
     hThread = CreateThread(
         NULL,              // Default security attributes
-        0,                 // Default stack size (1 MB)
+        dwStackSize,       // Stack size
         _glfwNewThread,    // Thread function (a wrapper function)
         (LPVOID)arg,       // Argument to thread is the user argument
-        0,                 // Default creation flags
+        CREATE_SUSPENDED | STACK_SIZE_PARAM_IS_A_RESERVATION,
         &dwThreadId        // Returned thread identifier
     );
 
     // Did the thread creation fail?
     if( hThread == NULL )
     {
-        free( (void *) t );
+        _glfwFree( (void *) t );
         LEAVE_THREAD_CRITICAL_SECTION
         return -1;
     }
@@ -148,15 +365,26 @@ GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg )
     t->Handle = hThread;
     t->WinID  = dwThreadId;
 
-    // Append thread to thread list
-    t_tmp = &_glfwThrd.First;
-    while( t_tmp->Next != NULL )
+    // Scheduling policies are not supported, but the GLFW priorities are
+    // the same as the Windows thread priorities
+    if( attr != NULL )
     {
-        t_tmp = t_tmp->Next;
+        if( attr->Priority != GLFW_PRIORITY_NORMAL )
+        {
+            (void) SetThreadPriority( hThread, attr->Priority );
+        }
+        (void) SetAffinity( hThread, &attr->Affinity );
+        if( attr->Name != NULL )
+        {
+            SetName( hThread, attr->Name );
+        }
     }
-    t_tmp->Next = t;
-    t->Previous = t_tmp;
-    t->Next     = NULL;
+
+    // Append thread to thread list
+    _glfwAppendThread( t );
+
+    // The thread looks itself up in the list when it starts
+    ResumeThread( hThread );
 
     // Leave critical section
     LEAVE_THREAD_CRITICAL_SECTION
@@ -201,6 +429,36 @@ void _glfwPlatformDestroyThread( GLFWthread ID )
 }
 
 
+//========================================================================
+// Restrict a thread to a set of processors
+//========================================================================
+
+int _glfwPlatformSetThreadAffinity( GLFWthread ID, const GLFWcpumask *mask )
+{
+    _GLFWthread *t;
+    int         result;
+
+    // Enter critical section
+    ENTER_THREAD_CRITICAL_SECTION
+
+    // Get thread information pointer
+    t = _glfwGetThreadPointer( ID );
+    if( t == NULL )
+    {
+        LEAVE_THREAD_CRITICAL_SECTION
+        return GL_FALSE;
+    }
+
+    // The handle is only valid while the thread is in the list
+    result = SetAffinity( t->Handle, mask );
+
+    // Leave critical section
+    LEAVE_THREAD_CRITICAL_SECTION
+
+    return result;
+}
+
+
 //========================================================================
 // Wait for a thread to die
 //========================================================================
@@ -297,7 +555,8 @@ GLFWmutex _glfwPlatformCreateMutex( void )
     CRITICAL_SECTION *mutex;
 
     // Allocate memory for mutex
-    mutex = (CRITICAL_SECTION *) malloc( sizeof(CRITICAL_SECTION) );
+    mutex = (CRITICAL_SECTION *) _glfwMallocAs( sizeof(CRITICAL_SECTION),
+                                                GLFW_MEMORY_SYNC );
     if( !mutex )
     {
         return NULL;
@@ -319,7 +578,7 @@ void _glfwPlatformDestroyMutex( GLFWmutex mutex )
 {
     // Destroy mutex
     DeleteCriticalSection( (CRITICAL_SECTION *) mutex );
-    free( mutex );
+    _glfwFree( mutex );
 }
 
 
@@ -354,7 +613,8 @@ GLFWcond _glfwPlatformCreateCond( void )
     _GLFWcond   *cond;
 
     // Allocate memory for condition variable
-    cond = (_GLFWcond *) malloc( sizeof(_GLFWcond) );
+    cond = (_GLFWcond *) _glfwMallocAs( sizeof(_GLFWcond),
+                                        GLFW_MEMORY_SYNC );
     if( !cond )
     {
         return NULL;
@@ -387,7 +647,7 @@ void _glfwPlatformDestroyCond( GLFWcond cond )
     DeleteCriticalSection( &((_GLFWcond *)cond)->waiters_count_lock );
 
     // Free memory for condition variable
-    free( (void *) cond );
+    _glfwFree( (void *) cond );
 }
 
 
@@ -395,7 +655,7 @@ void _glfwPlatformDestroyCond( GLFWcond cond )
 // Wait for a condition to be raised
 //========================================================================
 
-void _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex, double timeout )
+int _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex, double timeout )
 {
     _GLFWcond *cv = (_GLFWcond *) cond;
     int       result, last_waiter;
@@ -445,6 +705,8 @@ void _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex, double timeout )
 
     // Reacquire the mutex
     EnterCriticalSection( (CRITICAL_SECTION *) mutex );
+
+    return result != WAIT_TIMEOUT;
 }
 
 
@@ -504,3 +766,96 @@ int _glfwPlatformGetNumberOfProcessors( void )
     return (int) si.dwNumberOfProcessors;
 }
 
+
+//========================================================================
+// Describe the processors of the system. Cores and cache instances are
+// given by their lowest processor. Only the first processor group is
+// described
+//========================================================================
+
+int _glfwPlatformGetProcessorTopology( GLFWtopology *topology )
+{
+    GETLOGICALPROCESSORINFORMATION_T GetLogicalProcessorInformation_ptr;
+    _GLFWprocinfo *info;
+    DWORD         size;
+    int           i, count, package;
+
+    GetLogicalProcessorInformation_ptr = (GETLOGICALPROCESSORINFORMATION_T)
+        GetProcAddress( GetModuleHandleA( "kernel32.dll" ),
+                        "GetLogicalProcessorInformation" );
+    if( GetLogicalProcessorInformation_ptr == NULL )
+    {
+        return GL_FALSE;
+    }
+
+    size = 0;
+    if( GetLogicalProcessorInformation_ptr( NULL, &size ) ||
+        GetLastError() != ERROR_INSUFFICIENT_BUFFER )
+    {
+        return GL_FALSE;
+    }
+    info = (_GLFWprocinfo *) _glfwMalloc( size );
+    if( info == NULL )
+    {
+        return GL_FALSE;
+    }
+    if( !GetLogicalProcessorInformation_ptr( info, &size ) )
+    {
+        _glfwFree( info );
+        return GL_FALSE;
+    }
+    count = (int) ( size / sizeof( _GLFWprocinfo ) );
+
+    // The cores tell which processors exist, so they go first
+    for( i = 0; i < count; i ++ )
+    {
+        if( info[ i ].Relationship == _GLFW_RELATION_CORE )
+        {
+            ApplyRelation( topology, &info[ i ], 0 );
+        }
+    }
+
+    package = 0;
+    for( i = 0; i < count; i ++ )
+    {
+        if( info[ i ].Relationship == _GLFW_RELATION_PACKAGE )
+        {
+            ApplyRelation( topology, &info[ i ], package ++ );
+        }
+        else if( info[ i ].Relationship != _GLFW_RELATION_CORE )
+        {
+            ApplyRelation( topology, &info[ i ], 0 );
+        }
+    }
+
+    _glfwFree( info );
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Atomically add to a value, returning the new value
+//========================================================================
+//========================================================================
+// Atomically add to a value, returning the new value
+//========================================================================
+
+long _glfwPlatformAtomicAdd( volatile long *value, long delta )
+{
+    return InterlockedExchangeAdd( (LONG volatile *) value, delta ) + delta;
+}
+
+
+//========================================================================
+// Atomically replace a value if it equals the expected one, returning the
+// previous value
+//========================================================================
+
+long _glfwPlatformAtomicCompareSwap( volatile long *value, long expected,
+                                     long desired )
+{
+    return InterlockedCompareExchange( (LONG volatile *) value, desired,
+                                       expected );
+}
+
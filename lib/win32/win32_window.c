@@ -189,7 +189,8 @@ static _GLFWfbconfig *getFBConfigs( unsigned int *found )
         return NULL;
     }
 
-    fbconfigs = (_GLFWfbconfig*) malloc( sizeof( _GLFWfbconfig ) * count );
+    fbconfigs = (_GLFWfbconfig*)
+        _glfwMallocAs( sizeof( _GLFWfbconfig ) * count, GLFW_MEMORY_VIDEO );
     if( !fbconfigs )
     {
         fprintf(stderr, "Out of memory");
@@ -308,7 +309,7 @@ static _GLFWfbconfig *getFBConfigs( unsigned int *found )
 
     if( *found == 0 )
     {
-        free( fbconfigs );
+        _glfwFree( fbconfigs );
         return NULL;
     }
 
@@ -1141,13 +1142,13 @@ static int choosePixelFormat( const _GLFWfbconfig *fbconfig )
     if( !closest )
     {
         fprintf( stderr, "Failed to select a GLFWFBConfig from the alternatives\n" );
-        free( fbconfigs );
+        _glfwFree( fbconfigs );
         return 0;
     }
 
     pixelFormat = (int) closest->platformID;
 
-    free( fbconfigs );
+    _glfwFree( fbconfigs );
     fbconfigs = NULL;
     closest = NULL;
 
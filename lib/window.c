@@ -575,6 +575,74 @@ GLFWAPI int GLFWAPIENTRY glfwOpenWindow( int width, int height,
         ( _glfwWin.glMajor >= 2 ) || ( _glfwWin.glMinor >= 4 ) ||
         glfwExtensionSupported( "GL_SGIS_generate_mipmap" );
 
+    // Do we have cube map textures (added to core in version 1.3)?
+    _glfwWin.has_GL_ARB_texture_cube_map =
+        ( _glfwWin.glMajor >= 2 ) || ( _glfwWin.glMinor >= 3 ) ||
+        glfwExtensionSupported( "GL_ARB_texture_cube_map" );
+
+    // Do we have array textures (added to core in version 3.0)?
+    _glfwWin.has_GL_EXT_texture_array =
+        ( _glfwWin.glMajor >= 3 ) ||
+        glfwExtensionSupported( "GL_EXT_texture_array" );
+
+    if( _glfwWin.has_GL_EXT_texture_array )
+    {
+        _glfwWin.TexImage3D = (PFNGLTEXIMAGE3DPROC)
+            glfwGetProcAddress( "glTexImage3D" );
+        _glfwWin.TexSubImage3D = (PFNGLTEXSUBIMAGE3DPROC)
+            glfwGetProcAddress( "glTexSubImage3D" );
+        if( !_glfwWin.TexImage3D || !_glfwWin.TexSubImage3D )
+        {
+            _glfwWin.has_GL_EXT_texture_array = GL_FALSE;
+        }
+    }
+
+    // Do we have S3TC compressed textures (and the compressed texture
+    // functions added to core in version 1.3)?
+    _glfwWin.has_GL_EXT_texture_compression_s3tc =
+        glfwExtensionSupported( "GL_EXT_texture_compression_s3tc" );
+
+    if( _glfwWin.has_GL_EXT_texture_compression_s3tc )
+    {
+        _glfwWin.CompressedTexImage2D = (PFNGLCOMPRESSEDTEXIMAGE2DPROC)
+            glfwGetProcAddress( "glCompressedTexImage2D" );
+        _glfwWin.GetCompressedTexImage = (PFNGLGETCOMPRESSEDTEXIMAGEPROC)
+            glfwGetProcAddress( "glGetCompressedTexImage" );
+        if( !_glfwWin.CompressedTexImage2D || !_glfwWin.GetCompressedTexImage )
+        {
+            _glfwWin.has_GL_EXT_texture_compression_s3tc = GL_FALSE;
+        }
+    }
+
+    // Do we have pixel buffer objects (added to core in version 2.1, with
+    // the buffer object functions added in version 1.5)?
+    _glfwWin.has_GL_ARB_pixel_buffer_object =
+        ( _glfwWin.glMajor >= 3 ) ||
+        ( _glfwWin.glMajor == 2 && _glfwWin.glMinor >= 1 ) ||
+        glfwExtensionSupported( "GL_ARB_pixel_buffer_object" );
+
+    if( _glfwWin.has_GL_ARB_pixel_buffer_object )
+    {
+        _glfwWin.GenBuffers = (PFNGLGENBUFFERSPROC)
+            glfwGetProcAddress( "glGenBuffers" );
+        _glfwWin.DeleteBuffers = (PFNGLDELETEBUFFERSPROC)
+            glfwGetProcAddress( "glDeleteBuffers" );
+        _glfwWin.BindBuffer = (PFNGLBINDBUFFERPROC)
+            glfwGetProcAddress( "glBindBuffer" );
+        _glfwWin.BufferData = (PFNGLBUFFERDATAPROC)
+            glfwGetProcAddress( "glBufferData" );
+        _glfwWin.MapBuffer = (PFNGLMAPBUFFERPROC)
+            glfwGetProcAddress( "glMapBuffer" );
+        _glfwWin.UnmapBuffer = (PFNGLUNMAPBUFFERPROC)
+            glfwGetProcAddress( "glUnmapBuffer" );
+        if( !_glfwWin.GenBuffers || !_glfwWin.DeleteBuffers ||
+            !_glfwWin.BindBuffer || !_glfwWin.BufferData ||
+            !_glfwWin.MapBuffer || !_glfwWin.UnmapBuffer )
+        {
+            _glfwWin.has_GL_ARB_pixel_buffer_object = GL_FALSE;
+        }
+    }
+
     if( _glfwWin.glMajor > 2 )
     {
         _glfwWin.GetStringi = (PFNGLGETSTRINGIPROC) glfwGetProcAddress( "glGetStringi" );
@@ -681,6 +749,14 @@ GLFWAPI void GLFWAPIENTRY glfwCloseWindow( void )
     // Show mouse pointer again (if hidden)
     glfwEnable( GLFW_MOUSE_CURSOR );
 
+    // Cached and resident textures and capture buffers die with the context
+    if( _glfwWin.opened )
+    {
+        _glfwClearTextureCache();
+        _glfwEvictResidentTextures();
+        _glfwFlushCaptures();
+    }
+
     _glfwPlatformCloseWindow();
 
     memset( &_glfwWin, 0, sizeof(_glfwWin) );
@@ -51,6 +51,26 @@
 #ifdef _GLFW_HAS_PTHREAD
  #include <pthread.h>
  #include <sched.h>
+ #include <errno.h>
+ #include <time.h>
+ #include <limits.h>
+#endif
+
+// Do we have Linux futexes? Mutexes and condition variables are then
+// built on them directly, and need no creation when statically allocated
+#ifdef _GLFW_HAS_FUTEX
+ #include <limits.h>
+ #include <linux/futex.h>
+ #include <sys/syscall.h>
+ #define _GLFW_HAS_STATIC_SYNC
+#endif
+
+// Can threads be pinned, renamed and reprioritized through Linux system
+// calls?
+#ifdef _GLFW_HAS_LINUX_SCHED
+ #include <sys/syscall.h>
+ #include <sys/resource.h>
+ #include <sys/prctl.h>
 #endif
 
 // We need declarations for GLX version 1.3 or above even if the server doesn't
@@ -208,6 +228,35 @@ typedef GLXContext (*PFNGLXCREATECONTEXTATTRIBSARBPROC)( Display *display, GLXFB
 #endif /*GLX_ARB_create_context_profile*/
 
 
+#ifndef GL_VERSION_1_2
+
+typedef void (APIENTRY *PFNGLTEXIMAGE3DPROC) (GLenum, GLint, GLint, GLsizei, GLsizei, GLsizei, GLint, GLenum, GLenum, const GLvoid *);
+typedef void (APIENTRY *PFNGLTEXSUBIMAGE3DPROC) (GLenum, GLint, GLint, GLint, GLint, GLsizei, GLsizei, GLsizei, GLenum, GLenum, const GLvoid *);
+
+#endif /*GL_VERSION_1_2*/
+
+
+#ifndef GL_VERSION_1_3
+
+typedef void (APIENTRY *PFNGLCOMPRESSEDTEXIMAGE2DPROC) (GLenum, GLint, GLenum, GLsizei, GLsizei, GLint, GLsizei, const GLvoid *);
+typedef void (APIENTRY *PFNGLGETCOMPRESSEDTEXIMAGEPROC) (GLenum, GLint, GLvoid *);
+
+#endif /*GL_VERSION_1_3*/
+
+
+#ifndef GL_VERSION_1_5
+
+typedef ptrdiff_t GLsizeiptr;
+typedef void (APIENTRY *PFNGLGENBUFFERSPROC) (GLsizei, GLuint *);
+typedef void (APIENTRY *PFNGLDELETEBUFFERSPROC) (GLsizei, const GLuint *);
+typedef void (APIENTRY *PFNGLBINDBUFFERPROC) (GLenum, GLuint);
+typedef void (APIENTRY *PFNGLBUFFERDATAPROC) (GLenum, GLsizeiptr, const GLvoid *, GLenum);
+typedef GLvoid* (APIENTRY *PFNGLMAPBUFFERPROC) (GLenum, GLenum);
+typedef GLboolean (APIENTRY *PFNGLUNMAPBUFFERPROC) (GLenum);
+
+#endif /*GL_VERSION_1_5*/
+
+
 #ifndef GL_VERSION_3_0
 
 typedef const GLubyte * (APIENTRY *PFNGLGETSTRINGIPROC) (GLenum, GLuint);
@@ -272,10 +321,24 @@ struct _GLFWwin_struct {
     // OpenGL extensions and context attributes
     int       has_GL_SGIS_generate_mipmap;
     int       has_GL_ARB_texture_non_power_of_two;
+    int       has_GL_ARB_texture_cube_map;
+    int       has_GL_EXT_texture_array;
+    int       has_GL_EXT_texture_compression_s3tc;
+    int       has_GL_ARB_pixel_buffer_object;
     int       glMajor, glMinor, glRevision;
     int       glForward, glDebug, glProfile;
 
     PFNGLGETSTRINGIPROC GetStringi;
+    PFNGLTEXIMAGE3DPROC TexImage3D;
+    PFNGLTEXSUBIMAGE3DPROC TexSubImage3D;
+    PFNGLCOMPRESSEDTEXIMAGE2DPROC CompressedTexImage2D;
+    PFNGLGETCOMPRESSEDTEXIMAGEPROC GetCompressedTexImage;
+    PFNGLGENBUFFERSPROC GenBuffers;
+    PFNGLDELETEBUFFERSPROC DeleteBuffers;
+    PFNGLBINDBUFFERPROC BindBuffer;
+    PFNGLBUFFERDATAPROC BufferData;
+    PFNGLMAPBUFFERPROC MapBuffer;
+    PFNGLUNMAPBUFFERPROC UnmapBuffer;
 
 
 // ========= PLATFORM SPECIFIC PART ======================================
@@ -438,17 +501,32 @@ struct _GLFWthread_struct {
     // Pointer to previous and next threads in linked list
     _GLFWthread   *Previous, *Next;
 
+    // Next thread in the same thread ID hash bucket
+    _GLFWthread   *HashNext;
+
     // GLFW user side thread information
     GLFWthread    ID;
     GLFWthreadfun Function;
 
 // ========= PLATFORM SPECIFIC PART ======================================
 
+    // User argument to the thread function
+    void          *Arg;
+
     // System side thread information
 #ifdef _GLFW_HAS_PTHREAD
     pthread_t     PosixID;
 #endif
 
+    // Attributes the thread applies to itself when it starts. Tid is the
+    // kernel thread ID, or zero until the thread has started
+#ifdef _GLFW_HAS_LINUX_SCHED
+    int           Tid;
+    GLFWcpumask   Affinity;
+    int           Policy, Priority;
+    char          Name[ 16 ];
+#endif
+
 };
 
 
@@ -465,6 +543,9 @@ GLFWGLOBAL struct {
     // First thread in linked list (always the main thread)
     _GLFWthread      First;
 
+    // Thread ID hash table (all threads but the main thread)
+    _GLFWthread      *Buckets[ _GLFW_THREAD_BUCKETS ];
+
 // ========= PLATFORM SPECIFIC PART ======================================
 
     // Critical section lock
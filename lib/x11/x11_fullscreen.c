@@ -372,7 +372,8 @@ int _glfwPlatformGetVideoModes( GLFWvidmode *list, int maxcount )
         return 0;
     }
 
-    rgbarray = (int*) malloc( sizeof(int) * viscount );
+    rgbarray = (int*) _glfwMallocAs( sizeof(int) * viscount,
+                                     GLFW_MEMORY_VIDEO );
     rgbcount = 0;
 
     // Build RGB array
@@ -420,7 +421,9 @@ int _glfwPlatformGetVideoModes( GLFWvidmode *list, int maxcount )
         sc = XRRGetScreenInfo( dpy, RootWindow( dpy, screen ) );
         sizelist = XRRConfigSizes( sc, &sizecount );
 
-        resarray = (struct _glfwResolution*) malloc( sizeof(struct _glfwResolution) * sizecount );
+        resarray = (struct _glfwResolution*)
+            _glfwMallocAs( sizeof(struct _glfwResolution) * sizecount,
+                           GLFW_MEMORY_VIDEO );
 
         for( k = 0; k < sizecount; k++ )
         {
@@ -439,7 +442,9 @@ int _glfwPlatformGetVideoModes( GLFWvidmode *list, int maxcount )
 
         XF86VidModeGetAllModeLines( dpy, screen, &modecount, &modelist );
 
-        resarray = (struct _glfwResolution*) malloc( sizeof(struct _glfwResolution) * modecount );
+        resarray = (struct _glfwResolution*)
+            _glfwMallocAs( sizeof(struct _glfwResolution) * modecount,
+                           GLFW_MEMORY_VIDEO );
 
         for( k = 0; k < modecount; k++ )
         {
@@ -470,7 +475,9 @@ int _glfwPlatformGetVideoModes( GLFWvidmode *list, int maxcount )
     if( !resarray )
     {
         rescount = 1;
-        resarray = (struct _glfwResolution*) malloc( sizeof(struct _glfwResolution) * rescount );
+        resarray = (struct _glfwResolution*)
+            _glfwMallocAs( sizeof(struct _glfwResolution) * rescount,
+                           GLFW_MEMORY_VIDEO );
 
         resarray[ 0 ].width = DisplayWidth( dpy, screen );
         resarray[ 0 ].height = DisplayHeight( dpy, screen );
@@ -494,8 +501,8 @@ int _glfwPlatformGetVideoModes( GLFWvidmode *list, int maxcount )
     // Free visuals list
     XFree( vislist );
 
-    free( resarray );
-    free( rgbarray );
+    _glfwFree( resarray );
+    _glfwFree( rgbarray );
 
     return count;
 }
@@ -58,6 +58,9 @@ static void initThreads( void )
 #ifdef _GLFW_HAS_PTHREAD
     _glfwThrd.First.PosixID  = pthread_self();
 #endif
+#ifdef _GLFW_HAS_LINUX_SCHED
+    _glfwThrd.First.Tid      = (int) syscall( SYS_gettid );
+#endif
 }
 
 
@@ -86,7 +89,7 @@ static void terminateThreads( void )
         pthread_kill( t->PosixID, SIGKILL );
 
         // Free memory allocated for this thread
-        free( (void *) t );
+        _glfwFree( (void *) t );
 
         // Select next thread in list
         t = t_next;
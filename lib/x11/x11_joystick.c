@@ -141,19 +141,21 @@ void _glfwInitJoysticks( void )
 
                 // Allocate memory for joystick state
                 _glfwJoy[ joy_count ].Axis =
-                    (float *) malloc( sizeof(float) *
-                                      _glfwJoy[ joy_count ].NumAxes );
+                    (float *) _glfwMallocAs( sizeof(float) *
+                                      _glfwJoy[ joy_count ].NumAxes,
+                                      GLFW_MEMORY_JOYSTICK );
                 if( _glfwJoy[ joy_count ].Axis == NULL )
                 {
                     close( fd );
                     continue;
                 }
                 _glfwJoy[ joy_count ].Button =
-                    (unsigned char *) malloc( sizeof(char) *
-                                     _glfwJoy[ joy_count ].NumButtons );
+                    (unsigned char *) _glfwMallocAs( sizeof(char) *
+                                     _glfwJoy[ joy_count ].NumButtons,
+                                     GLFW_MEMORY_JOYSTICK );
                 if( _glfwJoy[ joy_count ].Button == NULL )
                 {
-                    free( _glfwJoy[ joy_count ].Axis );
+                    _glfwFree( _glfwJoy[ joy_count ].Axis );
                     close( fd );
                     continue;
                 }
@@ -197,8 +199,8 @@ void _glfwTerminateJoysticks( void )
         if( _glfwJoy[ i ].Present )
         {
             close( _glfwJoy[ i ].fd );
-            free( _glfwJoy[ i ].Axis );
-            free( _glfwJoy[ i ].Button );
+            _glfwFree( _glfwJoy[ i ].Axis );
+            _glfwFree( _glfwJoy[ i ].Button );
             _glfwJoy[ i ].Present = GL_FALSE;
         }
     }
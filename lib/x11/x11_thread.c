@@ -31,52 +31,452 @@
 #include "internal.h"
 
 
+// GCC 4.1 and later provide atomic operations on all targets we build for
+#if defined( __GNUC__ ) && \
+    ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 1 ) )
+ #define _GLFW_HAS_SYNC_BUILTINS
+#elif defined( _GLFW_HAS_PTHREAD )
+// Other compilers get atomic operations through a mutex of their own, as
+// they are used inside the thread critical section
+static pthread_mutex_t _glfwAtomicMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// Where Linux describes the processors of the system. Elsewhere the files
+// do not exist, and the topology is guessed instead
+#ifndef _GLFW_SYSFS_PATH
+ #define _GLFW_SYSFS_PATH "/sys/devices/system"
+#endif
+
+#ifdef _GLFW_HAS_TLS
+// GLFW thread ID of the current thread, if it was created by GLFW
+static __thread GLFWthread _glfwCurrentThreadID = -1;
+#endif
+
+// Timed condition variable waits use deadlines on the monotonic clock
+// where possible, so that they do not jump with the wall clock
+#if defined( CLOCK_MONOTONIC ) && ( defined( _GLFW_HAS_FUTEX ) || \
+    ( defined( _POSIX_CLOCK_SELECTION ) && _POSIX_CLOCK_SELECTION > 0 ) )
+ #define _GLFW_COND_CLOCK CLOCK_MONOTONIC
+#endif
+
+#ifdef _GLFW_HAS_FUTEX
+
+// Maximum number of times a locked mutex is polled before sleeping
+#define _GLFW_MUTEX_SPIN_LIMIT 100
+
+// Hint to the processor that we are polling
+#if defined( __i386__ ) || defined( __x86_64__ )
+ #define _glfw_cpu_relax() __asm__ __volatile__( "pause" )
+#else
+ #define _glfw_cpu_relax() __sync_synchronize()
+#endif
+
+// Futex based mutex. Word is 0 when unlocked, 1 when locked and 2 when
+// locked with possible sleepers. Spin is the recent number of polls it
+// took to get the mutex
+typedef struct {
+    volatile int Word;
+    volatile int Spin;
+} _GLFWfutexmutex;
+
+// Futex based condition variable. Sequence changes with every signal
+typedef struct {
+    volatile int Sequence;
+    volatile int Waiters;
+} _GLFWfutexcond;
+
+// Is polling a locked mutex worthwhile, or -1 if not known yet
+static int _glfwMutexSpin = -1;
+
+#endif // _GLFW_HAS_FUTEX
+
+
 
 //************************************************************************
 //****                  GLFW internal functions                       ****
 //************************************************************************
 
+//========================================================================
+// Read a short text file, without the trailing newline
+//========================================================================
+
+static int ReadSysFile( const char *path, char *buffer, int size )
+{
+    FILE *file;
+    int  length;
+
+    file = fopen( path, "r" );
+    if( file == NULL )
+    {
+        return GL_FALSE;
+    }
+    length = (int) fread( buffer, 1, size - 1, file );
+    fclose( file );
+
+    while( length > 0 && ( buffer[ length - 1 ] == '\n' ||
+                           buffer[ length - 1 ] == ' ' ) )
+    {
+        length --;
+    }
+    buffer[ length ] = 0;
+
+    return length > 0;
+}
+
+
+//========================================================================
+// Read a processor list file, such as "0-3,8-11". Returns the lowest
+// processor in the list, or -1 if it could not be read
+//========================================================================
+
+static int ReadCpuList( const char *path, GLFWcpumask *mask )
+{
+    char buffer[ 1024 ], *list, *end;
+    long first, last, i;
+    int  lowest;
+
+    memset( mask, 0, sizeof( GLFWcpumask ) );
+    if( !ReadSysFile( path, buffer, sizeof( buffer ) ) )
+    {
+        return -1;
+    }
+
+    lowest = -1;
+    list = buffer;
+    while( *list )
+    {
+        first = strtol( list, &end, 10 );
+        if( end == list || first < 0 )
+        {
+            return -1;
+        }
+        last = first;
+        if( *end == '-' )
+        {
+            list = end + 1;
+            last = strtol( list, &end, 10 );
+            if( end == list || last < first )
+            {
+                return -1;
+            }
+        }
+
+        for( i = first; i <= last && i < GLFW_MAX_PROCESSORS; i ++ )
+        {
+            mask->Bits[ i / 32 ] |= 1U << ( i % 32 );
+        }
+        if( lowest < 0 && first < GLFW_MAX_PROCESSORS )
+        {
+            lowest = (int) first;
+        }
+
+        list = end;
+        if( *list == ',' )
+        {
+            list ++;
+        }
+        else if( *list )
+        {
+            return -1;
+        }
+    }
+
+    return lowest;
+}
+
+
+//========================================================================
+// Read a number from a file, with an optional K, M or G suffix
+//========================================================================
+
+static int ReadSysNumber( const char *path, int *value )
+{
+    char buffer[ 64 ], *end;
+    long number;
+
+    if( !ReadSysFile( path, buffer, sizeof( buffer ) ) )
+    {
+        return GL_FALSE;
+    }
+
+    number = strtol( buffer, &end, 10 );
+    if( end == buffer )
+    {
+        return GL_FALSE;
+    }
+    switch( *end )
+    {
+        case 'K':
+            number <<= 10;
+            break;
+        case 'M':
+            number <<= 20;
+            break;
+        case 'G':
+            number <<= 30;
+            break;
+    }
+
+    *value = (int) number;
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Read the caches of a processor from sysfs
+//========================================================================
+
+static void ReadProcessorCaches( GLFWtopology *topology, int cpu )
+{
+    GLFWcacheinfo *cache;
+    GLFWcpumask   shared;
+    char          path[ 256 ], type[ 32 ];
+    int           index, c, level, size, linesize, kind, lowest;
+
+    for( index = 0; ; index ++ )
+    {
+        sprintf( path, _GLFW_SYSFS_PATH "/cpu/cpu%d/cache/index%d/level",
+                 cpu, index );
+        if( !ReadSysNumber( path, &level ) )
+        {
+            break;
+        }
+
+        sprintf( path, _GLFW_SYSFS_PATH "/cpu/cpu%d/cache/index%d/type",
+                 cpu, index );
+        if( !ReadSysFile( path, type, sizeof( type ) ) )
+        {
+            continue;
+        }
+        if( strcmp( type, "Data" ) == 0 )
+        {
+            kind = GLFW_CACHE_DATA;
+        }
+        else if( strcmp( type, "Instruction" ) == 0 )
+        {
+            kind = GLFW_CACHE_INSTRUCTION;
+        }
+        else if( strcmp( type, "Unified" ) == 0 )
+        {
+            kind = GLFW_CACHE_UNIFIED;
+        }
+        else
+        {
+            continue;
+        }
+
+        sprintf( path, _GLFW_SYSFS_PATH "/cpu/cpu%d/cache/index%d/size",
+                 cpu, index );
+        if( !ReadSysNumber( path, &size ) )
+        {
+            size = 0;
+        }
+        sprintf( path, _GLFW_SYSFS_PATH
+                 "/cpu/cpu%d/cache/index%d/coherency_line_size", cpu, index );
+        if( !ReadSysNumber( path, &linesize ) )
+        {
+            linesize = 0;
+        }
+
+        // An instance is known by the lowest processor sharing it
+        sprintf( path, _GLFW_SYSFS_PATH
+                 "/cpu/cpu%d/cache/index%d/shared_cpu_list", cpu, index );
+        lowest = ReadCpuList( path, &shared );
+        if( lowest < 0 )
+        {
+            lowest = cpu;
+        }
+
+        // Caches of the same kind but different sizes, as on processors
+        // with different kinds of cores, are reported separately
+        for( c = 0; c < topology->CacheCount; c ++ )
+        {
+            cache = &topology->Caches[ c ];
+            if( cache->Level == level && cache->Type == kind &&
+                cache->Size == size && cache->LineSize == linesize )
+            {
+                break;
+            }
+        }
+        if( c == topology->CacheCount )
+        {
+            if( c == GLFW_MAX_CACHES )
+            {
+                continue;
+            }
+            cache = &topology->Caches[ c ];
+            cache->Level    = level;
+            cache->Type     = kind;
+            cache->Size     = size;
+            cache->LineSize = linesize;
+            topology->CacheCount ++;
+        }
+
+        topology->Processors[ cpu ].Cache[ c ] = lowest;
+    }
+}
+
+
 #ifdef _GLFW_HAS_PTHREAD
 
 //========================================================================
-// This is simply a "wrapper" for calling the user thread function.
+// Set the scheduling policy and priority of a thread
 //========================================================================
 
-void * _glfwNewThread( void * arg )
+static int SetThreadSchedule( pthread_t thread, int policy, int priority )
 {
-    GLFWthreadfun threadfun;
-    _GLFWthread   *t;
-    pthread_t   posixID;
+    struct sched_param param;
+    int                sched, low, high;
 
-    // Get current thread ID
-    posixID = pthread_self();
+    switch( policy )
+    {
+        case GLFW_SCHED_FIFO:
+            sched = SCHED_FIFO;
+            break;
+        case GLFW_SCHED_RR:
+            sched = SCHED_RR;
+            break;
+        default:
+            sched = SCHED_OTHER;
+            break;
+    }
 
-    // Enter critical section
+    // Spread the GLFW priorities evenly over the range of the policy
+    low  = sched_get_priority_min( sched );
+    high = sched_get_priority_max( sched );
+    if( low == -1 || high == -1 )
+    {
+        return GL_FALSE;
+    }
+    param.sched_priority = low + ( high - low ) *
+        ( priority - GLFW_PRIORITY_LOWEST ) /
+        ( GLFW_PRIORITY_HIGHEST - GLFW_PRIORITY_LOWEST );
+
+    return pthread_setschedparam( thread, sched, &param ) == 0;
+}
+
+#endif // _GLFW_HAS_PTHREAD
+
+
+#ifdef _GLFW_HAS_LINUX_SCHED
+
+//========================================================================
+// Restrict a kernel thread to a set of processors
+//========================================================================
+
+static int SetKernelThreadAffinity( int tid, const GLFWcpumask *mask )
+{
+    unsigned long bits[ GLFW_MAX_PROCESSORS / ( 8 * sizeof( long ) ) ];
+    int           i, longbits, any;
+
+    // The kernel wants the set as an array of longs
+    longbits = 8 * sizeof( long );
+    memset( bits, 0, sizeof( bits ) );
+    any = GL_FALSE;
+    for( i = 0; i < GLFW_MAX_PROCESSORS; i ++ )
+    {
+        if( mask->Bits[ i / 32 ] & ( 1U << ( i % 32 ) ) )
+        {
+            bits[ i / longbits ] |= 1UL << ( i % longbits );
+            any = GL_TRUE;
+        }
+    }
+
+    // An empty set means any processor. The kernel ignores processors
+    // that do not exist
+    if( !any )
+    {
+        memset( bits, 0xff, sizeof( bits ) );
+    }
+
+    return syscall( SYS_sched_setaffinity, tid, sizeof( bits ), bits ) == 0;
+}
+
+
+//========================================================================
+// Apply the attributes stored in the thread record to the calling thread
+//========================================================================
+
+static void ApplyThreadAttribs( _GLFWthread *t )
+{
+    GLFWcpumask affinity;
+    char        name[ 16 ];
+    int         i, tid, policy, priority, level;
+
+    tid = (int) syscall( SYS_gettid );
+
+    // The affinity may be changed by another thread until the kernel
+    // thread ID is known
     ENTER_THREAD_CRITICAL_SECTION
+    t->Tid   = tid;
+    affinity = t->Affinity;
+    policy   = t->Policy;
+    priority = t->Priority;
+    memcpy( name, t->Name, sizeof( name ) );
+    LEAVE_THREAD_CRITICAL_SECTION
 
-    // Loop through entire list of threads to find the matching POSIX
-    // thread ID
-    for( t = &_glfwThrd.First; t != NULL; t = t->Next )
+    if( name[ 0 ] )
     {
-        if( t->PosixID == posixID )
+        prctl( PR_SET_NAME, (unsigned long) name, 0, 0, 0 );
+    }
+
+    for( i = 0; i < GLFW_MAX_PROCESSORS / 32; i ++ )
+    {
+        if( affinity.Bits[ i ] )
         {
+            (void) SetKernelThreadAffinity( tid, &affinity );
             break;
         }
     }
-    if( t == NULL )
+
+    // Real-time policies usually need privileges. Without them, the
+    // priority is applied to the normal policy instead
+    if( policy != GLFW_SCHED_NORMAL &&
+        SetThreadSchedule( pthread_self(), policy, priority ) )
     {
-        LEAVE_THREAD_CRITICAL_SECTION
-        return NULL;
+        return;
     }
 
-    // Get user thread function pointer
-    threadfun = t->Function;
+    // Normal threads all have the same scheduler priority on Linux, so
+    // the per-thread nice value is used instead. Raising it may fail
+    if( priority != GLFW_PRIORITY_NORMAL )
+    {
+        errno = 0;
+        level = getpriority( PRIO_PROCESS, tid );
+        if( errno == 0 )
+        {
+            (void) setpriority( PRIO_PROCESS, tid, level - 5 * priority );
+        }
+    }
+}
 
-    // Leave critical section
-    LEAVE_THREAD_CRITICAL_SECTION
+#endif // _GLFW_HAS_LINUX_SCHED
+
+
+#ifdef _GLFW_HAS_PTHREAD
+
+//========================================================================
+// This is simply a "wrapper" for calling the user thread function.
+//========================================================================
+
+void * _glfwNewThread( void * arg )
+{
+    _GLFWthread *t = (_GLFWthread *) arg;
+
+    // The thread record is filled in before the thread is started, so it
+    // can be read without entering the critical section
+#ifdef _GLFW_HAS_TLS
+    _glfwCurrentThreadID = t->ID;
+#endif
+
+#ifdef _GLFW_HAS_LINUX_SCHED
+    // Scheduling attributes are applied by the thread itself, as only it
+    // knows its kernel thread ID
+    ApplyThreadAttribs( t );
+#endif
 
     // Call the user thread function
-    threadfun( arg );
+    t->Function( t->Arg );
 
     // Remove thread from thread list
     ENTER_THREAD_CRITICAL_SECTION
@@ -90,6 +490,203 @@ void * _glfwNewThread( void * arg )
 #endif // _GLFW_HAS_PTHREAD
 
 
+#ifdef _GLFW_HAS_PTHREAD
+
+//========================================================================
+// Compute the deadline of a timed condition variable wait
+//========================================================================
+
+static void GetDeadline( struct timespec *deadline, double timeout )
+{
+    long sec, nsec;
+#if !defined( _GLFW_COND_CLOCK )
+    struct timeval currenttime;
+#endif
+
+    if( timeout < 0.0 )
+    {
+        timeout = 0.0;
+    }
+    sec  = (long) timeout;
+    nsec = (long) ((timeout - (double) sec) * 1000000000.0);
+
+#if defined( _GLFW_COND_CLOCK )
+    clock_gettime( _GLFW_COND_CLOCK, deadline );
+#else
+    gettimeofday( &currenttime, NULL );
+    deadline->tv_sec  = currenttime.tv_sec;
+    deadline->tv_nsec = currenttime.tv_usec * 1000L;
+#endif
+
+    deadline->tv_sec  += sec;
+    deadline->tv_nsec += nsec;
+    if( deadline->tv_nsec >= 1000000000L )
+    {
+        deadline->tv_nsec -= 1000000000L;
+        deadline->tv_sec ++;
+    }
+}
+
+#endif // _GLFW_HAS_PTHREAD
+
+
+#ifdef _GLFW_HAS_FUTEX
+
+//========================================================================
+// Futex system call. Deadlines are absolute on the monotonic clock
+//========================================================================
+
+static int Futex( volatile int *word, int op, int value,
+                  const struct timespec *deadline )
+{
+    return (int) syscall( SYS_futex, word, op, value, deadline, NULL,
+                          FUTEX_BITSET_MATCH_ANY );
+}
+
+
+//========================================================================
+// Lock a futex mutex
+//========================================================================
+
+static void LockFutexMutex( _GLFWfutexmutex *mutex )
+{
+    int state, spins, limit;
+
+    if( __sync_val_compare_and_swap( &mutex->Word, 0, 1 ) == 0 )
+    {
+        return;
+    }
+
+    if( _glfwMutexSpin < 0 )
+    {
+        _glfw_numprocessors( spins );
+        _glfwMutexSpin = ( spins > 1 );
+    }
+
+    // The owner may be about to release the mutex on another processor,
+    // so poll it for a while first. How long adapts to how long it took
+    // recently, so that mutexes held for long do not waste time on it
+    if( _glfwMutexSpin )
+    {
+        limit = mutex->Spin * 2 + 10;
+        if( limit > _GLFW_MUTEX_SPIN_LIMIT )
+        {
+            limit = _GLFW_MUTEX_SPIN_LIMIT;
+        }
+
+        for( spins = 1;  spins <= limit;  spins ++ )
+        {
+            _glfw_cpu_relax();
+            if( mutex->Word == 0 &&
+                __sync_val_compare_and_swap( &mutex->Word, 0, 1 ) == 0 )
+            {
+                break;
+            }
+        }
+
+        mutex->Spin += ( spins - mutex->Spin ) / 8;
+        if( spins <= limit )
+        {
+            return;
+        }
+    }
+
+    // Sleep until the mutex is released, marking it as having sleepers
+    state = __sync_lock_test_and_set( &mutex->Word, 2 );
+    while( state != 0 )
+    {
+        Futex( &mutex->Word, FUTEX_WAIT_PRIVATE, 2, NULL );
+        state = __sync_lock_test_and_set( &mutex->Word, 2 );
+    }
+}
+
+
+//========================================================================
+// Unlock a futex mutex
+//========================================================================
+
+static void UnlockFutexMutex( _GLFWfutexmutex *mutex )
+{
+    // Only enter the kernel if there may be sleepers
+    if( __sync_fetch_and_sub( &mutex->Word, 1 ) != 1 )
+    {
+        __sync_lock_release( &mutex->Word );
+        Futex( &mutex->Word, FUTEX_WAKE_PRIVATE, 1, NULL );
+    }
+}
+
+
+//========================================================================
+// Wait for a futex condition variable. Returns GL_FALSE on timeout
+//========================================================================
+
+static int WaitFutexCond( _GLFWfutexcond *cond, _GLFWfutexmutex *mutex,
+                          double timeout )
+{
+    struct timespec deadline, *wait = NULL;
+    int             sequence, signaled = GL_TRUE;
+
+    if( timeout < GLFW_INFINITY )
+    {
+        GetDeadline( &deadline, timeout );
+        wait = &deadline;
+    }
+
+    // Signals sent after the sequence is read make the wait return at once
+    __sync_fetch_and_add( &cond->Waiters, 1 );
+    sequence = cond->Sequence;
+
+    UnlockFutexMutex( mutex );
+
+    for( ;; )
+    {
+        if( Futex( &cond->Sequence, FUTEX_WAIT_BITSET_PRIVATE, sequence,
+                   wait ) == 0 || errno == EAGAIN )
+        {
+            break;
+        }
+        if( errno == ETIMEDOUT )
+        {
+            signaled = GL_FALSE;
+            break;
+        }
+
+        // Interrupted, so wait again unless signaled meanwhile
+        if( cond->Sequence != sequence )
+        {
+            break;
+        }
+    }
+
+    __sync_fetch_and_sub( &cond->Waiters, 1 );
+
+    // Other waiters may be asleep on the mutex after a broadcast, so it
+    // must be marked as having sleepers
+    while( __sync_lock_test_and_set( &mutex->Word, 2 ) != 0 )
+    {
+        Futex( &mutex->Word, FUTEX_WAIT_PRIVATE, 2, NULL );
+    }
+
+    return signaled;
+}
+
+
+//========================================================================
+// Wake threads waiting for a futex condition variable
+//========================================================================
+
+static void WakeFutexCond( _GLFWfutexcond *cond, int count )
+{
+    __sync_fetch_and_add( &cond->Sequence, 1 );
+    if( __sync_fetch_and_add( &cond->Waiters, 0 ) > 0 )
+    {
+        Futex( &cond->Sequence, FUTEX_WAKE_PRIVATE, count, NULL );
+    }
+}
+
+#endif // _GLFW_HAS_FUTEX
+
+
 
 //************************************************************************
 //****               Platform implementation functions                ****
@@ -99,23 +696,57 @@ void * _glfwNewThread( void * arg )
 // Create a new thread
 //========================================================================
 
-GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg )
+GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg,
+                                      const GLFWthreadattr *attr )
 {
 #ifdef _GLFW_HAS_PTHREAD
 
-    GLFWthread  ID;
-    _GLFWthread *t;
-    int         result;
+    GLFWthread     ID;
+    _GLFWthread    *t;
+    pthread_attr_t pattr;
+    long           pagesize;
+    size_t         stacksize;
+    int            result;
+
+    // Set up the attributes that must be given at creation
+    if( pthread_attr_init( &pattr ) != 0 )
+    {
+        return -1;
+    }
+    if( attr != NULL && attr->StackSize > 0 )
+    {
+        // Round up to whole pages and the system minimum
+        stacksize = (size_t) attr->StackSize;
+        pagesize = sysconf( _SC_PAGESIZE );
+        if( pagesize > 0 )
+        {
+            stacksize = ( stacksize + (size_t) pagesize - 1 ) &
+                        ~( (size_t) pagesize - 1 );
+        }
+#ifdef PTHREAD_STACK_MIN
+        if( stacksize < PTHREAD_STACK_MIN )
+        {
+            stacksize = PTHREAD_STACK_MIN;
+        }
+#endif
+        if( pthread_attr_setstacksize( &pattr, stacksize ) != 0 )
+        {
+            pthread_attr_destroy( &pattr );
+            return -1;
+        }
+    }
 
     // Enter critical section
     ENTER_THREAD_CRITICAL_SECTION
 
     // Create a new thread information memory area
-    t = (_GLFWthread *) malloc( sizeof(_GLFWthread) );
+    t = (_GLFWthread *) _glfwMallocAs( sizeof(_GLFWthread),
+                                       GLFW_MEMORY_THREAD );
     if( t == NULL )
     {
         // Leave critical section
         LEAVE_THREAD_CRITICAL_SECTION
+        pthread_attr_destroy( &pattr );
         return -1;
     }
 
@@ -124,24 +755,56 @@ GLFWthread _glfwPlatformCreateThread( GLFWthreadfun fun, void *arg )
 
     // Store thread information in the thread list
     t->Function = fun;
+    t->Arg      = arg;
     t->ID       = ID;
 
+#ifdef _GLFW_HAS_LINUX_SCHED
+    // The rest of the attributes are applied by the thread itself
+    t->Tid = 0;
+    memset( &t->Affinity, 0, sizeof( GLFWcpumask ) );
+    t->Policy   = GLFW_SCHED_NORMAL;
+    t->Priority = GLFW_PRIORITY_NORMAL;
+    t->Name[ 0 ] = 0;
+    if( attr != NULL )
+    {
+        t->Affinity = attr->Affinity;
+        t->Policy   = attr->Policy;
+        t->Priority = attr->Priority;
+        if( attr->Name != NULL )
+        {
+            strncpy( t->Name, attr->Name, sizeof( t->Name ) - 1 );
+            t->Name[ sizeof( t->Name ) - 1 ] = 0;
+        }
+    }
+#endif
+
     // Create thread
     result = pthread_create(
         &t->PosixID,      // Thread handle
-        NULL,             // Default thread attributes
+        &pattr,           // Thread attributes
         _glfwNewThread,   // Thread function (a wrapper function)
-        (void *)arg       // Argument to thread is user argument
+        (void *)t         // Argument to thread is the thread record
     );
+    pthread_attr_destroy( &pattr );
 
     // Did the thread creation fail?
     if( result != 0 )
     {
-        free( (void *) t );
+        _glfwFree( (void *) t );
         LEAVE_THREAD_CRITICAL_SECTION
         return -1;
     }
 
+#ifndef _GLFW_HAS_LINUX_SCHED
+    // Elsewhere, only the scheduling can be changed, and only from here
+    if( attr != NULL && ( attr->Policy != GLFW_SCHED_NORMAL ||
+                          attr->Priority != GLFW_PRIORITY_NORMAL ) )
+    {
+        (void) SetThreadSchedule( t->PosixID, attr->Policy,
+                                  attr->Priority );
+    }
+#endif
+
     // Append thread to thread list
     _glfwAppendThread( t );
 
@@ -194,6 +857,50 @@ void _glfwPlatformDestroyThread( GLFWthread ID )
 }
 
 
+//========================================================================
+// Restrict a thread to a set of processors
+//========================================================================
+
+int _glfwPlatformSetThreadAffinity( GLFWthread ID, const GLFWcpumask *mask )
+{
+#ifdef _GLFW_HAS_LINUX_SCHED
+
+    _GLFWthread *t;
+    int         tid;
+
+    // Enter critical section
+    ENTER_THREAD_CRITICAL_SECTION
+
+    // Get thread information pointer
+    t = _glfwGetThreadPointer( ID );
+    if( t == NULL )
+    {
+        LEAVE_THREAD_CRITICAL_SECTION
+        return GL_FALSE;
+    }
+
+    // A thread that has not started yet applies the set itself
+    t->Affinity = *mask;
+    tid = t->Tid;
+
+    // Leave critical section
+    LEAVE_THREAD_CRITICAL_SECTION
+
+    if( tid == 0 )
+    {
+        return GL_TRUE;
+    }
+
+    return SetKernelThreadAffinity( tid, mask );
+
+#else
+
+    return GL_FALSE;
+
+#endif // _GLFW_HAS_LINUX_SCHED
+}
+
+
 //========================================================================
 // Wait for a thread to die
 //========================================================================
@@ -250,7 +957,22 @@ int _glfwPlatformWaitThread( GLFWthread ID, int waitmode )
 
 GLFWthread _glfwPlatformGetThreadID( void )
 {
-#ifdef _GLFW_HAS_PTHREAD
+#if defined( _GLFW_HAS_TLS )
+
+    if( _glfwCurrentThreadID >= 0 )
+    {
+        return _glfwCurrentThreadID;
+    }
+
+    // The main thread is the only other thread GLFW knows about
+    if( pthread_equal( pthread_self(), _glfwThrd.First.PosixID ) )
+    {
+        return _glfwThrd.First.ID;
+    }
+
+    return -1;
+
+#elif defined( _GLFW_HAS_PTHREAD )
 
     _GLFWthread *t;
     GLFWthread  ID = -1;
@@ -293,12 +1015,19 @@ GLFWthread _glfwPlatformGetThreadID( void )
 
 GLFWmutex _glfwPlatformCreateMutex( void )
 {
-#ifdef _GLFW_HAS_PTHREAD
+#if defined( _GLFW_HAS_FUTEX )
+
+    // An unlocked futex mutex is all zeroes
+    return (GLFWmutex) _glfwCallocAs( 1, sizeof( _GLFWfutexmutex ),
+                                      GLFW_MEMORY_SYNC );
+
+#elif defined( _GLFW_HAS_PTHREAD )
 
     pthread_mutex_t *mutex;
 
     // Allocate memory for mutex
-    mutex = (pthread_mutex_t *) malloc( sizeof( pthread_mutex_t ) );
+    mutex = (pthread_mutex_t *) _glfwMallocAs( sizeof( pthread_mutex_t ),
+                                               GLFW_MEMORY_SYNC );
     if( !mutex )
     {
         return NULL;
@@ -324,13 +1053,17 @@ GLFWmutex _glfwPlatformCreateMutex( void )
 
 void _glfwPlatformDestroyMutex( GLFWmutex mutex )
 {
-#ifdef _GLFW_HAS_PTHREAD
+#if defined( _GLFW_HAS_FUTEX )
+
+    _glfwFree( (void *) mutex );
+
+#elif defined( _GLFW_HAS_PTHREAD )
 
     // Destroy the mutex object
     pthread_mutex_destroy( (pthread_mutex_t *) mutex );
 
     // Free memory for mutex object
-    free( (void *) mutex );
+    _glfwFree( (void *) mutex );
 
 #endif // _GLFW_HAS_PTHREAD
 }
@@ -342,7 +1075,11 @@ void _glfwPlatformDestroyMutex( GLFWmutex mutex )
 
 void _glfwPlatformLockMutex( GLFWmutex mutex )
 {
-#ifdef _GLFW_HAS_PTHREAD
+#if defined( _GLFW_HAS_FUTEX )
+
+    LockFutexMutex( (_GLFWfutexmutex *) mutex );
+
+#elif defined( _GLFW_HAS_PTHREAD )
 
     // Wait for mutex to be released
     (void) pthread_mutex_lock( (pthread_mutex_t *) mutex );
@@ -357,7 +1094,11 @@ void _glfwPlatformLockMutex( GLFWmutex mutex )
 
 void _glfwPlatformUnlockMutex( GLFWmutex mutex )
 {
-#ifdef _GLFW_HAS_PTHREAD
+#if defined( _GLFW_HAS_FUTEX )
+
+    UnlockFutexMutex( (_GLFWfutexmutex *) mutex );
+
+#elif defined( _GLFW_HAS_PTHREAD )
 
     // Release mutex
     pthread_mutex_unlock( (pthread_mutex_t *) mutex );
@@ -372,19 +1113,35 @@ void _glfwPlatformUnlockMutex( GLFWmutex mutex )
 
 GLFWcond _glfwPlatformCreateCond( void )
 {
-#ifdef _GLFW_HAS_PTHREAD
+#if defined( _GLFW_HAS_FUTEX )
+
+    return (GLFWcond) _glfwCallocAs( 1, sizeof( _GLFWfutexcond ),
+                                     GLFW_MEMORY_SYNC );
+
+#elif defined( _GLFW_HAS_PTHREAD )
 
     pthread_cond_t *cond;
+#if defined( _GLFW_COND_CLOCK )
+    pthread_condattr_t attr;
+#endif
 
     // Allocate memory for condition variable
-    cond = (pthread_cond_t *) malloc( sizeof(pthread_cond_t) );
+    cond = (pthread_cond_t *) _glfwMallocAs( sizeof(pthread_cond_t),
+                                             GLFW_MEMORY_SYNC );
     if( !cond )
     {
         return NULL;
     }
 
     // Initialise condition variable
+#if defined( _GLFW_COND_CLOCK )
+    (void) pthread_condattr_init( &attr );
+    (void) pthread_condattr_setclock( &attr, _GLFW_COND_CLOCK );
+    (void) pthread_cond_init( cond, &attr );
+    (void) pthread_condattr_destroy( &attr );
+#else
     (void) pthread_cond_init( cond, NULL );
+#endif
 
     // Cast to GLFWcond and return
     return (GLFWcond) cond;
@@ -403,30 +1160,37 @@ GLFWcond _glfwPlatformCreateCond( void )
 
 void _glfwPlatformDestroyCond( GLFWcond cond )
 {
-#ifdef _GLFW_HAS_PTHREAD
+#if defined( _GLFW_HAS_FUTEX )
+
+    _glfwFree( (void *) cond );
+
+#elif defined( _GLFW_HAS_PTHREAD )
 
     // Destroy the condition variable object
     (void) pthread_cond_destroy( (pthread_cond_t *) cond );
 
     // Free memory for condition variable object
-    free( (void *) cond );
+    _glfwFree( (void *) cond );
 
 #endif // _GLFW_HAS_PTHREAD
 }
 
 
 //========================================================================
-// Wait for a condition to be raised
+// Wait for a condition to be raised. Returns GL_FALSE on timeout
 //========================================================================
 
-void _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex,
+int _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex,
     double timeout )
 {
-#ifdef _GLFW_HAS_PTHREAD
+#if defined( _GLFW_HAS_FUTEX )
+
+    return WaitFutexCond( (_GLFWfutexcond *) cond,
+                          (_GLFWfutexmutex *) mutex, timeout );
+
+#elif defined( _GLFW_HAS_PTHREAD )
 
-    struct timeval  currenttime;
     struct timespec wait;
-    long dt_sec, dt_usec;
 
     // Select infinite or timed wait
     if( timeout >= GLFW_INFINITY )
@@ -434,25 +1198,18 @@ void _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex,
         // Wait for condition (infinite wait)
         (void) pthread_cond_wait( (pthread_cond_t *) cond,
                   (pthread_mutex_t *) mutex );
+        return GL_TRUE;
     }
-    else
-    {
-        // Set timeout time, relatvie to current time
-        gettimeofday( &currenttime, NULL );
-        dt_sec  = (long) timeout;
-        dt_usec = (long) ((timeout - (double)dt_sec) * 1000000.0);
-        wait.tv_nsec = (currenttime.tv_usec + dt_usec) * 1000L;
-        if( wait.tv_nsec > 1000000000L )
-        {
-            wait.tv_nsec -= 1000000000L;
-            dt_sec ++;
-        }
-        wait.tv_sec  = currenttime.tv_sec + dt_sec;
 
-        // Wait for condition (timed wait)
-        (void) pthread_cond_timedwait( (pthread_cond_t *) cond,
-                   (pthread_mutex_t *) mutex, &wait );
-    }
+    GetDeadline( &wait, timeout );
+
+    // Wait for condition (timed wait)
+    return pthread_cond_timedwait( (pthread_cond_t *) cond,
+               (pthread_mutex_t *) mutex, &wait ) != ETIMEDOUT;
+
+#else
+
+    return GL_FALSE;
 
 #endif // _GLFW_HAS_PTHREAD
 }
@@ -464,7 +1221,11 @@ void _glfwPlatformWaitCond( GLFWcond cond, GLFWmutex mutex,
 
 void _glfwPlatformSignalCond( GLFWcond cond )
 {
-#ifdef _GLFW_HAS_PTHREAD
+#if defined( _GLFW_HAS_FUTEX )
+
+    WakeFutexCond( (_GLFWfutexcond *) cond, 1 );
+
+#elif defined( _GLFW_HAS_PTHREAD )
 
     // Signal condition
     (void) pthread_cond_signal( (pthread_cond_t *) cond );
@@ -479,7 +1240,11 @@ void _glfwPlatformSignalCond( GLFWcond cond )
 
 void _glfwPlatformBroadcastCond( GLFWcond cond )
 {
-#ifdef _GLFW_HAS_PTHREAD
+#if defined( _GLFW_HAS_FUTEX )
+
+    WakeFutexCond( (_GLFWfutexcond *) cond, INT_MAX );
+
+#elif defined( _GLFW_HAS_PTHREAD )
 
     // Broadcast condition
     (void) pthread_cond_broadcast( (pthread_cond_t *) cond );
@@ -488,6 +1253,62 @@ void _glfwPlatformBroadcastCond( GLFWcond cond )
 }
 
 
+#ifdef _GLFW_HAS_STATIC_SYNC
+
+//========================================================================
+// Request access to a static mutex
+//========================================================================
+
+void _glfwPlatformLockStaticMutex( GLFWstaticmutex *mutex )
+{
+    LockFutexMutex( (_GLFWfutexmutex *) mutex->State );
+}
+
+
+//========================================================================
+// Release a static mutex
+//========================================================================
+
+void _glfwPlatformUnlockStaticMutex( GLFWstaticmutex *mutex )
+{
+    UnlockFutexMutex( (_GLFWfutexmutex *) mutex->State );
+}
+
+
+//========================================================================
+// Wait for a static condition to be raised. Returns GL_FALSE on timeout
+//========================================================================
+
+int _glfwPlatformWaitStaticCond( GLFWstaticcond *cond,
+    GLFWstaticmutex *mutex, double timeout )
+{
+    return WaitFutexCond( (_GLFWfutexcond *) cond->State,
+                          (_GLFWfutexmutex *) mutex->State, timeout );
+}
+
+
+//========================================================================
+// Signal a static condition to one waiting thread
+//========================================================================
+
+void _glfwPlatformSignalStaticCond( GLFWstaticcond *cond )
+{
+    WakeFutexCond( (_GLFWfutexcond *) cond->State, 1 );
+}
+
+
+//========================================================================
+// Broadcast a static condition to all waiting threads
+//========================================================================
+
+void _glfwPlatformBroadcastStaticCond( GLFWstaticcond *cond )
+{
+    WakeFutexCond( (_GLFWfutexcond *) cond->State, INT_MAX );
+}
+
+#endif // _GLFW_HAS_STATIC_SYNC
+
+
 //========================================================================
 // Return the number of processors in the system.
 //========================================================================
@@ -501,3 +1322,128 @@ int _glfwPlatformGetNumberOfProcessors( void )
     return n;
 }
 
+
+//========================================================================
+// Describe the processors of the system, as far as sysfs tells. Packages
+// are given by their system ID, and cores and cache instances by their
+// lowest processor
+//========================================================================
+
+int _glfwPlatformGetProcessorTopology( GLFWtopology *topology )
+{
+    GLFWprocessorinfo *p;
+    GLFWcpumask       online, mask;
+    char              path[ 256 ];
+    int               cpu, node, core;
+
+    if( ReadCpuList( _GLFW_SYSFS_PATH "/cpu/online", &online ) < 0 )
+    {
+        return GL_FALSE;
+    }
+
+    for( cpu = 0; cpu < GLFW_MAX_PROCESSORS; cpu ++ )
+    {
+        if( !( online.Bits[ cpu / 32 ] & ( 1U << ( cpu % 32 ) ) ) )
+        {
+            continue;
+        }
+        p = &topology->Processors[ cpu ];
+
+        // Some systems report -1 for a package they can not identify
+        sprintf( path, _GLFW_SYSFS_PATH
+                 "/cpu/cpu%d/topology/physical_package_id", cpu );
+        if( !ReadSysNumber( path, &p->Package ) || p->Package < 0 )
+        {
+            p->Package = 0;
+        }
+
+        sprintf( path, _GLFW_SYSFS_PATH
+                 "/cpu/cpu%d/topology/thread_siblings_list", cpu );
+        core = ReadCpuList( path, &mask );
+        p->Core = core >= 0 ? core : cpu;
+
+        ReadProcessorCaches( topology, cpu );
+    }
+
+    // Kernels without NUMA support have no node directory at all
+    for( node = 0; node < GLFW_MAX_NODES; node ++ )
+    {
+        sprintf( path, _GLFW_SYSFS_PATH "/node/node%d/cpulist", node );
+        if( ReadCpuList( path, &mask ) < 0 )
+        {
+            continue;
+        }
+
+        for( cpu = 0; cpu < GLFW_MAX_PROCESSORS; cpu ++ )
+        {
+            if( ( mask.Bits[ cpu / 32 ] & online.Bits[ cpu / 32 ] ) &
+                ( 1U << ( cpu % 32 ) ) )
+            {
+                topology->Processors[ cpu ].Node = node;
+            }
+        }
+    }
+
+    return GL_TRUE;
+}
+
+
+//========================================================================
+// Atomically add to a value, returning the new value
+//========================================================================
+
+long _glfwPlatformAtomicAdd( volatile long *value, long delta )
+{
+#if defined( _GLFW_HAS_SYNC_BUILTINS )
+
+    return __sync_add_and_fetch( value, delta );
+
+#else
+    long result;
+
+#ifdef _GLFW_HAS_PTHREAD
+    pthread_mutex_lock( &_glfwAtomicMutex );
+#endif // _GLFW_HAS_PTHREAD
+    result = ( *value += delta );
+#ifdef _GLFW_HAS_PTHREAD
+    pthread_mutex_unlock( &_glfwAtomicMutex );
+#endif // _GLFW_HAS_PTHREAD
+
+    return result;
+
+#endif // _GLFW_HAS_SYNC_BUILTINS
+}
+
+
+//========================================================================
+// Atomically replace a value if it equals the expected one, returning the
+// previous value
+//========================================================================
+
+long _glfwPlatformAtomicCompareSwap( volatile long *value, long expected,
+                                     long desired )
+{
+#if defined( _GLFW_HAS_SYNC_BUILTINS )
+
+    return __sync_val_compare_and_swap( value, expected, desired );
+
+#else
+    long result;
+
+#ifdef _GLFW_HAS_PTHREAD
+    pthread_mutex_lock( &_glfwAtomicMutex );
+#endif // _GLFW_HAS_PTHREAD
+    result = *value;
+    if( result == expected )
+    {
+        *value = desired;
+    }
+#ifdef _GLFW_HAS_PTHREAD
+    pthread_mutex_unlock( &_glfwAtomicMutex );
+#endif // _GLFW_HAS_PTHREAD
+
+    return result;
+
+#endif // _GLFW_HAS_SYNC_BUILTINS
+}
+
@@ -483,7 +483,8 @@ static _GLFWfbconfig *getFBConfigs( unsigned int *found )
         }
     }
 
-    result = (_GLFWfbconfig*) malloc( sizeof(_GLFWfbconfig) * count );
+    result = (_GLFWfbconfig*) _glfwMallocAs( sizeof(_GLFWfbconfig) * count,
+                                             GLFW_MEMORY_VIDEO );
     if( !result )
     {
         fprintf( stderr, "Out of memory\n" );
@@ -1494,12 +1495,12 @@ int _glfwPlatformOpenWindow( int width, int height,
         result = _glfwChooseFBConfig( fbconfig, fbconfigs, fbcount );
         if( !result )
         {
-            free( fbconfigs );
+            _glfwFree( fbconfigs );
             return GL_FALSE;
         }
 
         closest = *result;
-        free( fbconfigs );
+        _glfwFree( fbconfigs );
     }
 
     if( !createContext( wndconfig, (GLXFBConfigID) closest.platformID ) )